@@ -16,6 +16,22 @@
 
 uint8_t twr_crc8(const uint8_t polynomial, const void *buffer, size_t length, const uint8_t initialization);
 
+//! @brief Calculate CRC16 (MSB first, e.g. CCITT with polynomial 0x1021 and initialization 0xffff)
+//! @param[in] polynomial
+//! @param[in] buffer Data buffer
+//! @param[in] length Data buffer length
+//! @param[in] initialization data
+//! @return crc
+
+uint16_t twr_crc16(const uint16_t polynomial, const void *buffer, size_t length, const uint16_t initialization);
+
+//! @brief Calculate Modbus CRC16 (LSB first, polynomial 0xa001, initialization 0xffff) using table of nibbles
+//! @param[in] buffer Data buffer
+//! @param[in] length Data buffer length
+//! @return crc (low byte is sent first)
+
+uint16_t twr_crc16_modbus(const void *buffer, size_t length);
+
 //! @}
 
 #endif // _TWR_CRC_H
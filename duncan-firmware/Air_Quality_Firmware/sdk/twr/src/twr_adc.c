@@ -3,14 +3,22 @@
 #include <twr_irq.h>
 #include <stm32l083xx.h>
 #include <twr_sleep.h>
+#include <twr_dma.h>
 
 #include <twr_system.h>
 
 #define VREFINT_CAL_ADDR 0x1ff80078
+#define TS_CAL1_ADDR 0x1ff8007a
+#define TS_CAL2_ADDR 0x1ff8007e
 
 #define TWR_ADC_CHANNEL_INTERNAL_REFERENCE 7
 #define TWR_ADC_CHANNEL_NONE ((twr_adc_channel_t) (-1))
 #define TWR_ADC_CHANNEL_COUNT ((twr_adc_channel_t) 8)
+#define TWR_ADC_CHANNEL_SCAN TWR_ADC_CHANNEL_COUNT
+
+#define _TWR_ADC_SCAN_CHANNELS (ADC_CHSELR_CHSEL0 | ADC_CHSELR_CHSEL1 | ADC_CHSELR_CHSEL2 | ADC_CHSELR_CHSEL3 | \
+                                ADC_CHSELR_CHSEL4 | ADC_CHSELR_CHSEL5 | ADC_CHSELR_CHSEL6 | ADC_CHSELR_CHSEL17 | ADC_CHSELR_CHSEL18)
+#define _TWR_ADC_SCAN_INTERNAL (ADC_CHSELR_CHSEL17 | ADC_CHSELR_CHSEL18)
 
 typedef enum
 {
@@ -37,10 +45,15 @@ static struct
     bool initialized;
     twr_adc_channel_t channel_in_progress;
     uint16_t vrefint;
-    float real_vdda_voltage;
+    uint16_t vrefint_measured;
     twr_adc_state_t state;
     twr_scheduler_task_id_t task_id;
     twr_adc_channel_config_t channel_table[8];
+    void (*scan_event_handler)(twr_adc_event_t, void *);
+    void *scan_event_param;
+    uint32_t scan_channels;
+    uint32_t scan_valid;
+    uint16_t scan_buffer[9];
 }
 _twr_adc =
 {
@@ -63,6 +76,10 @@ static void _twr_adc_task(void *param);
 
 static inline bool _twr_adc_get_pending(twr_adc_channel_t *next ,twr_adc_channel_t start);
 
+static void _twr_adc_scan_dma_event_handler(twr_dma_channel_t channel, twr_dma_event_t event, void *event_param);
+
+static bool _twr_adc_scan_get_raw(twr_adc_scan_channel_t channel, uint16_t *raw);
+
 void twr_adc_init()
 {
     if (_twr_adc.initialized != true)
@@ -279,19 +296,47 @@ bool twr_adc_async_get_value(twr_adc_channel_t channel, uint16_t *result)
 
 bool twr_adc_async_get_voltage(twr_adc_channel_t channel, float *result)
 {
-    *result = (_twr_adc.channel_table[channel].value * _twr_adc.real_vdda_voltage) / 65536.f;
+    float vdda_voltage = 0.f;
+
+    twr_adc_get_vdda_voltage(&vdda_voltage);
+
+    *result = (_twr_adc.channel_table[channel].value * vdda_voltage) / 65536.f;
+    return true;
+}
+
+bool twr_adc_async_get_voltage_fixed(twr_adc_channel_t channel, twr_fixed_t *result)
+{
+    twr_fixed_t vdda_voltage = 0;
+
+    twr_adc_get_vdda_voltage_fixed(&vdda_voltage);
+
+    *result = (twr_fixed_t) (((uint64_t) _twr_adc.channel_table[channel].value * (uint32_t) vdda_voltage) >> 16);
     return true;
 }
 
 bool twr_adc_get_vdda_voltage(float *vdda_voltage)
 {
-    if (_twr_adc.real_vdda_voltage == 0.f)
+    if (_twr_adc.vrefint_measured == 0)
+    {
+        return false;
+    }
+    else
+    {
+        *vdda_voltage = 3.f * ((float) _twr_adc.vrefint / (float) _twr_adc.vrefint_measured);
+
+        return true;
+    }
+}
+
+bool twr_adc_get_vdda_voltage_fixed(twr_fixed_t *vdda_voltage)
+{
+    if (_twr_adc.vrefint_measured == 0)
     {
         return false;
     }
     else
     {
-        *vdda_voltage = _twr_adc.real_vdda_voltage;
+        *vdda_voltage = (twr_fixed_t) ((uint32_t) TWR_FIXED_FROM_INT(3) * _twr_adc.vrefint / _twr_adc.vrefint_measured);
 
         return true;
     }
@@ -302,8 +347,8 @@ void ADC1_COMP_IRQHandler(void)
     // Get real VDDA and begin analog channel measurement
     if (_twr_adc.state == TWR_ADC_STATE_CALIBRATION_BY_INTERNAL_REFERENCE_END)
     {
-        // Compute actual VDDA
-        _twr_adc.real_vdda_voltage = 3.f * ((float) _twr_adc.vrefint / (float) ADC1->DR);
+        // Keep internal reference result, VDDA is computed on demand outside of interrupt
+        _twr_adc.vrefint_measured = ADC1->DR;
 
         _twr_adc_configure_oversampling(_twr_adc.channel_table[_twr_adc.channel_in_progress].oversampling);
         _twr_adc_configure_resolution(_twr_adc.channel_table[_twr_adc.channel_in_progress].resolution);
@@ -340,6 +385,133 @@ void ADC1_COMP_IRQHandler(void)
     }
 }
 
+bool twr_adc_scan(uint32_t channels, twr_adc_oversampling_t oversampling)
+{
+    if (channels == 0 || (channels & ~_TWR_ADC_SCAN_CHANNELS) != 0)
+    {
+        return false;
+    }
+
+    if (_twr_adc.channel_in_progress != TWR_ADC_CHANNEL_NONE)
+    {
+        return false;
+    }
+
+    _twr_adc.channel_in_progress = TWR_ADC_CHANNEL_SCAN;
+    _twr_adc.scan_channels = channels;
+    _twr_adc.scan_valid = 0;
+
+    twr_dma_channel_config_t config =
+    {
+        .request = TWR_DMA_REQUEST_0,
+        .direction = TWR_DMA_DIRECTION_TO_RAM,
+        .data_size_memory = TWR_DMA_SIZE_2,
+        .data_size_peripheral = TWR_DMA_SIZE_2,
+        .length = __builtin_popcount(channels),
+        .mode = TWR_DMA_MODE_STANDARD,
+        .address_memory = _twr_adc.scan_buffer,
+        .address_peripheral = (void *) &ADC1->DR,
+        .priority = TWR_DMA_PRIORITY_MEDIUM
+    };
+
+    twr_dma_init();
+    twr_dma_set_event_handler(TWR_DMA_CHANNEL_1, _twr_adc_scan_dma_event_handler, NULL);
+    twr_dma_channel_config(TWR_DMA_CHANNEL_1, &config);
+    twr_dma_channel_run(TWR_DMA_CHANNEL_1);
+
+    if ((channels & TWR_ADC_SCAN_VREFINT) != 0)
+    {
+        ADC->CCR |= ADC_CCR_VREFEN;
+    }
+
+    if ((channels & TWR_ADC_SCAN_TEMPERATURE) != 0)
+    {
+        ADC->CCR |= ADC_CCR_TSEN;
+    }
+
+    if ((channels & _TWR_ADC_SCAN_INTERNAL) != 0)
+    {
+        // Internal channels need 10 us of sampling, sampling time is common for all channels (160.5 cycles)
+        ADC1->SMPR |= ADC_SMPR_SMP;
+    }
+
+    _twr_adc_configure_oversampling(oversampling);
+    _twr_adc_configure_resolution(TWR_ADC_RESOLUTION_12_BIT);
+
+    // Set ADC channels, they are converted in ascending order
+    ADC1->CHSELR = channels;
+
+    // Disable all ADC interrupts, end of sequence is signalled by DMA
+    ADC1->IER = 0;
+
+    // Clear end of conversion, end of sequence and overrun flags
+    ADC1->ISR = ADC_ISR_EOC | ADC_ISR_EOS | ADC_ISR_OVR;
+
+    // Enable DMA requests in one shot mode
+    ADC1->CFGR1 |= ADC_CFGR1_DMAEN;
+
+    twr_sleep_disable(); // enable in _twr_adc_scan_dma_event_handler
+
+    // Begin conversion of whole sequence
+    ADC1->CR |= ADC_CR_ADSTART;
+
+    return true;
+}
+
+void twr_adc_scan_set_event_handler(void (*event_handler)(twr_adc_event_t, void *), void *event_param)
+{
+    _twr_adc.scan_event_handler = event_handler;
+    _twr_adc.scan_event_param = event_param;
+}
+
+bool twr_adc_scan_get_value(twr_adc_scan_channel_t channel, uint16_t *result)
+{
+    uint16_t raw;
+
+    if (!_twr_adc_scan_get_raw(channel, &raw))
+    {
+        return false;
+    }
+
+    *result = raw << 4;
+
+    return true;
+}
+
+bool twr_adc_scan_get_voltage(twr_adc_scan_channel_t channel, float *result)
+{
+    uint16_t raw;
+    float vdda_voltage;
+
+    if (!_twr_adc_scan_get_raw(channel, &raw) || !twr_adc_get_vdda_voltage(&vdda_voltage))
+    {
+        return false;
+    }
+
+    *result = (raw * vdda_voltage) / 4096.f;
+
+    return true;
+}
+
+bool twr_adc_scan_get_temperature(float *temperature)
+{
+    uint16_t raw;
+
+    if (!_twr_adc_scan_get_raw(TWR_ADC_SCAN_TEMPERATURE, &raw) || _twr_adc.vrefint_measured == 0)
+    {
+        return false;
+    }
+
+    // Factory calibration at 30 and 130 degrees of Celsius is done with VDDA of 3.0 V
+    float ts_cal1 = *(uint16_t *) TS_CAL1_ADDR;
+    float ts_cal2 = *(uint16_t *) TS_CAL2_ADDR;
+    float value = (float) raw * _twr_adc.vrefint / _twr_adc.vrefint_measured;
+
+    *temperature = (value - ts_cal1) * (130.f - 30.f) / (ts_cal2 - ts_cal1) + 30.f;
+
+    return true;
+}
+
 bool twr_adc_calibration(void)
 {
     if (_twr_adc.channel_in_progress != TWR_ADC_CHANNEL_NONE)
@@ -376,8 +548,8 @@ bool twr_adc_calibration(void)
         continue;
     }
 
-    // Compute actual VDDA
-    _twr_adc.real_vdda_voltage = 3.f * ((float) _twr_adc.vrefint / (float) ADC1->DR);
+    // Keep internal reference result, VDDA is computed on demand
+    _twr_adc.vrefint_measured = ADC1->DR;
 
     // Disable internal reference
     ADC->CCR &= ~ADC_CCR_VREFEN;
@@ -446,3 +618,67 @@ static inline bool _twr_adc_get_pending(twr_adc_channel_t *next ,twr_adc_channel
 
     return false;
 }
+
+static void _twr_adc_scan_dma_event_handler(twr_dma_channel_t channel, twr_dma_event_t event, void *event_param)
+{
+    (void) event_param;
+
+    if (event == TWR_DMA_EVENT_HALF_DONE || _twr_adc.channel_in_progress != TWR_ADC_CHANNEL_SCAN)
+    {
+        return;
+    }
+
+    twr_dma_channel_stop(channel);
+
+    // Disable DMA requests and internal channels, restore sampling time (12.5 cycles)
+    ADC1->CFGR1 &= ~ADC_CFGR1_DMAEN;
+    ADC->CCR &= ~(ADC_CCR_VREFEN | ADC_CCR_TSEN);
+    ADC1->SMPR = ADC_SMPR_SMP_1 | ADC_SMPR_SMP_0;
+    ADC1->ISR = 0xffff;
+
+    if (event == TWR_DMA_EVENT_DONE)
+    {
+        _twr_adc.scan_valid = _twr_adc.scan_channels;
+
+        // Keep internal reference result, VDDA is computed on demand
+        _twr_adc_scan_get_raw(TWR_ADC_SCAN_VREFINT, &_twr_adc.vrefint_measured);
+    }
+
+    twr_sleep_enable();
+
+    twr_adc_channel_t next;
+
+    // Release ADC for further conversion
+    _twr_adc.channel_in_progress = TWR_ADC_CHANNEL_NONE;
+
+    // Disable interrupts
+    twr_irq_disable();
+
+    // Get pending
+    if (_twr_adc_get_pending(&next, TWR_ADC_CHANNEL_INTERNAL_REFERENCE) == true)
+    {
+        twr_adc_async_measure(next);
+    }
+
+    // Enable interrupts
+    twr_irq_enable();
+
+    if (_twr_adc.scan_event_handler != NULL)
+    {
+        _twr_adc.scan_event_handler(TWR_ADC_EVENT_DONE, _twr_adc.scan_event_param);
+    }
+}
+
+static bool _twr_adc_scan_get_raw(twr_adc_scan_channel_t channel, uint16_t *raw)
+{
+    // Single channel of last successful scan
+    if ((_twr_adc.scan_valid & channel) == 0 || (channel & (channel - 1)) != 0)
+    {
+        return false;
+    }
+
+    // Results are stored in ascending order of channels
+    *raw = _twr_adc.scan_buffer[__builtin_popcount(_twr_adc.scan_valid & (channel - 1))];
+
+    return true;
+}
@@ -1,7 +1,6 @@
 #include <twr_dma.h>
 #include <twr_irq.h>
 #include <twr_scheduler.h>
-#include <twr_fifo.h>
 #include <stm32l0xx.h>
 
 #define _TWR_DMA_CHECK_IRQ_OF_CHANNEL_(__CHANNEL) \
@@ -23,14 +22,7 @@
         } \
     }
 
-typedef struct
-{
-    uint8_t channel : 4;
-    uint8_t event : 4;
-
-} twr_dma_pending_event_t;
-
-static twr_dma_pending_event_t _twr_dma_pending_event_buffer[2 * 7 * sizeof(twr_dma_pending_event_t)];
+static uint32_t _twr_dma_pending_event_buffer[16];
 
 static struct
 {
@@ -44,7 +36,7 @@ static struct
 
     } channel[7];
 
-    twr_fifo_t fifo_pending;
+    twr_irq_ring_t ring_pending;
     twr_scheduler_task_id_t task_id;
 
 } _twr_dma;
@@ -69,10 +61,10 @@ void twr_dma_init(void)
     _twr_dma.channel[TWR_DMA_CHANNEL_6].instance = DMA1_Channel6;
     _twr_dma.channel[TWR_DMA_CHANNEL_7].instance = DMA1_Channel7;
 
-    twr_fifo_init(&_twr_dma.fifo_pending, _twr_dma_pending_event_buffer, sizeof(_twr_dma_pending_event_buffer));
-
     _twr_dma.task_id = twr_scheduler_register(_twr_dma_task, NULL, TWR_TICK_INFINITY);
 
+    twr_irq_ring_init(&_twr_dma.ring_pending, _twr_dma_pending_event_buffer, sizeof(_twr_dma_pending_event_buffer) / sizeof(_twr_dma_pending_event_buffer[0]), _twr_dma.task_id);
+
     // Enable DMA1
     RCC->AHBENR |= RCC_AHBENR_DMA1EN;
 
@@ -176,6 +168,11 @@ void twr_dma_set_event_handler(twr_dma_channel_t channel, void (*event_handler)(
     _twr_dma.channel[channel].event_param = event_param;
 }
 
+bool twr_dma_channel_is_used(twr_dma_channel_t channel)
+{
+    return _twr_dma.channel[channel].event_handler != NULL;
+}
+
 void twr_dma_channel_run(twr_dma_channel_t channel)
 {
     _twr_dma.channel[channel].instance->CCR |= DMA_CCR_EN;
@@ -195,13 +192,16 @@ void _twr_dma_task(void *param)
 {
     (void) param;
 
-    twr_dma_pending_event_t pending_event;
+    uint32_t pending_event;
 
-    while (twr_fifo_read(&_twr_dma.fifo_pending, &pending_event, sizeof(twr_dma_pending_event_t)) != 0)
+    while (twr_irq_ring_get(&_twr_dma.ring_pending, &pending_event))
     {
-        if (_twr_dma.channel[pending_event.channel].event_handler != NULL)
+        twr_dma_channel_t channel = pending_event >> 8;
+        twr_dma_event_t event = pending_event & 0xff;
+
+        if (_twr_dma.channel[channel].event_handler != NULL)
         {
-            _twr_dma.channel[pending_event.channel].event_handler(pending_event.channel, pending_event.event, _twr_dma.channel[pending_event.channel].event_param);
+            _twr_dma.channel[channel].event_handler(channel, event, _twr_dma.channel[channel].event_param);
         }
     }
 }
@@ -213,11 +213,7 @@ void _twr_dma_irq_handler(twr_dma_channel_t channel, twr_dma_event_t event)
         twr_dma_channel_stop(channel);
     }
 
-    twr_dma_pending_event_t pending_event = { channel, event };
-
-    twr_fifo_irq_write(&_twr_dma.fifo_pending, &pending_event, sizeof(twr_dma_pending_event_t));
-
-    twr_scheduler_plan_now(_twr_dma.task_id);
+    twr_irq_ring_post(&_twr_dma.ring_pending, (channel << 8) | event);
 }
 
 void DMA1_Channel1_IRQHandler(void)
@@ -0,0 +1,321 @@
+#include <twr_infra_grid_occupancy.h>
+
+#define _TWR_INFRA_GRID_OCCUPANCY_WIDTH 8
+#define _TWR_INFRA_GRID_OCCUPANCY_LEARN_FRAMES 8
+#define _TWR_INFRA_GRID_OCCUPANCY_THRESHOLD 6
+#define _TWR_INFRA_GRID_OCCUPANCY_BACKGROUND_SHIFT 5
+#define _TWR_INFRA_GRID_OCCUPANCY_MIN_BLOB_SIZE 2
+
+// Foreground pixels still follow the background, much slower, so a new static heat source fades out eventually
+#define _TWR_INFRA_GRID_OCCUPANCY_FOREGROUND_SHIFT 4
+
+// Centroids in sixteenths of pixel, middle of the grid lies between columns 3 and 4
+#define _TWR_INFRA_GRID_OCCUPANCY_MIDDLE (((_TWR_INFRA_GRID_OCCUPANCY_WIDTH - 1) * 16) / 2)
+#define _TWR_INFRA_GRID_OCCUPANCY_MAX_TRACK_DISTANCE (3 * 16)
+
+static int _twr_infra_grid_occupancy_label(twr_infra_grid_occupancy_t *self, twr_infra_grid_occupancy_blob_t *blob);
+static void _twr_infra_grid_occupancy_track(twr_infra_grid_occupancy_t *self, twr_infra_grid_occupancy_blob_t *blob, int blob_count);
+
+void twr_infra_grid_occupancy_init(twr_infra_grid_occupancy_t *self)
+{
+    memset(self, 0, sizeof(*self));
+
+    self->_threshold = _TWR_INFRA_GRID_OCCUPANCY_THRESHOLD;
+    self->_background_shift = _TWR_INFRA_GRID_OCCUPANCY_BACKGROUND_SHIFT;
+    self->_min_blob_size = _TWR_INFRA_GRID_OCCUPANCY_MIN_BLOB_SIZE;
+}
+
+void twr_infra_grid_occupancy_set_event_handler(twr_infra_grid_occupancy_t *self, void (*event_handler)(twr_infra_grid_occupancy_t *, twr_infra_grid_occupancy_event_t, void *), void *event_param)
+{
+    self->_event_handler = event_handler;
+    self->_event_param = event_param;
+}
+
+void twr_infra_grid_occupancy_set_threshold(twr_infra_grid_occupancy_t *self, int16_t threshold)
+{
+    self->_threshold = threshold > 0 ? threshold : 1;
+}
+
+void twr_infra_grid_occupancy_set_background_rate(twr_infra_grid_occupancy_t *self, uint8_t shift)
+{
+    if (shift < 1)
+    {
+        shift = 1;
+    }
+    else if (shift > 8)
+    {
+        shift = 8;
+    }
+
+    self->_background_shift = shift;
+}
+
+void twr_infra_grid_occupancy_set_min_blob_size(twr_infra_grid_occupancy_t *self, uint8_t pixels)
+{
+    self->_min_blob_size = pixels > 0 ? pixels : 1;
+}
+
+void twr_infra_grid_occupancy_reset(twr_infra_grid_occupancy_t *self)
+{
+    self->_learn_count = 0;
+    self->_mask = 0;
+    self->_blob_count = 0;
+
+    memset(self->_delta, 0, sizeof(self->_delta));
+    memset(self->_residual, 0, sizeof(self->_residual));
+}
+
+bool twr_infra_grid_occupancy_feed(twr_infra_grid_occupancy_t *self, const int16_t *frame)
+{
+    if (self->_learn_count < _TWR_INFRA_GRID_OCCUPANCY_LEARN_FRAMES)
+    {
+        // Running average of the first frames
+        self->_learn_count++;
+
+        for (int i = 0; i < TWR_INFRA_GRID_OCCUPANCY_PIXELS; i++)
+        {
+            int32_t value = (int32_t) frame[i] * 16;
+
+            self->_background[i] += (value - self->_background[i]) / self->_learn_count;
+        }
+
+        if (self->_learn_count == _TWR_INFRA_GRID_OCCUPANCY_LEARN_FRAMES)
+        {
+            if (self->_event_handler != NULL)
+            {
+                self->_event_handler(self, TWR_INFRA_GRID_OCCUPANCY_EVENT_READY, self->_event_param);
+            }
+        }
+
+        return false;
+    }
+
+    uint64_t mask = 0;
+
+    for (int i = 0; i < TWR_INFRA_GRID_OCCUPANCY_PIXELS; i++)
+    {
+        int32_t value = (int32_t) frame[i] * 16;
+        int32_t difference = value - self->_background[i];
+
+        // Quarters of degree to half degrees, rounded
+        int32_t delta = (difference + (difference < 0 ? -16 : 16)) / 32;
+
+        self->_delta[i] = delta > INT8_MAX ? INT8_MAX : delta < INT8_MIN ? INT8_MIN : delta;
+
+        int shift = self->_background_shift;
+
+        if (difference >= self->_threshold * 16)
+        {
+            mask |= (uint64_t) 1 << i;
+
+            shift += _TWR_INFRA_GRID_OCCUPANCY_FOREGROUND_SHIFT;
+        }
+
+        // Remainder of the division is carried to the next frame, otherwise small differences never get learned
+        int32_t accumulator = self->_residual[i] + difference;
+        int32_t step = accumulator / (1 << shift);
+
+        self->_background[i] += step;
+        self->_residual[i] = accumulator - step * (1 << shift);
+    }
+
+    self->_mask = mask;
+
+    twr_infra_grid_occupancy_blob_t blob[TWR_INFRA_GRID_OCCUPANCY_MAX_BLOBS];
+
+    int blob_count = _twr_infra_grid_occupancy_label(self, blob);
+
+    _twr_infra_grid_occupancy_track(self, blob, blob_count);
+
+    bool changed = blob_count != self->_blob_count;
+
+    memcpy(self->_blob, blob, sizeof(blob));
+
+    self->_blob_count = blob_count;
+
+    if (changed && (self->_event_handler != NULL))
+    {
+        self->_event_handler(self, TWR_INFRA_GRID_OCCUPANCY_EVENT_OCCUPANCY, self->_event_param);
+    }
+
+    return true;
+}
+
+int twr_infra_grid_occupancy_get_blob_count(twr_infra_grid_occupancy_t *self)
+{
+    return self->_blob_count;
+}
+
+uint64_t twr_infra_grid_occupancy_get_mask(twr_infra_grid_occupancy_t *self)
+{
+    return self->_mask;
+}
+
+void twr_infra_grid_occupancy_get_counters(twr_infra_grid_occupancy_t *self, uint16_t *enter, uint16_t *leave)
+{
+    if (enter != NULL)
+    {
+        *enter = self->_count_enter;
+    }
+
+    if (leave != NULL)
+    {
+        *leave = self->_count_leave;
+    }
+}
+
+size_t twr_infra_grid_occupancy_encode_frame(twr_infra_grid_occupancy_t *self, uint8_t *buffer, size_t length)
+{
+    size_t size = sizeof(self->_mask);
+
+    if (length < size)
+    {
+        return 0;
+    }
+
+    for (size_t i = 0; i < sizeof(self->_mask); i++)
+    {
+        buffer[i] = self->_mask >> (i * 8);
+    }
+
+    for (int i = 0; i < TWR_INFRA_GRID_OCCUPANCY_PIXELS; i++)
+    {
+        if ((self->_mask & ((uint64_t) 1 << i)) == 0)
+        {
+            continue;
+        }
+
+        if (size == length)
+        {
+            return 0;
+        }
+
+        buffer[size++] = (uint8_t) self->_delta[i];
+    }
+
+    return size;
+}
+
+static int _twr_infra_grid_occupancy_label(twr_infra_grid_occupancy_t *self, twr_infra_grid_occupancy_blob_t *blob)
+{
+    uint64_t unvisited = self->_mask;
+    uint8_t stack[TWR_INFRA_GRID_OCCUPANCY_PIXELS];
+    int blob_count = 0;
+
+    for (int seed = 0; seed < TWR_INFRA_GRID_OCCUPANCY_PIXELS; seed++)
+    {
+        if ((unvisited & ((uint64_t) 1 << seed)) == 0)
+        {
+            continue;
+        }
+
+        // Flood fill of 4-connected pixels, every pixel is pushed at most once
+        int top = 0;
+        int count = 0;
+        int sum_x = 0;
+        int sum_y = 0;
+
+        unvisited &= ~((uint64_t) 1 << seed);
+        stack[top++] = seed;
+
+        while (top > 0)
+        {
+            int i = stack[--top];
+            int x = i % _TWR_INFRA_GRID_OCCUPANCY_WIDTH;
+            int y = i / _TWR_INFRA_GRID_OCCUPANCY_WIDTH;
+
+            count++;
+            sum_x += x;
+            sum_y += y;
+
+            int neighbour[4] = {
+                x > 0 ? i - 1 : -1,
+                x < _TWR_INFRA_GRID_OCCUPANCY_WIDTH - 1 ? i + 1 : -1,
+                y > 0 ? i - _TWR_INFRA_GRID_OCCUPANCY_WIDTH : -1,
+                y < _TWR_INFRA_GRID_OCCUPANCY_WIDTH - 1 ? i + _TWR_INFRA_GRID_OCCUPANCY_WIDTH : -1
+            };
+
+            for (int n = 0; n < 4; n++)
+            {
+                if ((neighbour[n] >= 0) && (unvisited & ((uint64_t) 1 << neighbour[n])))
+                {
+                    unvisited &= ~((uint64_t) 1 << neighbour[n]);
+                    stack[top++] = neighbour[n];
+                }
+            }
+        }
+
+        if ((count < self->_min_blob_size) || (blob_count == TWR_INFRA_GRID_OCCUPANCY_MAX_BLOBS))
+        {
+            continue;
+        }
+
+        blob[blob_count].x = (sum_x * 16 + count / 2) / count;
+        blob[blob_count].y = (sum_y * 16 + count / 2) / count;
+
+        blob_count++;
+    }
+
+    return blob_count;
+}
+
+static void _twr_infra_grid_occupancy_track(twr_infra_grid_occupancy_t *self, twr_infra_grid_occupancy_blob_t *blob, int blob_count)
+{
+    uint8_t matched = 0;
+
+    for (int i = 0; i < blob_count; i++)
+    {
+        // Greedy nearest neighbour, blobs move by at most a few pixels between frames
+        int nearest = -1;
+        int nearest_distance = _TWR_INFRA_GRID_OCCUPANCY_MAX_TRACK_DISTANCE + 1;
+
+        for (int j = 0; j < self->_blob_count; j++)
+        {
+            if (matched & (1 << j))
+            {
+                continue;
+            }
+
+            int distance = abs(blob[i].x - self->_blob[j].x) + abs(blob[i].y - self->_blob[j].y);
+
+            if (distance < nearest_distance)
+            {
+                nearest = j;
+                nearest_distance = distance;
+            }
+        }
+
+        if (nearest < 0)
+        {
+            continue;
+        }
+
+        matched |= 1 << nearest;
+
+        int previous_x = self->_blob[nearest].x;
+
+        twr_infra_grid_occupancy_event_t event;
+
+        if ((previous_x <= _TWR_INFRA_GRID_OCCUPANCY_MIDDLE) && (blob[i].x > _TWR_INFRA_GRID_OCCUPANCY_MIDDLE))
+        {
+            self->_count_enter++;
+
+            event = TWR_INFRA_GRID_OCCUPANCY_EVENT_ENTER;
+        }
+        else if ((previous_x > _TWR_INFRA_GRID_OCCUPANCY_MIDDLE) && (blob[i].x <= _TWR_INFRA_GRID_OCCUPANCY_MIDDLE))
+        {
+            self->_count_leave++;
+
+            event = TWR_INFRA_GRID_OCCUPANCY_EVENT_LEAVE;
+        }
+        else
+        {
+            continue;
+        }
+
+        if (self->_event_handler != NULL)
+        {
+            self->_event_handler(self, event, self->_event_param);
+        }
+    }
+}
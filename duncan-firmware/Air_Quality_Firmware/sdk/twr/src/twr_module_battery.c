@@ -5,22 +5,25 @@
 #include <twr_scheduler.h>
 #include <twr_timer.h>
 
-#define _TWR_MODULE_BATTERY_CELL_VOLTAGE 1.5f
+// All voltages are kept in millivolts to avoid soft-float in measurement path
+#define _TWR_MODULE_BATTERY_CELL_VOLTAGE 1500
 
-#define _TWR_MODULE_BATTERY_STANDATD_DEFAULT_LEVEL_LOW        (1.2 * 4)
-#define _TWR_MODULE_BATTERY_DEFAULT_DEFAULT_LEVEL_CRITICAL   (1.0 * 4)
+#define _TWR_MODULE_BATTERY_STANDATD_DEFAULT_LEVEL_LOW        (1200 * 4)
+#define _TWR_MODULE_BATTERY_DEFAULT_DEFAULT_LEVEL_CRITICAL   (1000 * 4)
 
-#define _TWR_MODULE_BATTERY_MINI_DEFAULT_LEVEL_LOW        (1.2 * 2)
-#define _TWR_MODULE_BATTERY_MINI_DEFAULT_LEVEL_CRITICAL   (1.0 * 2)
+#define _TWR_MODULE_BATTERY_MINI_DEFAULT_LEVEL_LOW        (1200 * 2)
+#define _TWR_MODULE_BATTERY_MINI_DEFAULT_LEVEL_CRITICAL   (1000 * 2)
 
-#define _TWR_MODULE_BATTERY_MINI_VOLTAGE_ON_BATTERY_TO_PERCENTAGE(__VOLTAGE__)      ((100. * ((__VOLTAGE__) - _TWR_MODULE_BATTERY_MINI_DEFAULT_LEVEL_CRITICAL)) / ((_TWR_MODULE_BATTERY_CELL_VOLTAGE * 2) - _TWR_MODULE_BATTERY_MINI_DEFAULT_LEVEL_CRITICAL))
-#define _TWR_MODULE_BATTERY_STANDARD_VOLTAGE_ON_BATTERY_TO_PERCENTAGE(__VOLTAGE__)  ((100. * ((__VOLTAGE__) - _TWR_MODULE_BATTERY_DEFAULT_DEFAULT_LEVEL_CRITICAL)) / ((_TWR_MODULE_BATTERY_CELL_VOLTAGE * 4) - _TWR_MODULE_BATTERY_DEFAULT_DEFAULT_LEVEL_CRITICAL))
+#define _TWR_MODULE_BATTERY_MINI_VOLTAGE_ON_BATTERY_TO_PERCENTAGE(__VOLTAGE__)      ((100 * ((__VOLTAGE__) - _TWR_MODULE_BATTERY_MINI_DEFAULT_LEVEL_CRITICAL)) / ((_TWR_MODULE_BATTERY_CELL_VOLTAGE * 2) - _TWR_MODULE_BATTERY_MINI_DEFAULT_LEVEL_CRITICAL))
+#define _TWR_MODULE_BATTERY_STANDARD_VOLTAGE_ON_BATTERY_TO_PERCENTAGE(__VOLTAGE__)  ((100 * ((__VOLTAGE__) - _TWR_MODULE_BATTERY_DEFAULT_DEFAULT_LEVEL_CRITICAL)) / ((_TWR_MODULE_BATTERY_CELL_VOLTAGE * 4) - _TWR_MODULE_BATTERY_DEFAULT_DEFAULT_LEVEL_CRITICAL))
 
-#define _TWR_MODULE_BATTERY_MINI_CALIBRATION(__VOLTAGE__) ((__VOLTAGE__) * 1.095f + 0.0069f)
-#define _TWR_MODULE_BATTERY_STANDARD_CALIBRATION(__VOLTAGE__) ((__VOLTAGE__) * 1.1068f + 0.0212f)
+#define _TWR_MODULE_BATTERY_MINI_CALIBRATION(__VOLTAGE__) (((__VOLTAGE__) * 1095) / 1000 + 7)
+#define _TWR_MODULE_BATTERY_STANDARD_CALIBRATION(__VOLTAGE__) (((__VOLTAGE__) * 11068) / 10000 + 21)
 
-#define _TWR_MODULE_BATTERY_MINI_RESULT_TO_VOLTAGE(__RESULT__)       ((__RESULT__) * (1 / (5.0 / (5.0 + 10.0))))
-#define _TWR_MODULE_BATTERY_STANDARD_RESULT_TO_VOLTAGE(__RESULT__)   ((__RESULT__) * (1 / 0.13))
+#define _TWR_MODULE_BATTERY_MINI_RESULT_TO_VOLTAGE(__RESULT__)       ((__RESULT__) * 3)
+#define _TWR_MODULE_BATTERY_STANDARD_RESULT_TO_VOLTAGE(__RESULT__)   (((__RESULT__) * 100) / 13)
+
+#define _TWR_MODULE_BATTERY_VOLTAGE_INVALID (-1)
 
 typedef enum
 {
@@ -34,19 +37,19 @@ typedef enum
 
 static struct
 {
-    float voltage;
-    float valid_min;
-    float valid_max;
+    int32_t voltage;
+    int32_t valid_min;
+    int32_t valid_max;
     twr_module_battery_format_t format;
     void (*event_handler)(twr_module_battery_event_t, void *);
     void *event_param;
     bool measurement_active;
-    float level_low_threshold;
-    float level_critical_threshold;
+    int32_t level_low_threshold;
+    int32_t level_critical_threshold;
     twr_tick_t update_interval;
     twr_tick_t next_update_start;
     twr_scheduler_task_id_t task_id;
-    float adc_value;
+    int32_t adc_value;
     _twr_module_battery_state_t state;
 
 } _twr_module_battery;
@@ -60,8 +63,8 @@ void twr_module_battery_init(void)
 {
     memset(&_twr_module_battery, 0, sizeof(_twr_module_battery));
 
-    _twr_module_battery.voltage = NAN;
-    _twr_module_battery.adc_value = NAN;
+    _twr_module_battery.voltage = _TWR_MODULE_BATTERY_VOLTAGE_INVALID;
+    _twr_module_battery.adc_value = _TWR_MODULE_BATTERY_VOLTAGE_INVALID;
     _twr_module_battery.update_interval = TWR_TICK_INFINITY;
     _twr_module_battery.task_id = twr_scheduler_register(_twr_module_battery_task, NULL, TWR_TICK_INFINITY);
 
@@ -96,8 +99,14 @@ void twr_module_battery_set_update_interval(twr_tick_t interval)
 
 void twr_module_battery_set_threshold_levels(float level_low_threshold, float level_critical_threshold)
 {
-    _twr_module_battery.level_low_threshold = level_low_threshold;
-    _twr_module_battery.level_critical_threshold = level_critical_threshold;
+    _twr_module_battery.level_low_threshold = level_low_threshold * 1000.f;
+    _twr_module_battery.level_critical_threshold = level_critical_threshold * 1000.f;
+}
+
+void twr_module_battery_set_threshold_levels_fixed(twr_fixed_t level_low_threshold, twr_fixed_t level_critical_threshold)
+{
+    _twr_module_battery.level_low_threshold = (level_low_threshold * 1000) >> TWR_FIXED_FRACTION_BITS;
+    _twr_module_battery.level_critical_threshold = (level_critical_threshold * 1000) >> TWR_FIXED_FRACTION_BITS;
 }
 
 twr_module_battery_format_t twr_module_battery_get_format()
@@ -123,16 +132,35 @@ bool twr_module_battery_measure(void)
 
 bool twr_module_battery_get_voltage(float *voltage)
 {
-    *voltage = _twr_module_battery.voltage;
+    if (_twr_module_battery.voltage == _TWR_MODULE_BATTERY_VOLTAGE_INVALID)
+    {
+        *voltage = NAN;
+
+        return false;
+    }
+
+    *voltage = _twr_module_battery.voltage / 1000.f;
 
-    return !isnan(_twr_module_battery.voltage);
+    return true;
+}
+
+bool twr_module_battery_get_voltage_fixed(twr_fixed_t *voltage)
+{
+    if (_twr_module_battery.voltage == _TWR_MODULE_BATTERY_VOLTAGE_INVALID)
+    {
+        return false;
+    }
+
+    *voltage = TWR_FIXED_FROM_INT(_twr_module_battery.voltage) / 1000;
+
+    return true;
 }
 
 bool twr_module_battery_get_charge_level(int *percentage)
 {
-    float voltage;
+    int32_t voltage = _twr_module_battery.voltage;
 
-    if (twr_module_battery_get_voltage(&voltage))
+    if (voltage != _TWR_MODULE_BATTERY_VOLTAGE_INVALID)
     {
         // Calculate the percentage of charge
         if (_twr_module_battery.format == TWR_MODULE_BATTERY_FORMAT_MINI)
@@ -247,23 +275,23 @@ start:
         }
         case TWR_MODULE_STATE_DETECT_FORMAT:
         {
-            float voltage = _TWR_MODULE_BATTERY_STANDARD_CALIBRATION(_TWR_MODULE_BATTERY_STANDARD_RESULT_TO_VOLTAGE(_twr_module_battery.adc_value));
+            int32_t voltage = _TWR_MODULE_BATTERY_STANDARD_CALIBRATION(_TWR_MODULE_BATTERY_STANDARD_RESULT_TO_VOLTAGE(_twr_module_battery.adc_value));
 
-            if ((voltage > 3.8) && (voltage < 7.0))
+            if ((voltage > 3800) && (voltage < 7000))
             {
                 _twr_module_battery.format = TWR_MODULE_BATTERY_FORMAT_STANDARD;
                 _twr_module_battery.level_low_threshold = _TWR_MODULE_BATTERY_STANDATD_DEFAULT_LEVEL_LOW;
                 _twr_module_battery.level_critical_threshold = _TWR_MODULE_BATTERY_DEFAULT_DEFAULT_LEVEL_CRITICAL;
-                _twr_module_battery.valid_min = 3.8;
-                _twr_module_battery.valid_max = 7.0;
+                _twr_module_battery.valid_min = 3800;
+                _twr_module_battery.valid_max = 7000;
             }
             else
             {
                 _twr_module_battery.format = TWR_MODULE_BATTERY_FORMAT_MINI;
                 _twr_module_battery.level_low_threshold = _TWR_MODULE_BATTERY_MINI_DEFAULT_LEVEL_LOW;
                 _twr_module_battery.level_critical_threshold = _TWR_MODULE_BATTERY_MINI_DEFAULT_LEVEL_CRITICAL;
-                _twr_module_battery.valid_min = 1.8;
-                _twr_module_battery.valid_max = 3.8;
+                _twr_module_battery.valid_min = 1800;
+                _twr_module_battery.valid_max = 3800;
             }
 
             _twr_module_battery.state = TWR_MODULE_STATE_MEASURE;
@@ -317,7 +345,7 @@ start:
 
             if ((_twr_module_battery.voltage < _twr_module_battery.valid_min) || (_twr_module_battery.voltage > _twr_module_battery.valid_max))
             {
-                _twr_module_battery.voltage = NAN;
+                _twr_module_battery.voltage = _TWR_MODULE_BATTERY_VOLTAGE_INVALID;
 
                 _twr_module_battery.state = TWR_MODULE_STATE_DETECT_PRESENT;
 
@@ -373,9 +401,15 @@ static void _twr_module_battery_adc_event_handler(twr_adc_channel_t channel, twr
     if (event == TWR_ADC_EVENT_DONE)
     {
 
-        if (!twr_adc_async_get_voltage(TWR_ADC_CHANNEL_A0, &_twr_module_battery.adc_value))
+        twr_fixed_t adc_voltage;
+
+        if (twr_adc_async_get_voltage_fixed(TWR_ADC_CHANNEL_A0, &adc_voltage))
+        {
+            _twr_module_battery.adc_value = (adc_voltage * 1000) >> TWR_FIXED_FRACTION_BITS;
+        }
+        else
         {
-            _twr_module_battery.adc_value = NAN;
+            _twr_module_battery.adc_value = _TWR_MODULE_BATTERY_VOLTAGE_INVALID;
         }
 
         _twr_module_battery_measurement(DISABLE);
@@ -12,6 +12,10 @@ typedef struct
     bool pending_event_flag;
     twr_pulse_counter_event_t pending_event;
     twr_scheduler_task_id_t task_id;
+    unsigned int count_last;
+    twr_tick_t tick_last;
+    float rate;
+    bool rate_valid;
 
 } twr_pulse_counter_t;
 
@@ -53,6 +57,10 @@ void twr_pulse_counter_set_update_interval(twr_module_sensor_channel_t channel,
 {
     _twr_module_pulse_counter[channel].update_interval = interval;
 
+    _twr_module_pulse_counter[channel].count_last = _twr_module_pulse_counter[channel].count;
+    _twr_module_pulse_counter[channel].tick_last = twr_tick_get();
+    _twr_module_pulse_counter[channel].rate_valid = false;
+
     if (_twr_module_pulse_counter[channel].update_interval == TWR_TICK_INFINITY)
     {
         twr_scheduler_plan_absolute(_twr_module_pulse_counter[channel].task_id, TWR_TICK_INFINITY);
@@ -65,6 +73,9 @@ void twr_pulse_counter_set_update_interval(twr_module_sensor_channel_t channel,
 
 void twr_pulse_counter_set(twr_module_sensor_channel_t channel, unsigned int count)
 {
+    // Pulses since last update stay in the rate
+    _twr_module_pulse_counter[channel].count_last += count - _twr_module_pulse_counter[channel].count;
+
     _twr_module_pulse_counter[channel].count = count;
 }
 
@@ -75,13 +86,43 @@ unsigned int twr_pulse_counter_get(twr_module_sensor_channel_t channel)
 
 void twr_pulse_counter_reset(twr_module_sensor_channel_t channel)
 {
-    _twr_module_pulse_counter[channel].count = 0;
+    twr_pulse_counter_set(channel, 0);
+}
+
+bool twr_pulse_counter_get_rate(twr_module_sensor_channel_t channel, float *rate)
+{
+    if (!_twr_module_pulse_counter[channel].rate_valid)
+    {
+        return false;
+    }
+
+    *rate = _twr_module_pulse_counter[channel].rate;
+
+    return true;
 }
 
 static void _twr_pulse_counter_channel_task_update(void *param)
 {
     twr_pulse_counter_t *self = param;
 
+    if (self->update_interval != TWR_TICK_INFINITY)
+    {
+        twr_tick_t now = twr_tick_get();
+
+        unsigned int count = self->count;
+
+        if (now > self->tick_last)
+        {
+            // Unsigned difference is correct across overflow of count
+            self->rate = (float) (count - self->count_last) * 1000.f / (float) (now - self->tick_last);
+
+            self->rate_valid = true;
+        }
+
+        self->count_last = count;
+        self->tick_last = now;
+    }
+
     if (self->pending_event_flag)
     {
         self->pending_event_flag = false;
@@ -110,15 +151,27 @@ static void _twr_pulse_counter_channel_exti(twr_exti_line_t line, void *param)
     (void) line;
     twr_module_sensor_channel_t channel = *(twr_module_sensor_channel_t *) param;
 
-    _twr_module_pulse_counter[channel].count++;
+    twr_pulse_counter_t *self = &_twr_module_pulse_counter[channel];
+
+    self->count++;
+
+    if (self->count == 0)
+    {
+        self->pending_event = TWR_PULSE_COUNTER_EVENT_OVERFLOW;
+    }
+    else if (!self->pending_event_flag)
+    {
+        // Pending overflow is not replaced by later pulses
+        self->pending_event = TWR_PULSE_COUNTER_EVENT_UPDATE;
+    }
 
-    _twr_module_pulse_counter[channel].pending_event_flag = true;
-    _twr_module_pulse_counter[channel].pending_event = TWR_PULSE_COUNTER_EVENT_UPDATE;
+    self->pending_event_flag = true;
 
-    if (_twr_module_pulse_counter[channel].count == 0)
+    if ((self->update_interval != TWR_TICK_INFINITY) && (self->pending_event != TWR_PULSE_COUNTER_EVENT_OVERFLOW))
     {
-        _twr_module_pulse_counter[channel].pending_event = TWR_PULSE_COUNTER_EVENT_OVERFLOW;
+        // Task picks the count up at update interval, pulse does not wake the scheduler
+        return;
     }
 
-    twr_scheduler_plan_now(_twr_module_pulse_counter[channel].task_id);
+    twr_scheduler_plan_now(self->task_id);
 }
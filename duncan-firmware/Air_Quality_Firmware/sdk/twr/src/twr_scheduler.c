@@ -1,6 +1,7 @@
 #include <twr_scheduler.h>
 #include <twr_system.h>
 #include <twr_error.h>
+#include <twr_profile.h>
 
 static struct
 {
@@ -42,10 +43,22 @@ void twr_scheduler_run(void)
                 {
                     _twr_scheduler.pool[*task_id].tick_execution = TWR_TICK_INFINITY;
 
+#ifdef TWR_PROFILE
+                    _twr_profile_task_begin(*task_id, _twr_scheduler.pool[*task_id].task);
+#endif
+
                     _twr_scheduler.pool[*task_id].task(_twr_scheduler.pool[*task_id].param);
+
+#ifdef TWR_PROFILE
+                    _twr_profile_task_end();
+#endif
                 }
             }
         }
+
+        // Stop PLL left running by the tasks of this pass before going to sleep
+        twr_system_pll_idle();
+
         application_idle();
     }
 }
@@ -0,0 +1,23 @@
+#ifndef _NODE_CONFIG_H
+#define _NODE_CONFIG_H
+
+// Air quality node with LCD Module, tags on I2C0 and CO2 Module
+#define NODE_THERMOMETER 1
+#define NODE_TAG_HUMIDITY 1
+// Humidity Tag has always been published on channel 0, keep topic of existing installations
+#define NODE_HUMIDITY_CHANNEL TWR_RADIO_PUB_CHANNEL_R1_I2C0_ADDRESS_DEFAULT
+#define NODE_TAG_BAROMETER 1
+#define NODE_TAG_VOC_LP 1
+#define NODE_CO2_MODULE 1
+
+#define NODE_CO2_UPDATE_INTERVAL (1 * 60 * 1000)
+#define NODE_TVOC_UPDATE_INTERVAL (1 * 60 * 1000)
+
+// LCD shows every published value
+#define NODE_NOTIFY_APPLICATION 1
+
+void twr_set_nfc(uint64_t *id, const char *topic, void *value, void *param);
+
+#define NODE_SUBS {"raps/-/set/nfc", TWR_RADIO_SUB_PT_STRING, twr_set_nfc, NULL},
+
+#endif
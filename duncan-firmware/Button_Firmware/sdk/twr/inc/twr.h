@@ -21,7 +21,11 @@
 #include <twr_led_strip.h>
 #include <twr_log.h>
 #include <twr_radio_node.h>
+#include <twr_radio_ota.h>
+#include <twr_radio_pub_compact.h>
 #include <twr_radio_pub.h>
+#include <twr_radio_report.h>
+#include <twr_radio_store.h>
 #include <twr_radio.h>
 
 // Peripheral drivers
@@ -40,9 +44,11 @@
 
 // Chip drivers
 
+#include <twr_cmwx1zzabz_uplink.h>
 #include <twr_cmwx1zzabz.h>
 #include <twr_cp201t.h>
 #include <twr_ds2484.h>
+#include <twr_esp8266_mqtt.h>
 #include <twr_esp8266.h>
 #include <twr_hc_sr04.h>
 #include <twr_lis2dh12.h>
@@ -75,6 +81,7 @@
 #include <twr_module_pir.h>
 #include <twr_module_power.h>
 #include <twr_module_relay.h>
+#include <twr_module_rs485_modbus.h>
 #include <twr_module_rs485.h>
 #include <twr_module_sensor.h>
 #include <twr_module_sigfox.h>
@@ -86,6 +93,7 @@
 #include <twr_analog_sensor.h>
 #include <twr_atci.h>
 #include <twr_base64.h>
+#include <twr_bitpack.h>
 #include <twr_chester_a.h>
 #include <twr_config.h>
 #include <twr_data_stream.h>
@@ -93,14 +101,18 @@
 #include <twr_dice.h>
 #include <twr_ds18b20.h>
 #include <twr_error.h>
+#include <twr_fixed.h>
 #include <twr_flood_detector.h>
 #include <twr_font_common.h>
 #include <twr_gfx.h>
 #include <twr_image.h>
+#include <twr_infra_grid_occupancy.h>
+#include <twr_kv.h>
 #include <twr_onewire_ds2484.h>
 #include <twr_onewire_gpio.h>
 #include <twr_onewire_relay.h>
 #include <twr_onewire.h>
+#include <twr_profile.h>
 #include <twr_pulse_counter.h>
 #include <twr_queue.h>
 #include <twr_ramp.h>
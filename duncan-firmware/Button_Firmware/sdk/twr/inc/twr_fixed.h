@@ -0,0 +1,86 @@
+#ifndef _TWR_FIXED_H
+#define _TWR_FIXED_H
+
+#include <twr_common.h>
+
+//! @addtogroup twr_fixed twr_fixed
+//! @brief Q16.16 fixed-point arithmetic for sensor values
+//! @details Core Module has no FPU, values kept in twr_fixed_t avoid soft-float calls in drivers. Float is meant only
+//!          as an edge conversion. Fixed-point values can be fed to data streams of TWR_DATA_STREAM_TYPE_INT.
+//! @{
+
+//! @brief Q16.16 fixed-point value
+
+typedef int32_t twr_fixed_t;
+
+//! @brief Number of fractional bits
+
+#define TWR_FIXED_FRACTION_BITS 16
+
+//! @brief Fixed-point representation of 1
+
+#define TWR_FIXED_ONE ((twr_fixed_t) 1 << TWR_FIXED_FRACTION_BITS)
+
+//! @brief Convert integer to fixed-point value
+
+#define TWR_FIXED_FROM_INT(__VALUE__) ((twr_fixed_t) (__VALUE__) * TWR_FIXED_ONE)
+
+//! @brief Convert constant to fixed-point value (use with constant expressions only, evaluated by compiler)
+
+#define TWR_FIXED_CONST(__VALUE__) ((twr_fixed_t) ((__VALUE__) * 65536.0 + ((__VALUE__) < 0 ? -0.5 : 0.5)))
+
+//! @brief Convert fixed-point value to integer (rounding towards negative infinity)
+
+#define TWR_FIXED_TO_INT(__VALUE__) ((__VALUE__) >> TWR_FIXED_FRACTION_BITS)
+
+//! @brief Convert integer in units of 1 / 2^bits to fixed-point value
+//! @param[in] value Integer value
+//! @param[in] fraction_bits Number of fractional bits of value (0 to 16)
+//! @return Fixed-point value
+
+static inline twr_fixed_t twr_fixed_from_scaled(int32_t value, int fraction_bits)
+{
+    return value * ((twr_fixed_t) 1 << (TWR_FIXED_FRACTION_BITS - fraction_bits));
+}
+
+//! @brief Multiply two fixed-point values
+//! @param[in] a First value
+//! @param[in] b Second value
+//! @return Product
+
+static inline twr_fixed_t twr_fixed_mul(twr_fixed_t a, twr_fixed_t b)
+{
+    return (twr_fixed_t) (((int64_t) a * b) >> TWR_FIXED_FRACTION_BITS);
+}
+
+//! @brief Divide two fixed-point values
+//! @param[in] a Dividend
+//! @param[in] b Divisor (must not be 0)
+//! @return Quotient
+
+static inline twr_fixed_t twr_fixed_div(twr_fixed_t a, twr_fixed_t b)
+{
+    return (twr_fixed_t) (((int64_t) a * TWR_FIXED_ONE) / b);
+}
+
+//! @brief Convert fixed-point value to float (edge conversion)
+//! @param[in] value Fixed-point value
+//! @return Float value
+
+float twr_fixed_to_float(twr_fixed_t value);
+
+//! @brief Convert float to fixed-point value (edge conversion)
+//! @param[in] value Float value
+//! @return Fixed-point value, saturated to range of twr_fixed_t
+
+twr_fixed_t twr_fixed_from_float(float value);
+
+//! @brief Get IEEE 754 single precision bits of fixed-point value using integer operations only
+//! @param[in] value Fixed-point value
+//! @return Bits of float (truncated to 24-bit mantissa)
+
+uint32_t twr_fixed_to_float_bits(twr_fixed_t value);
+
+//! @}
+
+#endif // _TWR_FIXED_H
@@ -7,6 +7,7 @@
 #define _TWR_ESP8266_DELAY_SOCKET_CONNECT 300
 #define _TWR_ESP8266_TIMEOUT_WIFI_CONNECT 20
 #define _TWR_ESP8266_TIMEOUT_SOCKET_CONNECT 10
+#define _TWR_ESP8266_TIMEOUT_SOCKET_RECEIVE 1000
 
 // Apply changes to the factory configuration
 static const char *_esp8266_init_commands[] =
@@ -72,6 +73,10 @@ static void _uart_event_handler(twr_uart_channel_t channel, twr_uart_event_t eve
         twr_scheduler_plan_relative(self->_task_id, 100);
         self->_state = TWR_ESP8266_STATE_RECEIVE;
     }
+    else if (event == TWR_UART_EVENT_ASYNC_READ_DATA && self->_state == TWR_ESP8266_STATE_SOCKET_RECEIVE)
+    {
+        twr_scheduler_plan_now(self->_task_id);
+    }
 }
 
 void _twr_esp8266_enable(twr_esp8266_t *self)
@@ -292,16 +297,15 @@ static void _twr_esp8266_task(void *param)
                         memcpy(length_text, comma_search, colon_search - comma_search);
                         length_text[colon_search - comma_search] = '\0';
                         self->_message_length = atoi(length_text);
-
-                        self->_message_part_length = (strlen(self->_response) - 1) - (colon_search - self->_response);
-                        colon_search++;
-                        memcpy(self->_message_buffer, colon_search, self->_message_part_length);
-
-                        if (self->_message_length > sizeof(self->_message_buffer))
+                        if (self->_message_length == 0)
                         {
-                            self->_message_length = sizeof(self->_message_buffer);
+                            continue;
                         }
 
+                        // Data follow the colon as binary, they are read by exact length
+                        self->_message_part_length = 0;
+                        self->_message_timeout = twr_tick_get() + _TWR_ESP8266_TIMEOUT_SOCKET_RECEIVE;
+
                         self->_state = TWR_ESP8266_STATE_SOCKET_RECEIVE;
 
                         twr_scheduler_plan_current_now();
@@ -693,11 +697,27 @@ static void _twr_esp8266_task(void *param)
             }
             case TWR_ESP8266_STATE_SOCKET_RECEIVE:
             {
+                // Rest of data is waited for, task is planned by UART event handler
                 if (!_twr_esp8266_read_socket_data(self))
                 {
+                    if (twr_tick_get() < self->_message_timeout)
+                    {
+                        twr_scheduler_plan_current_absolute(self->_message_timeout);
+
+                        return;
+                    }
+
+                    // Truncated message is dropped, next data start with a new response
+                    self->_state = TWR_ESP8266_STATE_READY;
+
                     continue;
                 }
 
+                if (self->_message_length > sizeof(self->_message_buffer))
+                {
+                    self->_message_length = sizeof(self->_message_buffer);
+                }
+
                 self->_state = TWR_ESP8266_STATE_READY;
 
                 if (self->_event_handler != NULL)
@@ -838,6 +858,14 @@ static bool _twr_esp8266_read_response(twr_esp8266_t *self)
             break;
         }
 
+        // Received data are not a line, "+IPD,<length>:" ends the response and data stay in FIFO
+        if ((rx_character == ':') && (length > 5) && (memcmp(self->_response, "+IPD,", 5) == 0))
+        {
+            self->_response[length] = '\0';
+
+            break;
+        }
+
         if (length == sizeof(self->_response) - 1)
         {
             return false;
@@ -858,7 +886,13 @@ static bool _twr_esp8266_read_socket_data(twr_esp8266_t *self)
             return false;
         }
 
-        self->_message_buffer[self->_message_part_length++] = rx_character;
+        // Data beyond message buffer are consumed and dropped
+        if (self->_message_part_length < sizeof(self->_message_buffer))
+        {
+            self->_message_buffer[self->_message_part_length] = rx_character;
+        }
+
+        self->_message_part_length++;
 
         if (self->_message_part_length == self->_message_length)
         {
@@ -12,7 +12,7 @@ static struct
 
 } _twr_exti[16];
 
-static inline void _twr_exti_irq_handler(void);
+static inline void _twr_exti_irq_handler(uint32_t lines);
 
 void twr_exti_register(twr_exti_line_t line, twr_exti_edge_t edge, void (*callback)(twr_exti_line_t, void *), void *param)
 {
@@ -53,6 +53,7 @@ void twr_exti_register(twr_exti_line_t line, twr_exti_edge_t edge, void (*callba
     }
 
     // Configure port selection for given line
+    SYSCFG->EXTICR[pin >> 2] &= ~(0xf << ((pin & 3) << 2));
     SYSCFG->EXTICR[pin >> 2] |= port << ((pin & 3) << 2);
 
     if (edge == TWR_EXTI_EDGE_RISING)
@@ -112,38 +113,102 @@ void twr_exti_unregister(twr_exti_line_t line)
     twr_irq_enable();
 }
 
-static inline void _twr_exti_irq_handler(void)
+bool twr_exti_is_registered(twr_exti_line_t line)
 {
-    // Determine source of interrupt and call appropriate callback
-    if ((EXTI->PR & 0x0001) != 0) { EXTI->PR = 0x0001; _twr_exti[0].callback(_twr_exti[0].line, _twr_exti[0].param); return; }
-    if ((EXTI->PR & 0x0002) != 0) { EXTI->PR = 0x0002; _twr_exti[1].callback(_twr_exti[1].line, _twr_exti[1].param); return; }
-    if ((EXTI->PR & 0x0004) != 0) { EXTI->PR = 0x0004; _twr_exti[2].callback(_twr_exti[2].line, _twr_exti[2].param); return; }
-    if ((EXTI->PR & 0x0008) != 0) { EXTI->PR = 0x0008; _twr_exti[3].callback(_twr_exti[3].line, _twr_exti[3].param); return; }
-    if ((EXTI->PR & 0x0010) != 0) { EXTI->PR = 0x0010; _twr_exti[4].callback(_twr_exti[4].line, _twr_exti[4].param); return; }
-    if ((EXTI->PR & 0x0020) != 0) { EXTI->PR = 0x0020; _twr_exti[5].callback(_twr_exti[5].line, _twr_exti[5].param); return; }
-    if ((EXTI->PR & 0x0040) != 0) { EXTI->PR = 0x0040; _twr_exti[6].callback(_twr_exti[6].line, _twr_exti[6].param); return; }
-    if ((EXTI->PR & 0x0080) != 0) { EXTI->PR = 0x0080; _twr_exti[7].callback(_twr_exti[7].line, _twr_exti[7].param); return; }
-    if ((EXTI->PR & 0x0100) != 0) { EXTI->PR = 0x0100; _twr_exti[8].callback(_twr_exti[8].line, _twr_exti[8].param); return; }
-    if ((EXTI->PR & 0x0200) != 0) { EXTI->PR = 0x0200; _twr_exti[9].callback(_twr_exti[9].line, _twr_exti[9].param); return; }
-    if ((EXTI->PR & 0x0400) != 0) { EXTI->PR = 0x0400; _twr_exti[10].callback(_twr_exti[10].line, _twr_exti[10].param); return; }
-    if ((EXTI->PR & 0x0800) != 0) { EXTI->PR = 0x0800; _twr_exti[11].callback(_twr_exti[11].line, _twr_exti[11].param); return; }
-    if ((EXTI->PR & 0x1000) != 0) { EXTI->PR = 0x1000; _twr_exti[12].callback(_twr_exti[12].line, _twr_exti[12].param); return; }
-    if ((EXTI->PR & 0x2000) != 0) { EXTI->PR = 0x2000; _twr_exti[13].callback(_twr_exti[13].line, _twr_exti[13].param); return; }
-    if ((EXTI->PR & 0x4000) != 0) { EXTI->PR = 0x4000; _twr_exti[14].callback(_twr_exti[14].line, _twr_exti[14].param); return; }
-    if ((EXTI->PR & 0x8000) != 0) { EXTI->PR = 0x8000; _twr_exti[15].callback(_twr_exti[15].line, _twr_exti[15].param); return; }
+    // Extract pin number
+    uint8_t pin = (uint8_t) line & 15;
+
+    // Unmasked interrupt request marks registered line
+    return (EXTI->IMR & (1 << pin)) != 0;
+}
+
+bool twr_exti_is_registered_to(twr_exti_line_t line, void (*callback)(twr_exti_line_t, void *), void *param)
+{
+    // Extract pin number
+    uint8_t pin = (uint8_t) line & 15;
+
+    bool result;
+
+    // Disable interrupts
+    twr_irq_disable();
+
+    result = twr_exti_is_registered(line) && (_twr_exti[pin].line == line) && (_twr_exti[pin].callback == callback) && (_twr_exti[pin].param == param);
+
+    // Enable interrupts
+    twr_irq_enable();
+
+    return result;
+}
+
+bool twr_exti_get_gpio_line(twr_gpio_channel_t channel, twr_exti_line_t *line)
+{
+    static const twr_exti_line_t lut[] =
+    {
+        [TWR_GPIO_P0] = TWR_EXTI_LINE_P0,
+        [TWR_GPIO_P1] = TWR_EXTI_LINE_P1,
+        [TWR_GPIO_P2] = TWR_EXTI_LINE_P2,
+        [TWR_GPIO_P3] = TWR_EXTI_LINE_P3,
+        [TWR_GPIO_P4] = TWR_EXTI_LINE_P4,
+        [TWR_GPIO_P5] = TWR_EXTI_LINE_P5,
+        [TWR_GPIO_P6] = TWR_EXTI_LINE_P6,
+        [TWR_GPIO_P7] = TWR_EXTI_LINE_P7,
+        [TWR_GPIO_P8] = TWR_EXTI_LINE_P8,
+        [TWR_GPIO_P9] = TWR_EXTI_LINE_P9,
+        [TWR_GPIO_P10] = TWR_EXTI_LINE_P10,
+        [TWR_GPIO_P11] = TWR_EXTI_LINE_P11,
+        [TWR_GPIO_P12] = TWR_EXTI_LINE_P12,
+        [TWR_GPIO_P13] = TWR_EXTI_LINE_P13,
+        [TWR_GPIO_P14] = TWR_EXTI_LINE_P14,
+        [TWR_GPIO_P15] = TWR_EXTI_LINE_P15,
+        [TWR_GPIO_P16] = TWR_EXTI_LINE_P16,
+        [TWR_GPIO_P17] = TWR_EXTI_LINE_P17,
+        [TWR_GPIO_LED] = TWR_EXTI_LINE_PH1,
+        [TWR_GPIO_BUTTON] = TWR_EXTI_LINE_BUTTON,
+        [TWR_GPIO_INT] = TWR_EXTI_LINE_PC13
+    };
+
+    if ((size_t) channel >= sizeof(lut) / sizeof(lut[0]))
+    {
+        return false;
+    }
+
+    *line = lut[channel];
+
+    return true;
+}
+
+static inline void _twr_exti_irq_handler(uint32_t lines)
+{
+    uint32_t pending;
+
+    // Service all pending lines of the vector in one entry, including edges which arrive meanwhile
+    while ((pending = EXTI->PR & EXTI->IMR & lines) != 0)
+    {
+        EXTI->PR = pending;
+
+        do
+        {
+            int pin = __builtin_ctz(pending);
+
+            pending &= pending - 1;
+
+            _twr_exti[pin].callback(_twr_exti[pin].line, _twr_exti[pin].param);
+        }
+        while (pending != 0);
+    }
 }
 
 void EXTI0_1_IRQHandler(void)
 {
-    _twr_exti_irq_handler();
+    _twr_exti_irq_handler(0x0003);
 }
 
 void EXTI2_3_IRQHandler(void)
 {
-    _twr_exti_irq_handler();
+    _twr_exti_irq_handler(0x000c);
 }
 
 void EXTI4_15_IRQHandler(void)
 {
-    _twr_exti_irq_handler();
+    _twr_exti_irq_handler(0xfff0);
 }
@@ -30,3 +30,59 @@ void twr_irq_enable(void)
         }
     }
 }
+
+void twr_irq_ring_init(twr_irq_ring_t *ring, uint32_t *buffer, size_t count, twr_scheduler_task_id_t task_id)
+{
+    ring->_buffer = buffer;
+    ring->_mask = count - 1;
+    ring->_head = 0;
+    ring->_tail = 0;
+    ring->_task_id = task_id;
+}
+
+bool twr_irq_ring_post(twr_irq_ring_t *ring, uint32_t event)
+{
+    // Handlers of higher priority may post in between, head has to be read and advanced at once
+    twr_irq_disable();
+
+    uint8_t head = ring->_head;
+    uint8_t tail = ring->_tail;
+
+    // Indexes run freely, their difference is the number of events
+    if ((uint8_t) (head - tail) > ring->_mask)
+    {
+        twr_irq_enable();
+
+        return false;
+    }
+
+    ring->_buffer[head & ring->_mask] = event;
+
+    ring->_head = head + 1;
+
+    twr_irq_enable();
+
+    // Task drains the ring, it only needs planning for the first event of a batch
+    if (head == tail)
+    {
+        twr_scheduler_plan_now(ring->_task_id);
+    }
+
+    return true;
+}
+
+bool twr_irq_ring_get(twr_irq_ring_t *ring, uint32_t *event)
+{
+    uint8_t tail = ring->_tail;
+
+    if (tail == ring->_head)
+    {
+        return false;
+    }
+
+    *event = ring->_buffer[tail & ring->_mask];
+
+    ring->_tail = tail + 1;
+
+    return true;
+}
@@ -1,4 +1,5 @@
 #include <twr_radio_pub.h>
+#include <twr_radio_pub_compact.h>
 
 #define _TWR_RADIO_PUB_BUFFER_SIZE_ACCELERATION (1 + sizeof(float) + sizeof(float) + sizeof(float))
 
@@ -50,6 +51,18 @@ bool twr_radio_pub_temperature(uint8_t channel, float *celsius)
     return twr_radio_pub_queue_put(buffer, sizeof(buffer));
 }
 
+bool twr_radio_pub_temperature_fixed(uint8_t channel, twr_fixed_t *celsius)
+{
+    uint8_t buffer[2 + sizeof(*celsius)];
+
+    buffer[0] = TWR_RADIO_HEADER_PUB_TEMPERATURE;
+    buffer[1] = channel;
+
+    twr_radio_fixed_to_buffer(celsius, buffer + 2);
+
+    return twr_radio_pub_queue_put(buffer, sizeof(buffer));
+}
+
 bool twr_radio_pub_humidity(uint8_t channel, float *percentage)
 {
     uint8_t buffer[2 + sizeof(*percentage)];
@@ -62,6 +75,18 @@ bool twr_radio_pub_humidity(uint8_t channel, float *percentage)
     return twr_radio_pub_queue_put(buffer, sizeof(buffer));
 }
 
+bool twr_radio_pub_humidity_fixed(uint8_t channel, twr_fixed_t *percentage)
+{
+    uint8_t buffer[2 + sizeof(*percentage)];
+
+    buffer[0] = TWR_RADIO_HEADER_PUB_HUMIDITY;
+    buffer[1] = channel;
+
+    twr_radio_fixed_to_buffer(percentage, buffer + 2);
+
+    return twr_radio_pub_queue_put(buffer, sizeof(buffer));
+}
+
 bool twr_radio_pub_luminosity(uint8_t channel, float *lux)
 {
     uint8_t buffer[2 + sizeof(*lux)];
@@ -109,6 +134,17 @@ bool twr_radio_pub_battery(float *voltage)
     return twr_radio_pub_queue_put(buffer, sizeof(buffer));
 }
 
+bool twr_radio_pub_battery_fixed(twr_fixed_t *voltage)
+{
+    uint8_t buffer[1 + sizeof(*voltage)];
+
+    buffer[0] = TWR_RADIO_HEADER_PUB_BATTERY;
+
+    twr_radio_fixed_to_buffer(voltage, buffer + 1);
+
+    return twr_radio_pub_queue_put(buffer, sizeof(buffer));
+}
+
 bool twr_radio_pub_acceleration(float *x_axis, float *y_axis, float *z_axis)
 {
     uint8_t buffer[_TWR_RADIO_PUB_BUFFER_SIZE_ACCELERATION];
@@ -498,4 +534,8 @@ void twr_radio_pub_decode(uint64_t *id, uint8_t *buffer, size_t length)
 
         twr_radio_pub_on_value_int(id, buffer[1], pvalue);
     }
+    else if ((buffer[0] == TWR_RADIO_HEADER_PUB_COMPACT_REG) || (buffer[0] == TWR_RADIO_HEADER_PUB_COMPACT_KEY) || (buffer[0] == TWR_RADIO_HEADER_PUB_COMPACT))
+    {
+        _twr_radio_pub_compact_decode(id, buffer, length);
+    }
 }
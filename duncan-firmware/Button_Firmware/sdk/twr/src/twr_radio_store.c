@@ -0,0 +1,564 @@
+#include <twr_radio_store.h>
+#include <twr_radio.h>
+#include <twr_eeprom.h>
+#include <twr_crc.h>
+#include <twr_rtc.h>
+
+#define _TWR_RADIO_STORE_CRC_POLYNOMIAL 0x07
+#define _TWR_RADIO_STORE_AGE_MAX 0xffffff
+#define _TWR_RADIO_STORE_ALIGN(length) (((length) + 3) & ~3UL)
+
+typedef struct
+{
+    uint32_t sequence;
+    uint32_t check;
+
+} _twr_radio_store_block_t;
+
+typedef struct
+{
+    uint16_t generation;
+    uint8_t length;
+    uint8_t crc;
+    uint32_t timestamp;
+
+} _twr_radio_store_record_t;
+
+typedef enum
+{
+    _TWR_RADIO_STORE_RECORD_INVALID = 0,
+    _TWR_RADIO_STORE_RECORD_LIVE = 1,
+    _TWR_RADIO_STORE_RECORD_CONSUMED = 2
+
+} _twr_radio_store_record_state_t;
+
+static struct
+{
+    bool ready;
+    uint32_t address;
+    size_t block_count;
+
+    size_t head_block;
+    uint32_t head_sequence;
+    size_t head_offset;
+
+    size_t tail_block;
+    size_t tail_offset;
+
+    size_t backlog;
+    uint32_t dropped;
+    size_t batch_count;
+
+    twr_tick_t replay_interval;
+    twr_tick_t probe_interval;
+
+} _twr_radio_store;
+
+static bool _twr_radio_store_block_read(size_t block, uint32_t *sequence);
+static bool _twr_radio_store_block_write(size_t block, uint32_t sequence);
+static uint32_t _twr_radio_store_block_sequence(size_t block);
+static _twr_radio_store_record_state_t _twr_radio_store_record_read(size_t block, size_t offset, _twr_radio_store_record_t *record, uint8_t *buffer);
+static uint8_t _twr_radio_store_record_crc(const _twr_radio_store_record_t *record, const uint8_t *buffer);
+static bool _twr_radio_store_next_block(void);
+static void _twr_radio_store_tail_skip(void);
+static uint32_t _twr_radio_store_get_timestamp(void);
+static bool _twr_radio_store_put(const void *buffer, size_t length);
+static size_t _twr_radio_store_batch(uint8_t *buffer, size_t size);
+static void _twr_radio_store_batch_done(void);
+static twr_tick_t _twr_radio_store_get_interval(bool online);
+
+static const _twr_radio_store_hook_t _twr_radio_store_hook =
+{
+    .is_ready = twr_radio_store_is_ready,
+    .get_backlog = twr_radio_store_get_backlog,
+    .put = _twr_radio_store_put,
+    .batch = _twr_radio_store_batch,
+    .batch_done = _twr_radio_store_batch_done,
+    .get_interval = _twr_radio_store_get_interval
+};
+
+bool twr_radio_store_init(uint32_t address, size_t size)
+{
+    memset(&_twr_radio_store, 0, sizeof(_twr_radio_store));
+
+    // Radio reaches the store only through this hook, firmware without the store does not link it
+    _twr_radio_set_store_hook(&_twr_radio_store_hook);
+
+    _twr_radio_store.replay_interval = TWR_RADIO_STORE_REPLAY_INTERVAL;
+    _twr_radio_store.probe_interval = TWR_RADIO_STORE_PROBE_INTERVAL;
+
+    if ((address % 4 != 0) || (size % TWR_RADIO_STORE_BLOCK_SIZE != 0) || (size < 2 * TWR_RADIO_STORE_BLOCK_SIZE))
+    {
+        return false;
+    }
+
+    if (address + size > twr_eeprom_get_size())
+    {
+        return false;
+    }
+
+    _twr_radio_store.address = address;
+    _twr_radio_store.block_count = size / TWR_RADIO_STORE_BLOCK_SIZE;
+
+    bool found = false;
+    uint32_t sequence;
+
+    // Newest block holds the head
+    for (size_t block = 0; block < _twr_radio_store.block_count; block++)
+    {
+        if (_twr_radio_store_block_read(block, &sequence))
+        {
+            if (!found || (int32_t) (sequence - _twr_radio_store.head_sequence) > 0)
+            {
+                _twr_radio_store.head_block = block;
+                _twr_radio_store.head_sequence = sequence;
+
+                found = true;
+            }
+        }
+    }
+
+    if (!found)
+    {
+        // Blank or foreign region, start empty ring
+        if (!_twr_radio_store_block_write(0, 1))
+        {
+            return false;
+        }
+
+        _twr_radio_store.head_sequence = 1;
+        _twr_radio_store.head_offset = sizeof(_twr_radio_store_block_t);
+        _twr_radio_store.tail_offset = _twr_radio_store.head_offset;
+
+        _twr_radio_store.ready = true;
+
+        return true;
+    }
+
+    // Oldest block is the last one of unbroken chain of sequences preceding the head
+    size_t block = _twr_radio_store.head_block;
+
+    for (size_t i = 1; i < _twr_radio_store.block_count; i++)
+    {
+        size_t previous = (_twr_radio_store.head_block + _twr_radio_store.block_count - i) % _twr_radio_store.block_count;
+
+        if (!_twr_radio_store_block_read(previous, &sequence) || (sequence != _twr_radio_store.head_sequence - i))
+        {
+            break;
+        }
+
+        block = previous;
+    }
+
+    bool tail_found = false;
+
+    for (;;)
+    {
+        size_t offset = sizeof(_twr_radio_store_block_t);
+        _twr_radio_store_record_t record;
+        _twr_radio_store_record_state_t state;
+
+        while ((state = _twr_radio_store_record_read(block, offset, &record, NULL)) != _TWR_RADIO_STORE_RECORD_INVALID)
+        {
+            if (state == _TWR_RADIO_STORE_RECORD_LIVE)
+            {
+                if (!tail_found)
+                {
+                    _twr_radio_store.tail_block = block;
+                    _twr_radio_store.tail_offset = offset;
+
+                    tail_found = true;
+                }
+
+                _twr_radio_store.backlog++;
+            }
+
+            offset += sizeof(record) + _TWR_RADIO_STORE_ALIGN(record.length);
+        }
+
+        if (block == _twr_radio_store.head_block)
+        {
+            // Record interrupted by power loss ends the ring, next append overwrites it
+            _twr_radio_store.head_offset = offset;
+
+            break;
+        }
+
+        block = (block + 1) % _twr_radio_store.block_count;
+    }
+
+    if (!tail_found)
+    {
+        _twr_radio_store.tail_block = _twr_radio_store.head_block;
+        _twr_radio_store.tail_offset = _twr_radio_store.head_offset;
+    }
+
+    _twr_radio_store.ready = true;
+
+    return true;
+}
+
+bool twr_radio_store_is_ready(void)
+{
+    return _twr_radio_store.ready;
+}
+
+void twr_radio_store_set_intervals(twr_tick_t replay_interval, twr_tick_t probe_interval)
+{
+    _twr_radio_store.replay_interval = replay_interval;
+    _twr_radio_store.probe_interval = probe_interval;
+}
+
+size_t twr_radio_store_get_backlog(void)
+{
+    return _twr_radio_store.backlog;
+}
+
+uint32_t twr_radio_store_get_dropped(void)
+{
+    return _twr_radio_store.dropped;
+}
+
+void twr_radio_store_clear(void)
+{
+    if (!_twr_radio_store.ready)
+    {
+        return;
+    }
+
+    // Invalidate all blocks, so the records are not found again after reset
+    for (size_t block = 0; block < _twr_radio_store.block_count; block++)
+    {
+        uint32_t check = 0;
+
+        twr_eeprom_write(_twr_radio_store.address + block * TWR_RADIO_STORE_BLOCK_SIZE + offsetof(_twr_radio_store_block_t, check), &check, sizeof(check));
+    }
+
+    _twr_radio_store.head_block = (_twr_radio_store.head_block + 1) % _twr_radio_store.block_count;
+    _twr_radio_store.head_sequence++;
+    _twr_radio_store.head_offset = sizeof(_twr_radio_store_block_t);
+
+    _twr_radio_store_block_write(_twr_radio_store.head_block, _twr_radio_store.head_sequence);
+
+    _twr_radio_store.tail_block = _twr_radio_store.head_block;
+    _twr_radio_store.tail_offset = _twr_radio_store.head_offset;
+
+    _twr_radio_store.backlog = 0;
+    _twr_radio_store.batch_count = 0;
+}
+
+static bool _twr_radio_store_put(const void *buffer, size_t length)
+{
+    if (!_twr_radio_store.ready || (length == 0) || (length > TWR_RADIO_MAX_BUFFER_SIZE))
+    {
+        return false;
+    }
+
+    size_t size = sizeof(_twr_radio_store_record_t) + _TWR_RADIO_STORE_ALIGN(length);
+
+    if (_twr_radio_store.head_offset + size > TWR_RADIO_STORE_BLOCK_SIZE)
+    {
+        if (!_twr_radio_store_next_block())
+        {
+            return false;
+        }
+    }
+
+    _twr_radio_store_record_t record = {
+        .generation = _twr_radio_store.head_sequence,
+        .length = length,
+        .timestamp = _twr_radio_store_get_timestamp()
+    };
+
+    record.crc = _twr_radio_store_record_crc(&record, buffer);
+
+    uint32_t address = _twr_radio_store.address + _twr_radio_store.head_block * TWR_RADIO_STORE_BLOCK_SIZE + _twr_radio_store.head_offset;
+
+    // Data goes first, so torn write leaves the record header invalid
+    if (!twr_eeprom_write(address + sizeof(record), buffer, length))
+    {
+        return false;
+    }
+
+    if (!twr_eeprom_write(address, &record, sizeof(record)))
+    {
+        return false;
+    }
+
+    if (_twr_radio_store.backlog == 0)
+    {
+        _twr_radio_store.tail_block = _twr_radio_store.head_block;
+        _twr_radio_store.tail_offset = _twr_radio_store.head_offset;
+    }
+
+    _twr_radio_store.head_offset += size;
+
+    _twr_radio_store.backlog++;
+
+    return true;
+}
+
+static size_t _twr_radio_store_batch(uint8_t *buffer, size_t size)
+{
+    _twr_radio_store.batch_count = 0;
+
+    if (!_twr_radio_store.ready || (_twr_radio_store.backlog == 0) || (size < 2))
+    {
+        return 0;
+    }
+
+    uint32_t now = _twr_radio_store_get_timestamp();
+    size_t block = _twr_radio_store.tail_block;
+    size_t offset = _twr_radio_store.tail_offset;
+    size_t length = 2;
+
+    buffer[0] = TWR_RADIO_HEADER_PUB_STORED;
+
+    while (_twr_radio_store.batch_count < _twr_radio_store.backlog)
+    {
+        _twr_radio_store_record_t record;
+        uint8_t payload[TWR_RADIO_MAX_BUFFER_SIZE];
+
+        if (_twr_radio_store_record_read(block, offset, &record, payload) != _TWR_RADIO_STORE_RECORD_LIVE)
+        {
+            if (block == _twr_radio_store.head_block)
+            {
+                break;
+            }
+
+            block = (block + 1) % _twr_radio_store.block_count;
+            offset = sizeof(_twr_radio_store_block_t);
+
+            continue;
+        }
+
+        // Length, age in seconds (24 bits) and the publish itself
+        if (length + 4 + record.length > size)
+        {
+            break;
+        }
+
+        uint32_t age = (int32_t) (now - record.timestamp) < 0 ? 0 : now - record.timestamp;
+
+        if (age > _TWR_RADIO_STORE_AGE_MAX)
+        {
+            age = _TWR_RADIO_STORE_AGE_MAX;
+        }
+
+        buffer[length++] = record.length;
+        buffer[length++] = age;
+        buffer[length++] = age >> 8;
+        buffer[length++] = age >> 16;
+
+        memcpy(buffer + length, payload, record.length);
+
+        length += record.length;
+
+        offset += sizeof(record) + _TWR_RADIO_STORE_ALIGN(record.length);
+
+        _twr_radio_store.batch_count++;
+    }
+
+    buffer[1] = _twr_radio_store.batch_count;
+
+    return _twr_radio_store.batch_count != 0 ? length : 0;
+}
+
+static void _twr_radio_store_batch_done(void)
+{
+    while ((_twr_radio_store.batch_count != 0) && (_twr_radio_store.backlog != 0))
+    {
+        _twr_radio_store_tail_skip();
+
+        _twr_radio_store_record_t record;
+
+        if (_twr_radio_store_record_read(_twr_radio_store.tail_block, _twr_radio_store.tail_offset, &record, NULL) != _TWR_RADIO_STORE_RECORD_LIVE)
+        {
+            break;
+        }
+
+        uint32_t address = _twr_radio_store.address + _twr_radio_store.tail_block * TWR_RADIO_STORE_BLOCK_SIZE + _twr_radio_store.tail_offset;
+
+        uint8_t crc = ~record.crc;
+
+        twr_eeprom_write(address + offsetof(_twr_radio_store_record_t, crc), &crc, sizeof(crc));
+
+        _twr_radio_store.tail_offset += sizeof(record) + _TWR_RADIO_STORE_ALIGN(record.length);
+
+        _twr_radio_store.batch_count--;
+        _twr_radio_store.backlog--;
+    }
+
+    _twr_radio_store.batch_count = 0;
+
+    if (_twr_radio_store.backlog == 0)
+    {
+        _twr_radio_store.tail_block = _twr_radio_store.head_block;
+        _twr_radio_store.tail_offset = _twr_radio_store.head_offset;
+    }
+}
+
+static twr_tick_t _twr_radio_store_get_interval(bool online)
+{
+    return online ? _twr_radio_store.replay_interval : _twr_radio_store.probe_interval;
+}
+
+static bool _twr_radio_store_block_read(size_t block, uint32_t *sequence)
+{
+    _twr_radio_store_block_t header;
+
+    twr_eeprom_read(_twr_radio_store.address + block * TWR_RADIO_STORE_BLOCK_SIZE, &header, sizeof(header));
+
+    if (header.check != ~header.sequence)
+    {
+        return false;
+    }
+
+    *sequence = header.sequence;
+
+    return true;
+}
+
+static bool _twr_radio_store_block_write(size_t block, uint32_t sequence)
+{
+    _twr_radio_store_block_t header = {
+        .sequence = sequence,
+        .check = ~sequence
+    };
+
+    return twr_eeprom_write(_twr_radio_store.address + block * TWR_RADIO_STORE_BLOCK_SIZE, &header, sizeof(header));
+}
+
+static uint32_t _twr_radio_store_block_sequence(size_t block)
+{
+    size_t distance = (_twr_radio_store.head_block + _twr_radio_store.block_count - block) % _twr_radio_store.block_count;
+
+    return _twr_radio_store.head_sequence - distance;
+}
+
+static _twr_radio_store_record_state_t _twr_radio_store_record_read(size_t block, size_t offset, _twr_radio_store_record_t *record, uint8_t *buffer)
+{
+    if (offset + sizeof(*record) > TWR_RADIO_STORE_BLOCK_SIZE)
+    {
+        return _TWR_RADIO_STORE_RECORD_INVALID;
+    }
+
+    uint32_t address = _twr_radio_store.address + block * TWR_RADIO_STORE_BLOCK_SIZE + offset;
+
+    twr_eeprom_read(address, record, sizeof(*record));
+
+    // Records left over from older passes over the block end it
+    if (record->generation != (uint16_t) _twr_radio_store_block_sequence(block))
+    {
+        return _TWR_RADIO_STORE_RECORD_INVALID;
+    }
+
+    if ((record->length == 0) || (record->length > TWR_RADIO_MAX_BUFFER_SIZE))
+    {
+        return _TWR_RADIO_STORE_RECORD_INVALID;
+    }
+
+    if (offset + sizeof(*record) + _TWR_RADIO_STORE_ALIGN(record->length) > TWR_RADIO_STORE_BLOCK_SIZE)
+    {
+        return _TWR_RADIO_STORE_RECORD_INVALID;
+    }
+
+    uint8_t payload[TWR_RADIO_MAX_BUFFER_SIZE];
+
+    if (buffer == NULL)
+    {
+        buffer = payload;
+    }
+
+    twr_eeprom_read(address + sizeof(*record), buffer, record->length);
+
+    uint8_t crc = _twr_radio_store_record_crc(record, buffer);
+
+    if (record->crc == crc)
+    {
+        return _TWR_RADIO_STORE_RECORD_LIVE;
+    }
+
+    // Inverted CRC marks replayed record
+    uint8_t consumed = ~crc;
+
+    if (record->crc == consumed)
+    {
+        return _TWR_RADIO_STORE_RECORD_CONSUMED;
+    }
+
+    return _TWR_RADIO_STORE_RECORD_INVALID;
+}
+
+static uint8_t _twr_radio_store_record_crc(const _twr_radio_store_record_t *record, const uint8_t *buffer)
+{
+    uint8_t crc = twr_crc8(_TWR_RADIO_STORE_CRC_POLYNOMIAL, &record->generation, sizeof(record->generation), 0);
+
+    crc = twr_crc8(_TWR_RADIO_STORE_CRC_POLYNOMIAL, &record->length, sizeof(record->length), crc);
+    crc = twr_crc8(_TWR_RADIO_STORE_CRC_POLYNOMIAL, &record->timestamp, sizeof(record->timestamp), crc);
+
+    return twr_crc8(_TWR_RADIO_STORE_CRC_POLYNOMIAL, buffer, record->length, crc);
+}
+
+static bool _twr_radio_store_next_block(void)
+{
+    size_t block = (_twr_radio_store.head_block + 1) % _twr_radio_store.block_count;
+
+    if ((_twr_radio_store.backlog != 0) && (block == _twr_radio_store.tail_block))
+    {
+        // Ring is full, drop the oldest block with records not replayed yet
+        size_t offset = _twr_radio_store.tail_offset;
+        _twr_radio_store_record_t record;
+
+        while (_twr_radio_store_record_read(block, offset, &record, NULL) != _TWR_RADIO_STORE_RECORD_INVALID)
+        {
+            _twr_radio_store.backlog--;
+            _twr_radio_store.dropped++;
+
+            offset += sizeof(record) + _TWR_RADIO_STORE_ALIGN(record.length);
+        }
+
+        _twr_radio_store.tail_block = (block + 1) % _twr_radio_store.block_count;
+        _twr_radio_store.tail_offset = sizeof(_twr_radio_store_block_t);
+
+        // Batch in flight may refer to dropped records
+        _twr_radio_store.batch_count = 0;
+    }
+
+    if (!_twr_radio_store_block_write(block, _twr_radio_store.head_sequence + 1))
+    {
+        return false;
+    }
+
+    _twr_radio_store.head_block = block;
+    _twr_radio_store.head_sequence++;
+    _twr_radio_store.head_offset = sizeof(_twr_radio_store_block_t);
+
+    return true;
+}
+
+static void _twr_radio_store_tail_skip(void)
+{
+    // Move tail to the next block once it reaches the end of records in its block
+    while (_twr_radio_store.tail_block != _twr_radio_store.head_block)
+    {
+        _twr_radio_store_record_t record;
+
+        if (_twr_radio_store_record_read(_twr_radio_store.tail_block, _twr_radio_store.tail_offset, &record, NULL) == _TWR_RADIO_STORE_RECORD_LIVE)
+        {
+            return;
+        }
+
+        _twr_radio_store.tail_block = (_twr_radio_store.tail_block + 1) % _twr_radio_store.block_count;
+        _twr_radio_store.tail_offset = sizeof(_twr_radio_store_block_t);
+    }
+}
+
+static uint32_t _twr_radio_store_get_timestamp(void)
+{
+    struct timespec ts;
+
+    twr_rtc_get_timestamp(&ts);
+
+    return ts.tv_sec;
+}
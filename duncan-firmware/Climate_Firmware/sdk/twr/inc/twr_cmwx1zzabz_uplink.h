@@ -0,0 +1,141 @@
+#ifndef _TWR_CMWX1ZZABZ_UPLINK_H
+#define _TWR_CMWX1ZZABZ_UPLINK_H
+
+#include <twr_cmwx1zzabz.h>
+
+//! @addtogroup twr_cmwx1zzabz_uplink twr_cmwx1zzabz_uplink
+//! @brief Uplink aggregation and duty cycle aware transmit scheduler for CMWX1ZZABZ
+//! @details Records added by application are packed into one frame up to the maximum payload of the configured
+//!          datarate. Frame is sent unconfirmed when it is full or when its oldest record reaches the maximum delay,
+//!          but never before the off-time of the previous uplink has passed. Off-time is the time-on-air of the
+//!          previous uplink (including repetitions) scaled by the duty cycle, so all uplinks are budgeted against
+//!          one sub-band, which is what the modem uses with the default EU868 channels (868.1, 868.3 and 868.5 MHz,
+//!          all in the 1 % sub-band). Optional daily airtime limit (network fair use policy) spaces uplinks the same
+//!          way. Every n-th uplink is followed by a link check instead of sending confirmed messages.
+//!          Scheduler takes over the event handler of the modem and forwards all events to its own handler.
+//! @{
+
+//! @brief Default maximum delay of record in milliseconds
+
+#define TWR_CMWX1ZZABZ_UPLINK_MAX_DELAY_DEFAULT (15 * 60 * 1000)
+
+//! @brief Default number of uplinks between link checks
+
+#define TWR_CMWX1ZZABZ_UPLINK_LINK_CHECK_INTERVAL_DEFAULT 24
+
+//! @brief LoRaWAN overhead of uplink frame (MHDR, FHDR without options, FPort and MIC)
+
+#define TWR_CMWX1ZZABZ_UPLINK_OVERHEAD 13
+
+//! @brief Uplink scheduler instance
+
+typedef struct twr_cmwx1zzabz_uplink_t twr_cmwx1zzabz_uplink_t;
+
+//! @cond
+
+struct twr_cmwx1zzabz_uplink_t
+{
+    twr_cmwx1zzabz_t *_lora;
+    twr_scheduler_task_id_t _task_id;
+    void (*_event_handler)(twr_cmwx1zzabz_t *, twr_cmwx1zzabz_event_t, void *);
+    void *_event_param;
+    uint8_t _frame[TWR_CMWX1ZZABZ_TX_MAX_PACKET_SIZE];
+    size_t _length;
+    bool _flush;
+    twr_tick_t _max_delay;
+    twr_tick_t _tick_deadline;
+    twr_tick_t _tick_ready;
+    uint16_t _duty_cycle;
+    twr_tick_t _daily_airtime;
+    uint16_t _link_check_interval;
+    uint16_t _link_check_counter;
+    bool _link_check;
+    uint32_t _uplink_count;
+    uint64_t _airtime;
+};
+
+//! @endcond
+
+//! @brief Initialize uplink scheduler (after twr_cmwx1zzabz_init)
+//! @param[in] self Instance
+//! @param[in] lora Modem instance, its event handler is replaced by scheduler
+
+void twr_cmwx1zzabz_uplink_init(twr_cmwx1zzabz_uplink_t *self, twr_cmwx1zzabz_t *lora);
+
+//! @brief Set callback function, receives all events of modem
+//! @param[in] self Instance
+//! @param[in] event_handler Function address
+//! @param[in] event_param Optional event parameter (can be NULL)
+
+void twr_cmwx1zzabz_uplink_set_event_handler(twr_cmwx1zzabz_uplink_t *self, void (*event_handler)(twr_cmwx1zzabz_t *, twr_cmwx1zzabz_event_t, void *), void *event_param);
+
+//! @brief Set maximum time record waits for frame to fill
+//! @param[in] self Instance
+//! @param[in] max_delay Maximum delay in milliseconds (0 sends every record as soon as duty cycle allows)
+
+void twr_cmwx1zzabz_uplink_set_max_delay(twr_cmwx1zzabz_uplink_t *self, twr_tick_t max_delay);
+
+//! @brief Set duty cycle of sub-band
+//! @param[in] self Instance
+//! @param[in] permille Duty cycle in permille (10 is 1 %, 0 selects 1 % for EU868 and no limit for other bands)
+
+void twr_cmwx1zzabz_uplink_set_duty_cycle(twr_cmwx1zzabz_uplink_t *self, uint16_t permille);
+
+//! @brief Set daily airtime limit
+//! @param[in] self Instance
+//! @param[in] airtime Airtime per day in milliseconds (0 for no limit)
+
+void twr_cmwx1zzabz_uplink_set_daily_airtime(twr_cmwx1zzabz_uplink_t *self, twr_tick_t airtime);
+
+//! @brief Set number of uplinks between link checks
+//! @param[in] self Instance
+//! @param[in] interval Number of uplinks (0 disables link checks)
+
+void twr_cmwx1zzabz_uplink_set_link_check_interval(twr_cmwx1zzabz_uplink_t *self, uint16_t interval);
+
+//! @brief Get maximum frame payload for configured band and datarate
+//! @param[in] self Instance
+//! @return Maximum payload in bytes
+
+size_t twr_cmwx1zzabz_uplink_get_max_length(twr_cmwx1zzabz_uplink_t *self);
+
+//! @brief Add record to frame
+//! @param[in] self Instance
+//! @param[in] buffer Pointer to record
+//! @param[in] length Length of record
+//! @return true On success
+//! @return false If record does not fit frame waiting for duty cycle
+
+bool twr_cmwx1zzabz_uplink_add(twr_cmwx1zzabz_uplink_t *self, const void *buffer, size_t length);
+
+//! @brief Send frame as soon as duty cycle allows
+//! @param[in] self Instance
+//! @return true On success
+//! @return false If frame is empty
+
+bool twr_cmwx1zzabz_uplink_flush(twr_cmwx1zzabz_uplink_t *self);
+
+//! @brief Get time left until next uplink is allowed
+//! @param[in] self Instance
+//! @return Time in milliseconds (0 if uplink is allowed now)
+
+twr_tick_t twr_cmwx1zzabz_uplink_get_off_time(twr_cmwx1zzabz_uplink_t *self);
+
+//! @brief Get statistics since initialization
+//! @param[in] self Instance
+//! @param[out] uplink_count Number of uplinks including link checks (can be NULL)
+//! @param[out] airtime Time-on-air of uplinks including repetitions in milliseconds (can be NULL)
+
+void twr_cmwx1zzabz_uplink_get_statistics(twr_cmwx1zzabz_uplink_t *self, uint32_t *uplink_count, uint32_t *airtime);
+
+//! @brief Calculate time-on-air of uplink
+//! @param[in] band Band
+//! @param[in] datarate Datarate
+//! @param[in] length Length of payload without LoRaWAN overhead
+//! @return Time-on-air in microseconds
+
+uint32_t twr_cmwx1zzabz_uplink_time_on_air(twr_cmwx1zzabz_config_band_t band, uint8_t datarate, size_t length);
+
+//! @}
+
+#endif // _TWR_CMWX1ZZABZ_UPLINK_H
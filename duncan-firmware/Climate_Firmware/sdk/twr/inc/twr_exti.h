@@ -2,6 +2,7 @@
 #define _TWR_EXTI_H
 
 #include <twr_common.h>
+#include <twr_gpio.h>
 
 //! @addtogroup twr_exti twr_exti
 //! @brief Driver for EXTI (external interrupts)
@@ -218,6 +219,35 @@ void twr_exti_register(twr_exti_line_t line, twr_exti_edge_t edge, void (*callba
 
 void twr_exti_unregister(twr_exti_line_t line);
 
+//! @brief Check if EXTI line is registered
+//! @details Lines of the same pin number on different ports share one interrupt, so line is reported as registered
+//!          also while another line of its pin number is registered. Drivers which can fall back to polling use this
+//!          to leave the line to its owner.
+//! @param[in] line EXTI line
+//! @return true If line or another line of the same pin number is registered
+//! @return false If line is free
+
+bool twr_exti_is_registered(twr_exti_line_t line);
+
+//! @brief Check if EXTI line is still registered with given callback function and parameter
+//! @details Later registration of the same pin number takes the interrupt over, drivers check this before they
+//!          unregister the line or share it.
+//! @param[in] line EXTI line
+//! @param[in] callback Callback function passed to twr_exti_register
+//! @param[in] param Parameter passed to twr_exti_register
+//! @return true If line is registered with the callback function and parameter
+//! @return false If line is free or registered by someone else
+
+bool twr_exti_is_registered_to(twr_exti_line_t line, void (*callback)(twr_exti_line_t, void *), void *param);
+
+//! @brief Get EXTI line of GPIO channel
+//! @param[in] channel GPIO channel
+//! @param[out] line EXTI line
+//! @return true If GPIO channel can be used as EXTI line
+//! @return false If GPIO channel has no EXTI line
+
+bool twr_exti_get_gpio_line(twr_gpio_channel_t channel, twr_exti_line_t *line);
+
 //! @}
 
 #endif // _TWR_EXTI_H
@@ -5,8 +5,24 @@
 
 //! @addtogroup twr_usb_cdc twr_usb_cdc
 //! @brief USB CDC communication library
+//! @details In framing mode everything written in one scheduler pass goes to host as one binary frame:
+//!          0xa5 0x5a, record section length (uint16 LE), sequence number (uint8), records, CRC16 (LE, CCITT with
+//!          polynomial 0x1021 and initialization 0xffff over length, sequence and records). Each record is type
+//!          (uint8), payload length (uint8) and payload. Host detects lost frames from gaps in sequence numbers.
 //! @{
 
+//! @brief Record types in framing mode
+
+typedef enum
+{
+    //! @brief Bytes written by twr_usb_cdc_write (e.g. text lines of gateway)
+    TWR_USB_CDC_RECORD_RAW = 0,
+
+    //! @brief MQTT publish, zero terminated topic followed by payload
+    TWR_USB_CDC_RECORD_PUBLISH = 1
+
+} twr_usb_cdc_record_t;
+
 //! @brief Initialize USB CDC library
 
 void twr_usb_cdc_init(void);
@@ -26,6 +42,28 @@ bool twr_usb_cdc_write(const void *buffer, size_t length);
 
 size_t twr_usb_cdc_read(void *buffer, size_t length);
 
+//! @brief Enable or disable framing mode (call before first write)
+//! @param[in] framing Framing mode
+
+void twr_usb_cdc_set_framing(bool framing);
+
+//! @brief Write record to frame in framing mode (non-blocking call)
+//! @param[in] type Record type from twr_usb_cdc_record_t or application specific (128 and above)
+//! @param[in] buffer Pointer to payload
+//! @param[in] length Payload length (up to 255 bytes)
+//! @return true On success
+//! @return false On failure (not in framing mode, payload too long or frame full)
+
+bool twr_usb_cdc_write_record(uint8_t type, const void *buffer, size_t length);
+
+//! @brief Write MQTT publish record in framing mode (non-blocking call)
+//! @param[in] topic Topic
+//! @param[in] payload Payload (e.g. JSON value)
+//! @return true On success
+//! @return false On failure
+
+bool twr_usb_cdc_publish(const char *topic, const char *payload);
+
 //! @}
 
 #endif // _TWR_USB_CDC_H
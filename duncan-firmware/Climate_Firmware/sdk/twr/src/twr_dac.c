@@ -197,6 +197,12 @@ bool twr_dac_async_run(twr_dac_channel_t channel)
         return false;
     }
 
+    // DMA channel can be held by UART transmission
+    if (twr_dma_channel_is_used(dac_channel_setup->dma_channel))
+    {
+        return false;
+    }
+
     twr_system_pll_enable();
 
     if (channel == TWR_DAC_DAC0)
@@ -275,6 +281,8 @@ void twr_dac_async_stop(twr_dac_channel_t channel)
 
     twr_dma_channel_stop(dac_channel_setup->dma_channel);
 
+    twr_dma_set_event_handler(dac_channel_setup->dma_channel, NULL, NULL);
+
     if (channel == TWR_DAC_DAC0)
     {
         DAC->CR &= ~(DAC_CR_DMAEN1_Msk | DAC_CR_TEN1_Msk | DAC_CR_TSEL1_Msk);
@@ -0,0 +1,13 @@
+#ifndef _NODE_CONFIG_H
+#define _NODE_CONFIG_H
+
+// Climate Module measuring on service intervals of gateway configuration
+#define NODE_CLIMATE_MODULE 1
+#define NODE_UPDATE_SERVICE 1
+
+#define NODE_TEMPERATURE_UPDATE_INTERVAL (1 * 60 * 1000)
+#define NODE_HUMIDITY_UPDATE_INTERVAL (1 * 60 * 1000)
+#define NODE_ILLUMINANCE_UPDATE_INTERVAL (1 * 60 * 1000)
+#define NODE_PRESSURE_UPDATE_INTERVAL (1 * 60 * 1000)
+
+#endif
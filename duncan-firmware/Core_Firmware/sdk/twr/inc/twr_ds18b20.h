@@ -76,6 +76,11 @@ struct twr_ds18b20_t
     bool _power;
     bool _power_dynamic;
     twr_onewire_t *_onewire;
+
+    bool _rom_cache;
+    uint32_t _rom_cache_address;
+    bool _rescan;
+    bool _present;
 };
 
 //! @endcond
@@ -166,6 +171,22 @@ int twr_ds18b20_get_sensor_found(twr_ds18b20_t *self);
 
 void twr_ds18b20_set_power_dynamic(twr_ds18b20_t *self, bool on);
 
+//! @brief Keep list of found sensors in EEPROM, so the bus is not searched on every start
+//! @details Cached list is used as long as all sensors answer. Bus is searched again and the list is updated after
+//!          scratchpad CRC failure or when sensors appear on the bus again after no presence pulse. Call before the
+//!          first measurement, region occupies 2 + 8 * sensor_count bytes.
+//! @param[in] self Instance
+//! @param[in] address EEPROM start address of the region (must not overlap other EEPROM users)
+//! @return true On success
+//! @return false When region does not fit into EEPROM
+
+bool twr_ds18b20_set_rom_cache(twr_ds18b20_t *self, uint32_t address);
+
+//! @brief Search the bus for sensors again before next measurement (e.g. after sensor has been added)
+//! @param[in] self Instance
+
+void twr_ds18b20_rescan(twr_ds18b20_t *self);
+
 //! @}
 
 #endif // _TWR_DS18B20_H
@@ -0,0 +1,145 @@
+#ifndef _TWR_RADIO_OTA_H
+#define _TWR_RADIO_OTA_H
+
+#include <twr_radio.h>
+
+//! @addtogroup twr_radio_ota twr_radio_ota
+//! @brief Firmware update over radio with patches against the running firmware
+//! @details Gateway sends a manifest (size and SHA-256 of the new image, size of the patch) and then the patch in
+//!          chunks addressed by offset. Patch is a sequence of operations, copy from the running image (op 0x00,
+//!          length, zig-zag source offset relative to output offset, both as varint) or literal bytes (op 0x01,
+//!          length as varint, bytes), images which differ in a few strings or relocated code need only a few kB.
+//!          Node applies the patch into staging flash region, sends status after each window of data, verifies the
+//!          SHA-256 of the result and installs it once supply voltage is above TWR_RADIO_OTA_INSTALL_PVD_LEVEL.
+//!          Install writes a resident copier after the staging region and replaces the first page of the running
+//!          image by a boot stub whose vectors lead to the copier, so reset during install (brown-out) resumes the
+//!          copy. Copier writes the first page last and resets. Power loss while the first page itself is erased or
+//!          programmed (twice a few ms) is the only remaining window without recovery. Interrupted transfer
+//!          continues from the offset in status, repeated manifest of the same image resumes it. Images are linked
+//!          for the first bank, so both banks cannot be swapped. Patches are created by
+//!          duncan-firmware/tools/ota/twr_ota_diff.py.
+//! @{
+
+//! @brief Start of staging region (second flash bank), running image must end below it
+
+#ifndef TWR_RADIO_OTA_STAGING_ADDRESS
+#define TWR_RADIO_OTA_STAGING_ADDRESS 0x08018000
+#endif
+
+//! @brief Size of flash region after staging region kept for resident copier (multiple of page size)
+
+#ifndef TWR_RADIO_OTA_COPIER_SIZE
+#define TWR_RADIO_OTA_COPIER_SIZE 512
+#endif
+
+//! @brief Size of staging region, upper limit of image size (flash up to copier)
+
+#ifndef TWR_RADIO_OTA_STAGING_SIZE
+#define TWR_RADIO_OTA_STAGING_SIZE (0x18000 - 128 - TWR_RADIO_OTA_COPIER_SIZE)
+#endif
+
+//! @brief Start of resident copier (below product information block)
+
+#define TWR_RADIO_OTA_COPIER_ADDRESS (TWR_RADIO_OTA_STAGING_ADDRESS + TWR_RADIO_OTA_STAGING_SIZE)
+
+//! @brief Level of programmable voltage detector supply has to be above before install (3 is 2.5 V)
+
+#ifndef TWR_RADIO_OTA_INSTALL_PVD_LEVEL
+#define TWR_RADIO_OTA_INSTALL_PVD_LEVEL 3
+#endif
+
+//! @brief Amount of patch data gateway may send before waiting for status
+
+#define TWR_RADIO_OTA_WINDOW_SIZE 256
+
+//! @brief Maximum length of patch data in one chunk
+
+#define TWR_RADIO_OTA_CHUNK_SIZE (TWR_RADIO_MAX_BUFFER_SIZE - 1 - TWR_RADIO_ID_SIZE - 4)
+
+//! @brief Time node keeps listening after manifest or chunk
+
+#define TWR_RADIO_OTA_LISTEN_TIMEOUT (10 * 1000)
+
+//! @brief Status reported by node
+
+typedef enum
+{
+    //! @brief Ready for data from offset
+    TWR_RADIO_OTA_STATUS_READY = 0,
+
+    //! @brief Image verified, node is installing it and restarts
+    TWR_RADIO_OTA_STATUS_DONE = 1,
+
+    //! @brief Image does not fit staging region or running image overlaps it
+    TWR_RADIO_OTA_STATUS_ERROR_SIZE = 2,
+
+    //! @brief Patch is malformed or refers outside of running image
+    TWR_RADIO_OTA_STATUS_ERROR_PATCH = 3,
+
+    //! @brief Result does not match SHA-256 of manifest (patch made against other image)
+    TWR_RADIO_OTA_STATUS_ERROR_VERIFY = 4,
+
+    //! @brief Flash programming failed
+    TWR_RADIO_OTA_STATUS_ERROR_FLASH = 5,
+
+    //! @brief Chunk without manifest
+    TWR_RADIO_OTA_STATUS_ERROR_STATE = 6,
+
+    //! @brief Supply too low to install verified image, install is retried every minute
+    TWR_RADIO_OTA_STATUS_ERROR_POWER = 7
+
+} twr_radio_ota_status_t;
+
+//! @brief Manifest of update
+
+typedef struct
+{
+    //! @brief Size of new image
+    uint32_t image_size;
+
+    //! @brief Size of patch
+    uint32_t patch_size;
+
+    //! @brief SHA-256 of new image
+    uint8_t sha256[32];
+
+} twr_radio_ota_manifest_t;
+
+//! @brief Initialize update over radio, on node to accept updates, on gateway to receive status of nodes
+
+void twr_radio_ota_init(void);
+
+//! @brief Send manifest to node (gateway)
+//! @param[in] id Pointer to node id
+//! @param[in] manifest Manifest
+//! @return true On success
+//! @return false On full queue
+
+bool twr_radio_ota_begin(uint64_t *id, const twr_radio_ota_manifest_t *manifest);
+
+//! @brief Send chunk of patch to node (gateway), up to TWR_RADIO_OTA_WINDOW_SIZE bytes past offset of last status
+//! @param[in] id Pointer to node id
+//! @param[in] offset Offset of chunk in patch
+//! @param[in] buffer Pointer to chunk
+//! @param[in] length Length of chunk (up to TWR_RADIO_OTA_CHUNK_SIZE)
+//! @return true On success
+//! @return false On full queue or too long chunk
+
+bool twr_radio_ota_data(uint64_t *id, uint32_t offset, const void *buffer, size_t length);
+
+//! @brief Callback with status of node (gateway), send data from offset on TWR_RADIO_OTA_STATUS_READY
+//! @param[in] id Pointer to node id
+//! @param[in] status Status
+//! @param[in] offset Offset in patch node expects next
+
+void twr_radio_ota_on_status(uint64_t *id, twr_radio_ota_status_t status, uint32_t offset);
+
+//! @cond
+
+void _twr_radio_ota_decode(uint64_t *id, uint8_t *buffer, size_t length);
+
+//! @endcond
+
+//! @}
+
+#endif // _TWR_RADIO_OTA_H
@@ -0,0 +1,71 @@
+#ifndef _TWR_RADIO_STORE_H
+#define _TWR_RADIO_STORE_H
+
+#include <twr_common.h>
+#include <twr_tick.h>
+
+//! @addtogroup twr_radio_store twr_radio_store
+//! @brief Store-and-forward buffer in EEPROM for publishes which could not be delivered
+//! @details Once initialized, publishes which run out of retransmissions, do not fit into the publish queue or are
+//!          published while the gateway does not acknowledge are timestamped and appended to a ring in EEPROM.
+//!          Gateway is taken as not acknowledging after three frames in a row ran out of retransmissions.
+//!          Stored publishes are replayed in batched frames, one frame per replay interval, oldest first. While
+//!          the gateway does not acknowledge, the replay frame serves as a probe sent once per probe interval.
+//!          Gateway decodes the batch as ordinary publishes, twr_radio_get_rx_age tells how old they are.
+//!          When the ring is full, the oldest block of records is dropped.
+//! @{
+
+//! @brief Minimum time between two replay frames while the gateway acknowledges
+
+#ifndef TWR_RADIO_STORE_REPLAY_INTERVAL
+#define TWR_RADIO_STORE_REPLAY_INTERVAL 500
+#endif
+
+//! @brief Time between two replay frames while the gateway does not acknowledge
+
+#ifndef TWR_RADIO_STORE_PROBE_INTERVAL
+#define TWR_RADIO_STORE_PROBE_INTERVAL 60000
+#endif
+
+//! @brief Size of EEPROM block, region is used in blocks of this size
+
+#define TWR_RADIO_STORE_BLOCK_SIZE 128
+
+//! @brief Initialize store and find stored records in EEPROM
+//! @details Call after twr_radio_init, the store is linked to radio by this call only.
+//! @param[in] address EEPROM start address of the region (multiple of 4, must not overlap twr_kv or config region)
+//! @param[in] size Size of the region in bytes (multiple of TWR_RADIO_STORE_BLOCK_SIZE, at least two blocks)
+//! @return true On success
+//! @return false On invalid region or EEPROM write failure
+
+bool twr_radio_store_init(uint32_t address, size_t size);
+
+//! @brief Check if store has been initialized
+//! @return true If initialized
+//! @return false If not initialized
+
+bool twr_radio_store_is_ready(void);
+
+//! @brief Set replay rate limit
+//! @param[in] replay_interval Minimum time between replay frames while gateway acknowledges
+//! @param[in] probe_interval Time between replay frames while gateway does not acknowledge
+
+void twr_radio_store_set_intervals(twr_tick_t replay_interval, twr_tick_t probe_interval);
+
+//! @brief Get number of stored records waiting for replay
+//! @return Number of records
+
+size_t twr_radio_store_get_backlog(void);
+
+//! @brief Get number of records dropped because the ring was full
+//! @return Number of records
+
+uint32_t twr_radio_store_get_dropped(void);
+
+//! @brief Drop all stored records
+
+void twr_radio_store_clear(void);
+
+//! @}
+
+#endif // _TWR_RADIO_STORE_H
@@ -2,11 +2,14 @@
 #define TWR_SWITCH_H
 
 #include <twr_gpio.h>
+#include <twr_exti.h>
 #include <twr_tick.h>
 #include <twr_scheduler.h>
 
 //! @addtogroup twr_switch twr_switch
 //! @brief Driver for switch
+//! @details Switch with static pull waits for edge on its EXTI line and is sampled only until the input settles.
+//!          Switch with dynamic pull is sampled periodically.
 //! @{
 
 #define TWR_SWITCH_OPEN false
@@ -85,6 +88,8 @@ struct twr_switch_t
     twr_tick_t _debounce_time;
     twr_tick_t _tick_debounce;
     uint16_t _pull_advance_time;
+    bool _exti_armed;
+    twr_exti_line_t _exti_line;
 };
 
 //! @endcond
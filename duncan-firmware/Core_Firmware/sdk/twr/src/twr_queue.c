@@ -71,3 +71,8 @@ void twr_queue_clear(twr_queue_t *queue)
 {
     queue->_length = 0;
 }
+
+bool twr_queue_is_empty(twr_queue_t *queue)
+{
+    return queue->_length == 0;
+}
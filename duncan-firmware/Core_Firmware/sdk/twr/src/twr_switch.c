@@ -5,8 +5,13 @@
 #define _TWR_SWITCH_DEBOUNCE_TIME        20
 #define _TWR_SWITCH_PULL_ADVANCE_TIME_US 50
 
+// Armed switch still checks its pin now and then, edges are lost once another driver takes the EXTI line over
+#define _TWR_SWITCH_EXTI_WATCHDOG_INTERVAL 1000
+
 static void _twr_switch_task(void *param);
 
+static void _twr_switch_exti_handler(twr_exti_line_t line, void *param);
+
 static const twr_gpio_pull_t _twr_switch_pull_lut[5] = {
         [TWR_SWITCH_PULL_NONE] = TWR_GPIO_PULL_NONE,
         [TWR_SWITCH_PULL_UP] = TWR_GPIO_PULL_UP,
@@ -17,13 +22,14 @@ static const twr_gpio_pull_t _twr_switch_pull_lut[5] = {
 
 void twr_switch_init(twr_switch_t *self, twr_gpio_channel_t channel, twr_switch_type_t type, twr_switch_pull_t pull)
 {
-    memset(self, 0, sizeof(&self));
+    memset(self, 0, sizeof(*self));
     self->_channel = channel;
     self->_type = type;
     self->_pull = pull;
     self->_scan_interval = _TWR_SWITCH_SCAN_INTERVAL;
     self->_debounce_time = _TWR_SWITCH_DEBOUNCE_TIME;
     self->_pull_advance_time = _TWR_SWITCH_PULL_ADVANCE_TIME_US;
+    self->_tick_debounce = TWR_TICK_INFINITY;
 
     twr_gpio_init(channel);
 
@@ -84,6 +90,21 @@ static void _twr_switch_task(void *param)
         {
             bool dynamic = (self->_pull == TWR_SWITCH_PULL_UP_DYNAMIC) || (self->_pull == TWR_SWITCH_PULL_DOWN_DYNAMIC);
 
+            // Floating input of dynamic pull cannot generate edges
+            twr_exti_line_t line;
+            bool edge = !dynamic && twr_exti_get_gpio_line(self->_channel, &line);
+
+            // Armed line is kept as pull may have changed to dynamic since then
+            if (self->_exti_armed)
+            {
+                if (twr_exti_is_registered_to(self->_exti_line, _twr_switch_exti_handler, self))
+                {
+                    twr_exti_unregister(self->_exti_line);
+                }
+
+                self->_exti_armed = false;
+            }
+
             if (dynamic)
             {
                 if (self->_pull_advance_time < 1000)
@@ -148,6 +169,31 @@ static void _twr_switch_task(void *param)
             else
             {
                 self->_tick_debounce = TWR_TICK_INFINITY;
+
+                // Line owned by another driver (e.g. same pin number on other port) is left to it and switch keeps polling
+                if (edge && !twr_exti_is_registered(line))
+                {
+                    twr_exti_register(line, TWR_EXTI_EDGE_RISING_AND_FALLING, _twr_switch_exti_handler, self);
+
+                    self->_exti_armed = true;
+                    self->_exti_line = line;
+
+                    // Edge before the line got armed would be missed, sample once more
+                    pin_state = twr_gpio_get_input(self->_channel);
+
+                    if (self->_type == TWR_SWITCH_TYPE_NC)
+                    {
+                        pin_state = pin_state == 0 ? 1 : 0;
+                    }
+
+                    if (pin_state == self->_pin_state)
+                    {
+                        twr_scheduler_plan_current_relative(self->_scan_interval > _TWR_SWITCH_EXTI_WATCHDOG_INTERVAL ?
+                                self->_scan_interval : _TWR_SWITCH_EXTI_WATCHDOG_INTERVAL);
+
+                        return;
+                    }
+                }
             }
 
             twr_scheduler_plan_current_relative(self->_scan_interval);
@@ -171,3 +217,12 @@ static void _twr_switch_task(void *param)
         }
     }
 }
+
+static void _twr_switch_exti_handler(twr_exti_line_t line, void *param)
+{
+    (void) line;
+
+    twr_switch_t *self = (twr_switch_t *) param;
+
+    twr_scheduler_plan_now(self->_task_id);
+}
@@ -0,0 +1,7 @@
+#ifndef _NODE_CONFIG_H
+#define _NODE_CONFIG_H
+
+// Core Module publishing its own thermometer
+#define NODE_THERMOMETER 1
+
+#endif
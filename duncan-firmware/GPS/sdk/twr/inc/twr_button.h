@@ -2,11 +2,14 @@
 #define _TWR_BUTTON_H
 
 #include <twr_gpio.h>
+#include <twr_exti.h>
 #include <twr_tick.h>
 #include <twr_scheduler.h>
 
 //! @addtogroup twr_button twr_button
 //! @brief Driver for generic button
+//! @details Input is sampled only while button is pressed or bouncing. Idle button waits for edge on its EXTI line, so
+//!          the scan task does not wake the MCU up.
 //! @{
 
 //! @brief Callback events
@@ -41,6 +44,9 @@ typedef struct
     //! @brief Callback for reading input state
     int (*get_input)(twr_button_t *self);
 
+    //! @brief Callback for getting EXTI line signalling change of input (optional, button is polled when NULL or false)
+    bool (*get_exti_line)(twr_button_t *self, twr_exti_line_t *line);
+
 } twr_button_driver_t;
 
 //! @cond
@@ -70,6 +76,9 @@ struct twr_button_t
     int _state;
     bool _hold_signalized;
     twr_scheduler_task_id_t _task_id;
+    bool _exti_armed;
+    twr_exti_line_t _exti_line;
+    twr_button_t *_exti_next;
 };
 
 //! @endcond
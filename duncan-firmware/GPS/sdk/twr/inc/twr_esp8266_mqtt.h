@@ -0,0 +1,155 @@
+#ifndef _TWR_ESP8266_MQTT_H
+#define _TWR_ESP8266_MQTT_H
+
+#include <twr_esp8266.h>
+
+//! @addtogroup twr_esp8266_mqtt twr_esp8266_mqtt
+//! @brief Lightweight MQTT 3.1.1 client (QoS 0 publish) over ESP8266 TCP socket
+//! @details Messages published during one wake are encoded into a buffer and sent by a single AT+CIPSEND after the
+//!          application task returns. Client joins WiFi, opens TCP connection and pipelines CONNECT in front of
+//!          the first batch without waiting for CONNACK. Session is kept open (with PINGREQ every 3/4 of keep alive)
+//!          until no message is published for linger time, so nodes publishing more often than that do not pay for
+//!          WiFi join and TCP handshake on every wake. With linger 0 DISCONNECT is appended to every batch and
+//!          ESP8266 is switched off right after it is sent.
+//!          Client takes over the event handler of ESP8266, WiFi credentials are set by twr_esp8266_set_station_mode.
+//! @{
+
+//! @brief Default keep alive in seconds
+
+#define TWR_ESP8266_MQTT_KEEP_ALIVE_DEFAULT 60
+
+//! @brief Default time session is kept open after last publish in milliseconds
+
+#define TWR_ESP8266_MQTT_LINGER_DEFAULT (5 * 60 * 1000)
+
+//! @brief Size of buffer for CONNECT and PUBLISH packets sent by one AT+CIPSEND
+
+#define TWR_ESP8266_MQTT_BUFFER_SIZE TWR_ESP8266_TX_MAX_PACKET_SIZE
+
+//! @brief Callback events
+
+typedef enum
+{
+    //! @brief Broker accepted connection
+    TWR_ESP8266_MQTT_EVENT_CONNECTED = 0,
+
+    //! @brief Batch of messages has been sent
+    TWR_ESP8266_MQTT_EVENT_PUBLISH_DONE = 1,
+
+    //! @brief Session has been closed and ESP8266 switched off
+    TWR_ESP8266_MQTT_EVENT_DISCONNECTED = 2,
+
+    //! @brief Connection failed or broker refused it, pending messages are retried
+    TWR_ESP8266_MQTT_EVENT_ERROR = 3
+
+} twr_esp8266_mqtt_event_t;
+
+//! @brief MQTT client instance
+
+typedef struct twr_esp8266_mqtt_t twr_esp8266_mqtt_t;
+
+//! @cond
+
+typedef enum
+{
+    TWR_ESP8266_MQTT_STATE_DISCONNECTED = 0,
+    TWR_ESP8266_MQTT_STATE_WIFI_CONNECT = 1,
+    TWR_ESP8266_MQTT_STATE_SOCKET_CONNECT = 2,
+    TWR_ESP8266_MQTT_STATE_CONNECTED = 3,
+    TWR_ESP8266_MQTT_STATE_SEND = 4
+
+} twr_esp8266_mqtt_state_t;
+
+struct twr_esp8266_mqtt_t
+{
+    twr_esp8266_t *_esp;
+    twr_scheduler_task_id_t _task_id;
+    twr_esp8266_mqtt_state_t _state;
+    void (*_event_handler)(twr_esp8266_mqtt_t *, twr_esp8266_mqtt_event_t, void *);
+    void *_event_param;
+    const char *_host;
+    uint16_t _port;
+    const char *_client_id;
+    const char *_username;
+    const char *_password;
+    uint16_t _keep_alive;
+    twr_tick_t _linger;
+    uint8_t _buffer[TWR_ESP8266_MQTT_BUFFER_SIZE];
+    size_t _length;
+    size_t _connect_length;
+    size_t _sent_length;
+    bool _session;
+    bool _ping;
+    bool _close;
+    bool _disconnect;
+    bool _error;
+    twr_tick_t _tick_publish;
+    twr_tick_t _tick_send;
+    twr_tick_t _tick_timeout;
+};
+
+//! @endcond
+
+//! @brief Initialize MQTT client (after twr_esp8266_init)
+//! @param[in] self Instance
+//! @param[in] esp ESP8266 instance, its event handler is replaced by client
+
+void twr_esp8266_mqtt_init(twr_esp8266_mqtt_t *self, twr_esp8266_t *esp);
+
+//! @brief Set callback function
+//! @param[in] self Instance
+//! @param[in] event_handler Function address
+//! @param[in] event_param Optional event parameter (can be NULL)
+
+void twr_esp8266_mqtt_set_event_handler(twr_esp8266_mqtt_t *self, void (*event_handler)(twr_esp8266_mqtt_t *, twr_esp8266_mqtt_event_t, void *), void *event_param);
+
+//! @brief Set broker and credentials, strings must stay valid
+//! @param[in] self Instance
+//! @param[in] host Broker host
+//! @param[in] port Broker port
+//! @param[in] client_id Client identifier
+//! @param[in] username User name (can be NULL)
+//! @param[in] password Password (can be NULL, requires username)
+//! @return true On success
+//! @return false If CONNECT packet would not leave room for messages
+
+bool twr_esp8266_mqtt_set_broker(twr_esp8266_mqtt_t *self, const char *host, uint16_t port, const char *client_id, const char *username, const char *password);
+
+//! @brief Set keep alive
+//! @param[in] self Instance
+//! @param[in] keep_alive Keep alive in seconds
+
+void twr_esp8266_mqtt_set_keep_alive(twr_esp8266_mqtt_t *self, uint16_t keep_alive);
+
+//! @brief Set time session is kept open after last publish
+//! @param[in] self Instance
+//! @param[in] linger Time in milliseconds (0 closes session after every batch, TWR_TICK_INFINITY never closes it)
+
+void twr_esp8266_mqtt_set_linger(twr_esp8266_mqtt_t *self, twr_tick_t linger);
+
+//! @brief Publish message with QoS 0, message is sent with others published before scheduler runs the client
+//! @param[in] self Instance
+//! @param[in] topic Topic
+//! @param[in] payload Pointer to payload
+//! @param[in] length Length of payload
+//! @param[in] retain Retain flag
+//! @return true On success
+//! @return false If message does not fit buffer or broker is not set
+
+bool twr_esp8266_mqtt_publish(twr_esp8266_mqtt_t *self, const char *topic, const void *payload, size_t length, bool retain);
+
+//! @brief Close session after pending messages are sent
+//! @param[in] self Instance
+
+void twr_esp8266_mqtt_disconnect(twr_esp8266_mqtt_t *self);
+
+//! @brief Check if session with broker is open
+//! @param[in] self Instance
+//! @return true If connected
+//! @return false If not connected
+
+bool twr_esp8266_mqtt_is_connected(twr_esp8266_mqtt_t *self);
+
+//! @}
+
+#endif // _TWR_ESP8266_MQTT_H
@@ -2,6 +2,7 @@
 #define _TWR_IRQ_H
 
 #include <twr_common.h>
+#include <twr_scheduler.h>
 
 //! @addtogroup twr_irq twr_irq
 //! @brief Functions for interrupt request manipulation
@@ -15,6 +16,50 @@ void twr_irq_disable(void);
 
 void twr_irq_enable(void);
 
+//! @brief Ring of events passed from interrupt handlers to one scheduler task
+//! @details Event encoding is up to the driver. Interrupt posts events, task is planned only when the ring was empty,
+//!          so a burst of events costs a single wake up. Task has to get events until the ring is empty. Handlers of
+//!          different priorities may post to the same ring, post disables interrupts for the few instructions which
+//!          reserve the slot. Get does not disable interrupts, only one task may get events.
+
+typedef struct
+{
+    //! @cond
+
+    volatile uint32_t *_buffer;
+    uint8_t _mask;
+    volatile uint8_t _head;
+    volatile uint8_t _tail;
+    twr_scheduler_task_id_t _task_id;
+
+    //! @endcond
+
+} twr_irq_ring_t;
+
+//! @brief Initialize ring
+//! @param[in] ring Instance
+//! @param[in] buffer Buffer for events
+//! @param[in] count Number of events in buffer (power of two, up to 128)
+//! @param[in] task_id Task planned when event is posted to empty ring
+
+void twr_irq_ring_init(twr_irq_ring_t *ring, uint32_t *buffer, size_t count, twr_scheduler_task_id_t task_id);
+
+//! @brief Post event from interrupt (may preempt post of other interrupt)
+//! @param[in] ring Instance
+//! @param[in] event Event
+//! @return true On success
+//! @return false If ring is full and event is dropped
+
+bool twr_irq_ring_post(twr_irq_ring_t *ring, uint32_t event);
+
+//! @brief Get event in task
+//! @param[in] ring Instance
+//! @param[out] event Event
+//! @return true On success
+//! @return false If ring is empty
+
+bool twr_irq_ring_get(twr_irq_ring_t *ring, uint32_t *event);
+
 //! @}
 
 #endif // _TWR_IRQ_H
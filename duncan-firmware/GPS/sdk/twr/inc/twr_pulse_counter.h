@@ -8,6 +8,9 @@
 
 //! @addtogroup twr_pulse_counter twr_pulse_counter
 //! @brief Driver for generic pulse counter
+//! @details Pulses are counted in interrupt. Without update interval every pulse raises update event. With update
+//!          interval the interrupt only increments the count and MCU goes back to sleep, update event is raised
+//!          once per interval if the count has changed, so fast meters do not keep the scheduler running.
 //! @{
 
 //! @brief Pulse counter active edges
@@ -52,7 +55,7 @@ void twr_pulse_counter_set_event_handler(twr_module_sensor_channel_t channel, vo
 
 //! @brief Set update interval
 //! @param[in] channel Sensor Module channel pulse counter is connected to
-//! @param[in] interval Update interval
+//! @param[in] interval Update interval (TWR_TICK_INFINITY raises update event on every pulse)
 
 void twr_pulse_counter_set_update_interval(twr_module_sensor_channel_t channel, twr_tick_t interval);
 
@@ -73,6 +76,14 @@ unsigned int twr_pulse_counter_get(twr_module_sensor_channel_t channel);
 
 void twr_pulse_counter_reset(twr_module_sensor_channel_t channel);
 
+//! @brief Get pulse rate over last update interval
+//! @param[in] channel Sensor Module channel pulse counter is connected to
+//! @param[out] rate Pulses per second
+//! @return true On success
+//! @return false If no update interval has passed yet
+
+bool twr_pulse_counter_get_rate(twr_module_sensor_channel_t channel, float *rate);
+
 //! @}
 
 #endif // BCL_INC_TWR_PULSE_COUNTER_H_
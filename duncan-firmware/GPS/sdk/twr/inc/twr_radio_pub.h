@@ -97,6 +97,14 @@ bool twr_radio_pub_push_button(uint16_t *event_count);
 
 bool twr_radio_pub_temperature(uint8_t channel, float *celsius);
 
+//! @brief Publish temperature given as fixed-point value, sent in the same format as twr_radio_pub_temperature
+//! @param[in] channel Channel id from enum TWR_RADIO_PUB_CHANNEL_*
+//! @param[in] celsius Pointer to value, can be null
+//! @return true On success
+//! @return false On failure
+
+bool twr_radio_pub_temperature_fixed(uint8_t channel, twr_fixed_t *celsius);
+
 //! @brief Publish humidity
 //! @param[in] channel Channel id from enum TWR_RADIO_PUB_CHANNEL_*
 //! @param[in] percentage Pointer to value, can be null
@@ -105,6 +113,14 @@ bool twr_radio_pub_temperature(uint8_t channel, float *celsius);
 
 bool twr_radio_pub_humidity(uint8_t channel, float *percentage);
 
+//! @brief Publish humidity given as fixed-point value, sent in the same format as twr_radio_pub_humidity
+//! @param[in] channel Channel id from enum TWR_RADIO_PUB_CHANNEL_*
+//! @param[in] percentage Pointer to value, can be null
+//! @return true On success
+//! @return false On failure
+
+bool twr_radio_pub_humidity_fixed(uint8_t channel, twr_fixed_t *percentage);
+
 //! @brief Publish luminosity
 //! @param[in] channel Channel id from enum TWR_RADIO_PUB_CHANNEL_*
 //! @param[in] lux Pointer to value, can be null
@@ -136,6 +152,13 @@ bool twr_radio_pub_co2(float *concentration);
 
 bool twr_radio_pub_battery(float *voltage);
 
+//! @brief Publish battery given as fixed-point value, sent in the same format as twr_radio_pub_battery
+//! @param[in] voltage Pointer to value, can be null
+//! @return true On success
+//! @return false On failure
+
+bool twr_radio_pub_battery_fixed(twr_fixed_t *voltage);
+
 //! @brief Publish acceleration
 //! @param[in] x_axis Pointer to value, can be null
 //! @param[in] y_axis Pointer to value, can be null
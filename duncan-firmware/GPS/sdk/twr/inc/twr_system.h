@@ -3,6 +3,13 @@
 
 #include <stm32l0xx.h>
 #include <twr_common.h>
+#include <twr_tick.h>
+
+// Time PLL keeps running after the last twr_system_pll_disable, 0 stops it when scheduler goes idle
+
+#ifndef TWR_SYSTEM_PLL_LINGER_TIME
+#define TWR_SYSTEM_PLL_LINGER_TIME 0
+#endif
 
 typedef enum
 {
@@ -52,6 +59,10 @@ void twr_system_pll_enable(void);
 
 void twr_system_pll_disable(void);
 
+void twr_system_pll_set_linger_time(twr_tick_t linger_time);
+
+void twr_system_pll_idle(void);
+
 void twr_system_deep_sleep_disable(void);
 
 void twr_system_deep_sleep_enable(void);
@@ -0,0 +1,118 @@
+#include <twr_bitpack.h>
+#include <math.h>
+
+static bool _twr_bitpack_check(const twr_bitpack_field_t *fields, int count);
+
+size_t twr_bitpack_get_length(const twr_bitpack_field_t *fields, int count)
+{
+    size_t bits = 0;
+
+    for (int i = 0; i < count; i++)
+    {
+        bits += fields[i].bits;
+    }
+
+    return (bits + 7) / 8;
+}
+
+size_t twr_bitpack_encode(const twr_bitpack_field_t *fields, int count, const float *values, uint8_t *buffer, size_t size)
+{
+    size_t length = twr_bitpack_get_length(fields, count);
+
+    if (!_twr_bitpack_check(fields, count) || length > size)
+    {
+        return 0;
+    }
+
+    memset(buffer, 0, length);
+
+    size_t position = 0;
+
+    for (int i = 0; i < count; i++)
+    {
+        uint8_t bits = fields[i].bits;
+        uint32_t none = 0xffffffff >> (32 - bits);
+        uint32_t code = none;
+
+        if (!isnan(values[i]))
+        {
+            float step = roundf((values[i] - fields[i].min) / fields[i].resolution);
+
+            if (step <= 0.f)
+            {
+                code = 0;
+            }
+            else if (step >= (float) (none - 1))
+            {
+                code = none - 1;
+            }
+            else
+            {
+                code = (uint32_t) step;
+            }
+        }
+
+        // Store MSB first, bit by bit is fast enough for a few bytes
+        for (int bit = bits - 1; bit >= 0; bit--, position++)
+        {
+            if ((code >> bit) & 1)
+            {
+                buffer[position / 8] |= 0x80 >> (position % 8);
+            }
+        }
+    }
+
+    return length;
+}
+
+bool twr_bitpack_decode(const twr_bitpack_field_t *fields, int count, const uint8_t *buffer, size_t length, float *values)
+{
+    if (!_twr_bitpack_check(fields, count) || twr_bitpack_get_length(fields, count) > length)
+    {
+        return false;
+    }
+
+    size_t position = 0;
+
+    for (int i = 0; i < count; i++)
+    {
+        uint8_t bits = fields[i].bits;
+        uint32_t none = 0xffffffff >> (32 - bits);
+        uint32_t code = 0;
+
+        for (int bit = 0; bit < bits; bit++, position++)
+        {
+            code = (code << 1) | ((buffer[position / 8] >> (7 - position % 8)) & 1);
+        }
+
+        values[i] = code == none ? NAN : fields[i].min + code * fields[i].resolution;
+    }
+
+    return true;
+}
+
+void twr_bitpack_get_summary(twr_data_stream_t *stream, float *values)
+{
+    if (twr_data_stream_get_type(stream) != TWR_DATA_STREAM_TYPE_FLOAT ||
+        !twr_data_stream_get_min(stream, &values[0]) ||
+        !twr_data_stream_get_average(stream, &values[1]) ||
+        !twr_data_stream_get_max(stream, &values[2]))
+    {
+        values[0] = NAN;
+        values[1] = NAN;
+        values[2] = NAN;
+    }
+}
+
+static bool _twr_bitpack_check(const twr_bitpack_field_t *fields, int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        if (fields[i].bits < 1 || fields[i].bits > 32 || !(fields[i].resolution > 0.f))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,371 @@
+#include <twr_cmwx1zzabz_uplink.h>
+
+#define _TWR_CMWX1ZZABZ_UPLINK_RETRY_INTERVAL 1000
+#define _TWR_CMWX1ZZABZ_UPLINK_DAY (24 * 60 * 60 * 1000ULL)
+
+static void _twr_cmwx1zzabz_uplink_task(void *param);
+static void _twr_cmwx1zzabz_uplink_event_handler(twr_cmwx1zzabz_t *lora, twr_cmwx1zzabz_event_t event, void *event_param);
+static bool _twr_cmwx1zzabz_uplink_send(twr_cmwx1zzabz_uplink_t *self);
+static void _twr_cmwx1zzabz_uplink_charge(twr_cmwx1zzabz_uplink_t *self, size_t length, uint8_t repetitions);
+static bool _twr_cmwx1zzabz_uplink_modulation(twr_cmwx1zzabz_config_band_t band, uint8_t datarate, uint8_t *sf, uint16_t *bw);
+
+void twr_cmwx1zzabz_uplink_init(twr_cmwx1zzabz_uplink_t *self, twr_cmwx1zzabz_t *lora)
+{
+    memset(self, 0, sizeof(*self));
+
+    self->_lora = lora;
+    self->_max_delay = TWR_CMWX1ZZABZ_UPLINK_MAX_DELAY_DEFAULT;
+    self->_link_check_interval = TWR_CMWX1ZZABZ_UPLINK_LINK_CHECK_INTERVAL_DEFAULT;
+
+    self->_task_id = twr_scheduler_register(_twr_cmwx1zzabz_uplink_task, self, TWR_TICK_INFINITY);
+
+    twr_cmwx1zzabz_set_event_handler(lora, _twr_cmwx1zzabz_uplink_event_handler, self);
+}
+
+void twr_cmwx1zzabz_uplink_set_event_handler(twr_cmwx1zzabz_uplink_t *self, void (*event_handler)(twr_cmwx1zzabz_t *, twr_cmwx1zzabz_event_t, void *), void *event_param)
+{
+    self->_event_handler = event_handler;
+    self->_event_param = event_param;
+}
+
+void twr_cmwx1zzabz_uplink_set_max_delay(twr_cmwx1zzabz_uplink_t *self, twr_tick_t max_delay)
+{
+    self->_max_delay = max_delay;
+
+    if (self->_length != 0)
+    {
+        twr_scheduler_plan_now(self->_task_id);
+    }
+}
+
+void twr_cmwx1zzabz_uplink_set_duty_cycle(twr_cmwx1zzabz_uplink_t *self, uint16_t permille)
+{
+    self->_duty_cycle = permille > 1000 ? 1000 : permille;
+}
+
+void twr_cmwx1zzabz_uplink_set_daily_airtime(twr_cmwx1zzabz_uplink_t *self, twr_tick_t airtime)
+{
+    self->_daily_airtime = airtime;
+}
+
+void twr_cmwx1zzabz_uplink_set_link_check_interval(twr_cmwx1zzabz_uplink_t *self, uint16_t interval)
+{
+    self->_link_check_interval = interval;
+    self->_link_check_counter = 0;
+}
+
+size_t twr_cmwx1zzabz_uplink_get_max_length(twr_cmwx1zzabz_uplink_t *self)
+{
+    twr_cmwx1zzabz_config_band_t band = twr_cmwx1zzabz_get_band(self->_lora);
+    uint8_t datarate = twr_cmwx1zzabz_get_datarate(self->_lora);
+    size_t length;
+
+    // Maximum application payload without frame options (LoRaWAN Regional Parameters 1.0.2)
+    if (band == TWR_CMWX1ZZABZ_CONFIG_BAND_US915)
+    {
+        static const uint8_t us915[] = { 11, 53, 125, 242, 242 };
+
+        length = datarate < sizeof(us915) ? us915[datarate] : 11;
+    }
+    else
+    {
+        static const uint8_t eu868[] = { 51, 51, 51, 115, 222, 222, 222, 222 };
+
+        length = datarate < sizeof(eu868) ? eu868[datarate] : 51;
+
+        if (band == TWR_CMWX1ZZABZ_CONFIG_BAND_AU915 && datarate >= 4 && datarate <= 6)
+        {
+            length = 242;
+        }
+    }
+
+    return length > TWR_CMWX1ZZABZ_TX_MAX_PACKET_SIZE ? TWR_CMWX1ZZABZ_TX_MAX_PACKET_SIZE : length;
+}
+
+bool twr_cmwx1zzabz_uplink_add(twr_cmwx1zzabz_uplink_t *self, const void *buffer, size_t length)
+{
+    size_t max_length = twr_cmwx1zzabz_uplink_get_max_length(self);
+
+    if (length == 0 || length > max_length)
+    {
+        return false;
+    }
+
+    if (self->_length + length > max_length)
+    {
+        // Record opens next frame, current one goes out now if duty cycle allows
+        if (!_twr_cmwx1zzabz_uplink_send(self))
+        {
+            self->_flush = true;
+
+            twr_scheduler_plan_now(self->_task_id);
+
+            return false;
+        }
+    }
+
+    if (self->_length == 0)
+    {
+        self->_tick_deadline = twr_tick_get() + self->_max_delay;
+    }
+
+    memcpy(self->_frame + self->_length, buffer, length);
+
+    self->_length += length;
+
+    if (self->_length == max_length)
+    {
+        self->_flush = true;
+    }
+
+    twr_scheduler_plan_now(self->_task_id);
+
+    return true;
+}
+
+bool twr_cmwx1zzabz_uplink_flush(twr_cmwx1zzabz_uplink_t *self)
+{
+    if (self->_length == 0)
+    {
+        return false;
+    }
+
+    self->_flush = true;
+
+    twr_scheduler_plan_now(self->_task_id);
+
+    return true;
+}
+
+twr_tick_t twr_cmwx1zzabz_uplink_get_off_time(twr_cmwx1zzabz_uplink_t *self)
+{
+    twr_tick_t now = twr_tick_get();
+
+    return now < self->_tick_ready ? self->_tick_ready - now : 0;
+}
+
+void twr_cmwx1zzabz_uplink_get_statistics(twr_cmwx1zzabz_uplink_t *self, uint32_t *uplink_count, uint32_t *airtime)
+{
+    if (uplink_count != NULL)
+    {
+        *uplink_count = self->_uplink_count;
+    }
+
+    if (airtime != NULL)
+    {
+        *airtime = self->_airtime / 1000;
+    }
+}
+
+uint32_t twr_cmwx1zzabz_uplink_time_on_air(twr_cmwx1zzabz_config_band_t band, uint8_t datarate, size_t length)
+{
+    uint32_t payload = length + TWR_CMWX1ZZABZ_UPLINK_OVERHEAD;
+    uint8_t sf;
+    uint16_t bw;
+
+    if (!_twr_cmwx1zzabz_uplink_modulation(band, datarate, &sf, &bw))
+    {
+        // FSK 50 kbps: preamble, sync word, length, payload and CRC
+        return (5 + 3 + 1 + payload + 2) * 8 * 20;
+    }
+
+    uint32_t symbol = ((uint32_t) 1 << sf) * 1000 / bw;
+
+    // Low datarate optimization is mandatory for symbols longer than 16 ms
+    int32_t de = symbol > 16000 ? 1 : 0;
+
+    // Explicit header, CRC on, coding rate 4/5
+    int32_t numerator = 8 * (int32_t) payload - 4 * sf + 28 + 16;
+    int32_t denominator = 4 * (sf - 2 * de);
+    uint32_t symbols = 8;
+
+    if (numerator > 0)
+    {
+        symbols += ((numerator + denominator - 1) / denominator) * 5;
+    }
+
+    // Preamble of 8 symbols plus 4.25 symbols of sync
+    return (49 * symbol) / 4 + symbols * symbol;
+}
+
+static void _twr_cmwx1zzabz_uplink_task(void *param)
+{
+    twr_cmwx1zzabz_uplink_t *self = (twr_cmwx1zzabz_uplink_t *) param;
+
+    if (self->_length == 0 && !self->_link_check)
+    {
+        return;
+    }
+
+    twr_tick_t now = twr_tick_get();
+
+    if (now < self->_tick_ready)
+    {
+        twr_scheduler_plan_current_absolute(self->_tick_ready);
+
+        return;
+    }
+
+    if (!twr_cmwx1zzabz_is_ready(self->_lora))
+    {
+        twr_scheduler_plan_current_from_now(_TWR_CMWX1ZZABZ_UPLINK_RETRY_INTERVAL);
+
+        return;
+    }
+
+    if (self->_link_check)
+    {
+        if (!twr_cmwx1zzabz_link_check(self->_lora))
+        {
+            twr_scheduler_plan_current_from_now(_TWR_CMWX1ZZABZ_UPLINK_RETRY_INTERVAL);
+
+            return;
+        }
+
+        self->_link_check = false;
+
+        _twr_cmwx1zzabz_uplink_charge(self, 0, 1);
+
+        return;
+    }
+
+    if (!self->_flush && now < self->_tick_deadline)
+    {
+        twr_scheduler_plan_current_absolute(self->_tick_deadline);
+
+        return;
+    }
+
+    if (!_twr_cmwx1zzabz_uplink_send(self))
+    {
+        twr_scheduler_plan_current_from_now(_TWR_CMWX1ZZABZ_UPLINK_RETRY_INTERVAL);
+    }
+}
+
+static void _twr_cmwx1zzabz_uplink_event_handler(twr_cmwx1zzabz_t *lora, twr_cmwx1zzabz_event_t event, void *event_param)
+{
+    twr_cmwx1zzabz_uplink_t *self = (twr_cmwx1zzabz_uplink_t *) event_param;
+
+    // Modem may have become ready for pending frame or link check
+    twr_scheduler_plan_now(self->_task_id);
+
+    if (self->_event_handler != NULL)
+    {
+        self->_event_handler(lora, event, self->_event_param);
+    }
+}
+
+static bool _twr_cmwx1zzabz_uplink_send(twr_cmwx1zzabz_uplink_t *self)
+{
+    if (self->_length == 0 || self->_link_check || twr_tick_get() < self->_tick_ready)
+    {
+        return false;
+    }
+
+    if (!twr_cmwx1zzabz_send_message(self->_lora, self->_frame, self->_length))
+    {
+        return false;
+    }
+
+    uint8_t repetitions = twr_cmwx1zzabz_get_repeat_unconfirmed(self->_lora);
+
+    _twr_cmwx1zzabz_uplink_charge(self, self->_length, repetitions == 0 ? 1 : repetitions);
+
+    self->_length = 0;
+    self->_flush = false;
+
+    if (self->_link_check_interval != 0 && ++self->_link_check_counter >= self->_link_check_interval)
+    {
+        self->_link_check_counter = 0;
+        self->_link_check = true;
+    }
+
+    return true;
+}
+
+static void _twr_cmwx1zzabz_uplink_charge(twr_cmwx1zzabz_uplink_t *self, size_t length, uint8_t repetitions)
+{
+    twr_cmwx1zzabz_config_band_t band = twr_cmwx1zzabz_get_band(self->_lora);
+
+    uint64_t airtime = (uint64_t) twr_cmwx1zzabz_uplink_time_on_air(band, twr_cmwx1zzabz_get_datarate(self->_lora), length) * repetitions;
+
+    uint16_t duty_cycle = self->_duty_cycle;
+
+    if (duty_cycle == 0)
+    {
+        duty_cycle = band == TWR_CMWX1ZZABZ_CONFIG_BAND_EU868 ? 10 : 1000;
+    }
+
+    // Transmission and off-time together take airtime / duty cycle, microseconds per permille give milliseconds
+    twr_tick_t period = airtime / duty_cycle;
+
+    if (self->_daily_airtime != 0)
+    {
+        twr_tick_t daily = airtime * (_TWR_CMWX1ZZABZ_UPLINK_DAY / 1000) / self->_daily_airtime;
+
+        if (daily > period)
+        {
+            period = daily;
+        }
+    }
+
+    self->_tick_ready = twr_tick_get() + period;
+
+    self->_uplink_count++;
+    self->_airtime += airtime;
+}
+
+static bool _twr_cmwx1zzabz_uplink_modulation(twr_cmwx1zzabz_config_band_t band, uint8_t datarate, uint8_t *sf, uint16_t *bw)
+{
+    *sf = 12;
+    *bw = 125;
+
+    if (band == TWR_CMWX1ZZABZ_CONFIG_BAND_US915)
+    {
+        if (datarate <= 3)
+        {
+            *sf = 10 - datarate;
+        }
+        else if (datarate == 4)
+        {
+            *sf = 8;
+            *bw = 500;
+        }
+        else if (datarate >= 8 && datarate <= 13)
+        {
+            *sf = 12 - (datarate - 8);
+            *bw = 500;
+        }
+
+        return true;
+    }
+
+    if (datarate <= 5)
+    {
+        *sf = 12 - datarate;
+    }
+    else if (datarate == 6)
+    {
+        if (band == TWR_CMWX1ZZABZ_CONFIG_BAND_AU915)
+        {
+            *sf = 8;
+            *bw = 500;
+        }
+        else
+        {
+            *sf = 7;
+            *bw = 250;
+        }
+    }
+    else if (datarate == 7)
+    {
+        return band == TWR_CMWX1ZZABZ_CONFIG_BAND_AU915;
+    }
+    else if (band == TWR_CMWX1ZZABZ_CONFIG_BAND_AU915 && datarate >= 8 && datarate <= 13)
+    {
+        *sf = 12 - (datarate - 8);
+        *bw = 500;
+    }
+
+    return true;
+}
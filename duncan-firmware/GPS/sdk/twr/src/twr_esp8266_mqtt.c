@@ -0,0 +1,492 @@
+#include <twr_esp8266_mqtt.h>
+
+#define _TWR_ESP8266_MQTT_TIMEOUT (30 * 1000)
+#define _TWR_ESP8266_MQTT_RETRY_INTERVAL (60 * 1000)
+#define _TWR_ESP8266_MQTT_BUSY_INTERVAL 100
+
+#define _TWR_ESP8266_MQTT_CONNECT 0x10
+#define _TWR_ESP8266_MQTT_CONNACK 0x20
+#define _TWR_ESP8266_MQTT_PUBLISH 0x30
+#define _TWR_ESP8266_MQTT_PINGREQ 0xc0
+#define _TWR_ESP8266_MQTT_PINGRESP 0xd0
+#define _TWR_ESP8266_MQTT_DISCONNECT 0xe0
+
+static void _twr_esp8266_mqtt_task(void *param);
+static void _twr_esp8266_mqtt_esp_event_handler(twr_esp8266_t *esp, twr_esp8266_event_t event, void *event_param);
+static void _twr_esp8266_mqtt_send(twr_esp8266_mqtt_t *self, bool ping, bool disconnect);
+static void _twr_esp8266_mqtt_close(twr_esp8266_mqtt_t *self, bool error);
+static void _twr_esp8266_mqtt_decode(twr_esp8266_mqtt_t *self);
+static size_t _twr_esp8266_mqtt_encode_connect(twr_esp8266_mqtt_t *self, uint8_t *buffer);
+static size_t _twr_esp8266_mqtt_put_length(uint8_t *buffer, size_t length);
+static size_t _twr_esp8266_mqtt_put_string(uint8_t *buffer, const char *string);
+
+void twr_esp8266_mqtt_init(twr_esp8266_mqtt_t *self, twr_esp8266_t *esp)
+{
+    memset(self, 0, sizeof(*self));
+
+    self->_esp = esp;
+    self->_keep_alive = TWR_ESP8266_MQTT_KEEP_ALIVE_DEFAULT;
+    self->_linger = TWR_ESP8266_MQTT_LINGER_DEFAULT;
+
+    self->_task_id = twr_scheduler_register(_twr_esp8266_mqtt_task, self, TWR_TICK_INFINITY);
+
+    twr_esp8266_set_event_handler(esp, _twr_esp8266_mqtt_esp_event_handler, self);
+}
+
+void twr_esp8266_mqtt_set_event_handler(twr_esp8266_mqtt_t *self, void (*event_handler)(twr_esp8266_mqtt_t *, twr_esp8266_mqtt_event_t, void *), void *event_param)
+{
+    self->_event_handler = event_handler;
+    self->_event_param = event_param;
+}
+
+bool twr_esp8266_mqtt_set_broker(twr_esp8266_mqtt_t *self, const char *host, uint16_t port, const char *client_id, const char *username, const char *password)
+{
+    if (host == NULL || port == 0 || client_id == NULL || (password != NULL && username == NULL))
+    {
+        return false;
+    }
+
+    self->_host = host;
+    self->_port = port;
+    self->_client_id = client_id;
+    self->_username = username;
+    self->_password = password;
+
+    self->_connect_length = _twr_esp8266_mqtt_encode_connect(self, NULL);
+
+    // Leave room for at least one short message, PINGREQ and DISCONNECT
+    if (self->_connect_length + 64 > sizeof(self->_buffer))
+    {
+        self->_host = NULL;
+
+        return false;
+    }
+
+    return true;
+}
+
+void twr_esp8266_mqtt_set_keep_alive(twr_esp8266_mqtt_t *self, uint16_t keep_alive)
+{
+    self->_keep_alive = keep_alive;
+}
+
+void twr_esp8266_mqtt_set_linger(twr_esp8266_mqtt_t *self, twr_tick_t linger)
+{
+    self->_linger = linger;
+
+    twr_scheduler_plan_now(self->_task_id);
+}
+
+bool twr_esp8266_mqtt_publish(twr_esp8266_mqtt_t *self, const char *topic, const void *payload, size_t length, bool retain)
+{
+    if (self->_host == NULL)
+    {
+        return false;
+    }
+
+    size_t topic_length = strlen(topic);
+    size_t remaining_length = 2 + topic_length + length;
+    size_t packet_length = 1 + _twr_esp8266_mqtt_put_length(NULL, remaining_length) + remaining_length;
+
+    // CONNECT may be put in front and PINGREQ or DISCONNECT behind
+    if (topic_length == 0 || self->_length + packet_length + self->_connect_length + 2 > sizeof(self->_buffer))
+    {
+        return false;
+    }
+
+    uint8_t *buffer = self->_buffer + self->_length;
+
+    *buffer++ = _TWR_ESP8266_MQTT_PUBLISH | (retain ? 0x01 : 0x00);
+
+    buffer += _twr_esp8266_mqtt_put_length(buffer, remaining_length);
+    buffer += _twr_esp8266_mqtt_put_string(buffer, topic);
+
+    memcpy(buffer, payload, length);
+
+    self->_length += packet_length;
+
+    self->_tick_publish = twr_tick_get();
+
+    twr_scheduler_plan_now(self->_task_id);
+
+    return true;
+}
+
+void twr_esp8266_mqtt_disconnect(twr_esp8266_mqtt_t *self)
+{
+    self->_close = true;
+
+    twr_scheduler_plan_now(self->_task_id);
+}
+
+bool twr_esp8266_mqtt_is_connected(twr_esp8266_mqtt_t *self)
+{
+    return self->_session && (self->_state == TWR_ESP8266_MQTT_STATE_CONNECTED || self->_state == TWR_ESP8266_MQTT_STATE_SEND);
+}
+
+static void _twr_esp8266_mqtt_task(void *param)
+{
+    twr_esp8266_mqtt_t *self = (twr_esp8266_mqtt_t *) param;
+
+    twr_tick_t now = twr_tick_get();
+
+    if (self->_error)
+    {
+        _twr_esp8266_mqtt_close(self, true);
+
+        return;
+    }
+
+    switch (self->_state)
+    {
+        case TWR_ESP8266_MQTT_STATE_DISCONNECTED:
+        {
+            self->_close = false;
+
+            if (self->_length == 0)
+            {
+                return;
+            }
+
+            if (!twr_esp8266_connect(self->_esp))
+            {
+                twr_scheduler_plan_current_from_now(_TWR_ESP8266_MQTT_RETRY_INTERVAL);
+
+                return;
+            }
+
+            self->_state = TWR_ESP8266_MQTT_STATE_WIFI_CONNECT;
+            self->_tick_timeout = now + _TWR_ESP8266_MQTT_TIMEOUT;
+
+            twr_scheduler_plan_current_absolute(self->_tick_timeout);
+
+            return;
+        }
+        case TWR_ESP8266_MQTT_STATE_WIFI_CONNECT:
+        case TWR_ESP8266_MQTT_STATE_SOCKET_CONNECT:
+        case TWR_ESP8266_MQTT_STATE_SEND:
+        {
+            if (now >= self->_tick_timeout)
+            {
+                _twr_esp8266_mqtt_close(self, true);
+
+                return;
+            }
+
+            twr_scheduler_plan_current_absolute(self->_tick_timeout);
+
+            return;
+        }
+        case TWR_ESP8266_MQTT_STATE_CONNECTED:
+        {
+            if (self->_disconnect)
+            {
+                _twr_esp8266_mqtt_close(self, false);
+
+                return;
+            }
+
+            if (self->_ping && now >= self->_tick_send + _TWR_ESP8266_MQTT_TIMEOUT)
+            {
+                // Broker has not answered PINGREQ, connection is gone
+                _twr_esp8266_mqtt_close(self, true);
+
+                return;
+            }
+
+            twr_tick_t tick_ping = self->_keep_alive != 0 ? self->_tick_send + self->_keep_alive * 750 : TWR_TICK_INFINITY;
+            twr_tick_t tick_linger = self->_linger != TWR_TICK_INFINITY ? self->_tick_publish + self->_linger : TWR_TICK_INFINITY;
+
+            bool disconnect = self->_close || self->_linger == 0 || (self->_length == 0 && now >= tick_linger);
+            bool ping = self->_session && self->_length == 0 && !self->_ping && now >= tick_ping;
+
+            if (self->_length == 0 && !disconnect && !ping)
+            {
+                twr_tick_t tick_next = tick_ping < tick_linger ? tick_ping : tick_linger;
+
+                if (self->_ping && self->_tick_send + _TWR_ESP8266_MQTT_TIMEOUT < tick_next)
+                {
+                    tick_next = self->_tick_send + _TWR_ESP8266_MQTT_TIMEOUT;
+                }
+
+                twr_scheduler_plan_current_absolute(tick_next);
+
+                return;
+            }
+
+            if (disconnect && self->_length == 0 && !self->_session)
+            {
+                _twr_esp8266_mqtt_close(self, false);
+
+                return;
+            }
+
+            if (!twr_esp8266_is_ready(self->_esp))
+            {
+                twr_scheduler_plan_current_from_now(_TWR_ESP8266_MQTT_BUSY_INTERVAL);
+
+                return;
+            }
+
+            _twr_esp8266_mqtt_send(self, ping, disconnect);
+
+            return;
+        }
+        default:
+        {
+            return;
+        }
+    }
+}
+
+static void _twr_esp8266_mqtt_esp_event_handler(twr_esp8266_t *esp, twr_esp8266_event_t event, void *event_param)
+{
+    twr_esp8266_mqtt_t *self = (twr_esp8266_mqtt_t *) event_param;
+
+    if (event == TWR_ESP8266_EVENT_WIFI_CONNECT_SUCCESS && self->_state == TWR_ESP8266_MQTT_STATE_WIFI_CONNECT)
+    {
+        if (!twr_esp8266_tcp_connect(esp, self->_host, self->_port))
+        {
+            self->_error = true;
+
+            twr_scheduler_plan_now(self->_task_id);
+
+            return;
+        }
+
+        self->_state = TWR_ESP8266_MQTT_STATE_SOCKET_CONNECT;
+        self->_tick_timeout = twr_tick_get() + _TWR_ESP8266_MQTT_TIMEOUT;
+
+        twr_scheduler_plan_absolute(self->_task_id, self->_tick_timeout);
+    }
+    else if (event == TWR_ESP8266_EVENT_SOCKET_CONNECT_SUCCESS && self->_state == TWR_ESP8266_MQTT_STATE_SOCKET_CONNECT)
+    {
+        self->_state = TWR_ESP8266_MQTT_STATE_CONNECTED;
+        self->_session = false;
+        self->_ping = false;
+
+        twr_scheduler_plan_now(self->_task_id);
+    }
+    else if (event == TWR_ESP8266_EVENT_SOCKET_SEND_SUCCESS && self->_state == TWR_ESP8266_MQTT_STATE_SEND)
+    {
+        // Drop sent messages, keep those published meanwhile
+        self->_length -= self->_sent_length;
+
+        memmove(self->_buffer, self->_buffer + self->_sent_length, self->_length);
+
+        self->_state = TWR_ESP8266_MQTT_STATE_CONNECTED;
+        self->_session = true;
+
+        twr_scheduler_plan_now(self->_task_id);
+
+        if (self->_sent_length != 0 && self->_event_handler != NULL)
+        {
+            self->_event_handler(self, TWR_ESP8266_MQTT_EVENT_PUBLISH_DONE, self->_event_param);
+        }
+    }
+    else if (event == TWR_ESP8266_EVENT_DATA_RECEIVED)
+    {
+        _twr_esp8266_mqtt_decode(self);
+    }
+    else if (event == TWR_ESP8266_EVENT_ERROR || event == TWR_ESP8266_EVENT_WIFI_CONNECT_ERROR ||
+             event == TWR_ESP8266_EVENT_SOCKET_CONNECT_ERROR || event == TWR_ESP8266_EVENT_SOCKET_SEND_ERROR)
+    {
+        // Driver is still in its state machine, it is switched off from client task
+        if (self->_state != TWR_ESP8266_MQTT_STATE_DISCONNECTED)
+        {
+            self->_error = true;
+
+            twr_scheduler_plan_now(self->_task_id);
+        }
+    }
+}
+
+static void _twr_esp8266_mqtt_send(twr_esp8266_mqtt_t *self, bool ping, bool disconnect)
+{
+    size_t offset = 0;
+
+    if (!self->_session)
+    {
+        // Clients may send further packets right after CONNECT without waiting for CONNACK
+        memmove(self->_buffer + self->_connect_length, self->_buffer, self->_length);
+
+        offset = _twr_esp8266_mqtt_encode_connect(self, self->_buffer);
+    }
+
+    size_t length = offset + self->_length;
+
+    if (ping)
+    {
+        self->_buffer[length++] = _TWR_ESP8266_MQTT_PINGREQ;
+        self->_buffer[length++] = 0;
+    }
+
+    if (disconnect)
+    {
+        self->_buffer[length++] = _TWR_ESP8266_MQTT_DISCONNECT;
+        self->_buffer[length++] = 0;
+    }
+
+    // Driver copies the data, buffer is restored right away
+    bool result = twr_esp8266_send_data(self->_esp, self->_buffer, length);
+
+    if (offset != 0)
+    {
+        memmove(self->_buffer, self->_buffer + offset, self->_length);
+    }
+
+    if (!result)
+    {
+        twr_scheduler_plan_current_from_now(_TWR_ESP8266_MQTT_BUSY_INTERVAL);
+
+        return;
+    }
+
+    self->_state = TWR_ESP8266_MQTT_STATE_SEND;
+    self->_sent_length = self->_length;
+    self->_disconnect = disconnect;
+    self->_ping |= ping;
+    self->_tick_send = twr_tick_get();
+    self->_tick_timeout = self->_tick_send + _TWR_ESP8266_MQTT_TIMEOUT;
+
+    twr_scheduler_plan_current_absolute(self->_tick_timeout);
+}
+
+static void _twr_esp8266_mqtt_close(twr_esp8266_mqtt_t *self, bool error)
+{
+    twr_esp8266_disconnect(self->_esp);
+
+    self->_state = TWR_ESP8266_MQTT_STATE_DISCONNECTED;
+    self->_session = false;
+    self->_ping = false;
+    self->_close = false;
+    self->_disconnect = false;
+    self->_error = false;
+
+    if (self->_length != 0)
+    {
+        // Messages published after DISCONNECT go out right away, after failure they wait
+        twr_scheduler_plan_relative(self->_task_id, error ? _TWR_ESP8266_MQTT_RETRY_INTERVAL : 0);
+    }
+
+    if (self->_event_handler != NULL)
+    {
+        self->_event_handler(self, error ? TWR_ESP8266_MQTT_EVENT_ERROR : TWR_ESP8266_MQTT_EVENT_DISCONNECTED, self->_event_param);
+    }
+}
+
+static void _twr_esp8266_mqtt_decode(twr_esp8266_mqtt_t *self)
+{
+    uint8_t buffer[16];
+
+    // Only short packets are expected, client does not subscribe
+    size_t length = twr_esp8266_get_received_message_data(self->_esp, buffer, sizeof(buffer));
+
+    for (size_t i = 0; i + 1 < length; i += 2 + buffer[i + 1])
+    {
+        if (buffer[i] == _TWR_ESP8266_MQTT_CONNACK && buffer[i + 1] == 2 && i + 3 < length)
+        {
+            if (buffer[i + 3] != 0)
+            {
+                // Broker refused connection (protocol, identifier or credentials)
+                self->_error = true;
+
+                twr_scheduler_plan_now(self->_task_id);
+
+                return;
+            }
+
+            if (self->_event_handler != NULL)
+            {
+                self->_event_handler(self, TWR_ESP8266_MQTT_EVENT_CONNECTED, self->_event_param);
+            }
+        }
+        else if (buffer[i] == _TWR_ESP8266_MQTT_PINGRESP)
+        {
+            self->_ping = false;
+        }
+    }
+}
+
+static size_t _twr_esp8266_mqtt_encode_connect(twr_esp8266_mqtt_t *self, uint8_t *buffer)
+{
+    uint8_t flags = 0x02; // Clean session
+    size_t remaining_length = 10 + 2 + strlen(self->_client_id);
+
+    if (self->_username != NULL)
+    {
+        flags |= 0x80;
+        remaining_length += 2 + strlen(self->_username);
+    }
+
+    if (self->_password != NULL)
+    {
+        flags |= 0x40;
+        remaining_length += 2 + strlen(self->_password);
+    }
+
+    size_t length = 1 + _twr_esp8266_mqtt_put_length(NULL, remaining_length) + remaining_length;
+
+    if (buffer == NULL)
+    {
+        return length;
+    }
+
+    *buffer++ = _TWR_ESP8266_MQTT_CONNECT;
+
+    buffer += _twr_esp8266_mqtt_put_length(buffer, remaining_length);
+    buffer += _twr_esp8266_mqtt_put_string(buffer, "MQTT");
+
+    *buffer++ = 0x04; // Protocol level 3.1.1
+    *buffer++ = flags;
+    *buffer++ = self->_keep_alive >> 8;
+    *buffer++ = self->_keep_alive;
+
+    buffer += _twr_esp8266_mqtt_put_string(buffer, self->_client_id);
+
+    if (self->_username != NULL)
+    {
+        buffer += _twr_esp8266_mqtt_put_string(buffer, self->_username);
+    }
+
+    if (self->_password != NULL)
+    {
+        _twr_esp8266_mqtt_put_string(buffer, self->_password);
+    }
+
+    return length;
+}
+
+static size_t _twr_esp8266_mqtt_put_length(uint8_t *buffer, size_t length)
+{
+    size_t i = 0;
+
+    do
+    {
+        uint8_t byte = length & 0x7f;
+
+        length >>= 7;
+
+        if (buffer != NULL)
+        {
+            buffer[i] = length != 0 ? byte | 0x80 : byte;
+        }
+
+        i++;
+    }
+    while (length != 0);
+
+    return i;
+}
+
+static size_t _twr_esp8266_mqtt_put_string(uint8_t *buffer, const char *string)
+{
+    size_t length = strlen(string);
+
+    buffer[0] = length >> 8;
+    buffer[1] = length;
+
+    memcpy(buffer + 2, string, length);
+
+    return 2 + length;
+}
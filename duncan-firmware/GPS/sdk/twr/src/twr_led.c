@@ -50,7 +50,9 @@ static void _twr_led_task(void *param)
         self->_selector = 0x80000000;
     }
 
-    if ((self->_pattern & self->_selector) != 0)
+    bool on = (self->_pattern & self->_selector) != 0;
+
+    if (on)
     {
         self->_driver->on(self);
     }
@@ -59,17 +61,33 @@ static void _twr_led_task(void *param)
         self->_driver->off(self);
     }
 
-    self->_selector >>= 1;
+    // Consecutive slots of the same state are covered by a single wake
+    twr_tick_t slots = 0;
 
-    if (self->_count != 0)
+    do
     {
-        if (--self->_count == 0)
+        self->_selector >>= 1;
+
+        if (self->_selector == 0)
+        {
+            self->_selector = 0x80000000;
+        }
+
+        slots++;
+
+        if (self->_count != 0)
         {
-            self->_pattern = 0;
+            if (--self->_count == 0)
+            {
+                self->_pattern = 0;
+
+                break;
+            }
         }
     }
+    while (((self->_pattern & self->_selector) != 0) == on);
 
-    twr_scheduler_plan_current_relative(self->_slot_interval);
+    twr_scheduler_plan_current_relative(slots * self->_slot_interval);
 }
 
 void twr_led_init(twr_led_t *self, twr_gpio_channel_t gpio_channel, bool open_drain_output, int idle_state)
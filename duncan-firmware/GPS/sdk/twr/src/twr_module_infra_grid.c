@@ -105,6 +105,17 @@ float twr_module_infra_grid_read_thermistor(twr_module_infra_grid_t *self)
     return (temperature[0] | temperature[1] << 8) * 0.0625f;
 }
 
+twr_fixed_t twr_module_infra_grid_read_thermistor_fixed(twr_module_infra_grid_t *self)
+{
+    int8_t temperature[2];
+
+    twr_i2c_memory_read_8b(self->_i2c_channel, self->_i2c_address, _TWR_AMG88xx_TTHL, (uint8_t *) &temperature[0]);
+    twr_i2c_memory_read_8b(self->_i2c_channel, self->_i2c_address, _TWR_AMG88xx_TTHH, (uint8_t *) &temperature[1]);
+
+    // Thermistor resolution is 0.0625 degrees of Celsius
+    return twr_fixed_from_scaled(temperature[0] | temperature[1] << 8, 4);
+}
+
 bool twr_module_infra_grid_read_values(twr_module_infra_grid_t *self)
 {
     twr_i2c_memory_transfer_t transfer;
@@ -117,7 +128,7 @@ bool twr_module_infra_grid_read_values(twr_module_infra_grid_t *self)
     return twr_i2c_memory_read(self->_i2c_channel, &transfer);
 }
 
-bool twr_module_infra_grid_get_temperatures_celsius(twr_module_infra_grid_t *self, float *values)
+bool twr_module_infra_grid_get_temperatures_raw(twr_module_infra_grid_t *self, int16_t *values)
 {
     if (!self->_temperature_valid)
     {
@@ -126,19 +137,51 @@ bool twr_module_infra_grid_get_temperatures_celsius(twr_module_infra_grid_t *sel
 
     for (int i = 0; i < 64 ;i++)
     {
-        float temperature;
         int16_t temporary_data = self->_sensor_data[i];
 
+        // Pixel is 12-bit two's complement value in quarters of degree
         if (temporary_data > 0x200)
         {
-            temperature = (-temporary_data + 0xfff) * -0.25f;
+            values[i] = temporary_data - 0xfff;
         }
         else
         {
-            temperature = temporary_data * 0.25f;
+            values[i] = temporary_data;
         }
+    }
 
-        values[i] = temperature;
+    return true;
+}
+
+bool twr_module_infra_grid_get_temperatures_fixed(twr_module_infra_grid_t *self, twr_fixed_t *values)
+{
+    int16_t raw[64];
+
+    if (!twr_module_infra_grid_get_temperatures_raw(self, raw))
+    {
+        return false;
+    }
+
+    for (int i = 0; i < 64 ;i++)
+    {
+        values[i] = twr_fixed_from_scaled(raw[i], 2);
+    }
+
+    return true;
+}
+
+bool twr_module_infra_grid_get_temperatures_celsius(twr_module_infra_grid_t *self, float *values)
+{
+    int16_t raw[64];
+
+    if (!twr_module_infra_grid_get_temperatures_raw(self, raw))
+    {
+        return false;
+    }
+
+    for (int i = 0; i < 64 ;i++)
+    {
+        values[i] = raw[i] * 0.25f;
     }
 
     return true;
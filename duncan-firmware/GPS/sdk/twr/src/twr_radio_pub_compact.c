@@ -0,0 +1,651 @@
+#include <twr_radio_pub_compact.h>
+#include <twr_radio_pub.h>
+#include <twr_scheduler.h>
+#include <math.h>
+
+#if TWR_RADIO_PUB_COMPACT_MAX_TOPICS > 64
+#error "TWR_RADIO_PUB_COMPACT_MAX_TOPICS has to fit into 6 bits of entry header"
+#endif
+
+// Entry header is topic ID and flags, followed by zig-zag varint unless value is null
+#define _TWR_RADIO_PUB_COMPACT_ENTRY_ABSOLUTE 0x80
+#define _TWR_RADIO_PUB_COMPACT_ENTRY_NULL 0x40
+#define _TWR_RADIO_PUB_COMPACT_ENTRY_TOPIC 0x3f
+#define _TWR_RADIO_PUB_COMPACT_ENTRY_MAX_SIZE 6
+
+// Reference older than this many acknowledged frames is not used, generation compare has to stay unambiguous
+#define _TWR_RADIO_PUB_COMPACT_REF_MAX_AGE 64
+
+// Pending frame is offered to full publish queue again after this time
+#define _TWR_RADIO_PUB_COMPACT_RETRY_INTERVAL 100
+
+typedef struct
+{
+    int32_t ref;
+    int32_t flight;
+    uint8_t ref_gen;
+    bool ref_valid;
+    bool in_flight;
+    bool key;
+    bool registered;
+    bool reg_pending;
+    uint8_t count;
+
+} _twr_radio_pub_compact_node_t;
+
+#if TWR_RADIO_PUB_COMPACT_GATEWAY_TOPICS > 0
+
+typedef struct
+{
+    uint64_t id;
+    uint8_t topic;
+    float resolution;
+    uint8_t valid;
+    uint8_t gen[2];
+    int32_t value[2];
+    char subtopic[TWR_RADIO_PUB_COMPACT_SUBTOPIC_SIZE];
+
+} _twr_radio_pub_compact_gateway_t;
+
+#endif
+
+static struct
+{
+    const twr_radio_pub_compact_topic_t *topics;
+    int count;
+    _twr_radio_pub_compact_node_t node[TWR_RADIO_PUB_COMPACT_MAX_TOPICS];
+    uint8_t gen;
+
+    uint8_t pending[TWR_RADIO_MAX_BUFFER_SIZE - 1];
+    size_t pending_length;
+    uint64_t pending_topics;
+    twr_scheduler_task_id_t task_id;
+
+#if TWR_RADIO_PUB_COMPACT_GATEWAY_TOPICS > 0
+    _twr_radio_pub_compact_gateway_t gateway[TWR_RADIO_PUB_COMPACT_GATEWAY_TOPICS];
+    int gateway_next;
+#endif
+
+} _twr_radio_pub_compact;
+
+// Defined weak in twr_radio_pub.c, gateway application overrides it
+void twr_radio_pub_on_float(uint64_t *id, char *subtopic, float *value);
+
+static size_t _twr_radio_pub_compact_encode(uint8_t *buffer, size_t length);
+static void _twr_radio_pub_compact_ack(const uint8_t *buffer, size_t length);
+static size_t _twr_radio_pub_compact_tx_error(uint8_t *buffer, size_t length);
+static void _twr_radio_pub_compact_task(void *param);
+static bool _twr_radio_pub_compact_register(int topic);
+static size_t _twr_radio_pub_compact_varint_to_buffer(int32_t value, uint8_t *buffer);
+static size_t _twr_radio_pub_compact_varint_from_buffer(const uint8_t *buffer, size_t length, int32_t *value);
+static size_t _twr_radio_pub_compact_varint_size(int32_t value);
+
+static const _twr_radio_pub_compact_hook_t _twr_radio_pub_compact_hook =
+{
+    .encode = _twr_radio_pub_compact_encode,
+    .ack = _twr_radio_pub_compact_ack,
+    .tx_error = _twr_radio_pub_compact_tx_error
+};
+
+#if TWR_RADIO_PUB_COMPACT_GATEWAY_TOPICS > 0
+static _twr_radio_pub_compact_gateway_t *_twr_radio_pub_compact_gateway_find(uint64_t *id, uint8_t topic);
+static bool _twr_radio_pub_compact_gateway_get(_twr_radio_pub_compact_gateway_t *entry, uint8_t gen, int32_t *value);
+static void _twr_radio_pub_compact_gateway_set(_twr_radio_pub_compact_gateway_t *entry, uint8_t gen, int32_t value, bool reset);
+#endif
+
+void twr_radio_pub_compact_init(const twr_radio_pub_compact_topic_t *topics, int count)
+{
+    memset(_twr_radio_pub_compact.node, 0, sizeof(_twr_radio_pub_compact.node));
+
+    _twr_radio_pub_compact.topics = topics;
+    _twr_radio_pub_compact.count = count > TWR_RADIO_PUB_COMPACT_MAX_TOPICS ? TWR_RADIO_PUB_COMPACT_MAX_TOPICS : count;
+    _twr_radio_pub_compact.pending_length = 0;
+    _twr_radio_pub_compact.pending_topics = 0;
+
+    _twr_radio_pub_compact.task_id = twr_scheduler_register(_twr_radio_pub_compact_task, NULL, TWR_TICK_INFINITY);
+
+    // Radio reaches compact telemetry only through this hook, firmware without it does not link it
+    _twr_radio_set_pub_compact_hook(&_twr_radio_pub_compact_hook);
+}
+
+bool twr_radio_pub_compact(int topic, float *value)
+{
+    if ((topic < 0) || (topic >= _twr_radio_pub_compact.count))
+    {
+        return false;
+    }
+
+    bool null = (value == NULL) || isnan(*value);
+    int32_t quantized = 0;
+
+    if (!null)
+    {
+        float scaled = *value / _twr_radio_pub_compact.topics[topic].resolution;
+
+        // Difference of two values has to fit int32 as well
+        if (!(fabsf(scaled) < (float) (INT32_MAX / 2)))
+        {
+            return false;
+        }
+
+        quantized = (int32_t) lroundf(scaled);
+    }
+
+    if (((_twr_radio_pub_compact.pending_topics & (1ULL << topic)) != 0) ||
+        (_twr_radio_pub_compact.pending_length + _TWR_RADIO_PUB_COMPACT_ENTRY_MAX_SIZE > sizeof(_twr_radio_pub_compact.pending)))
+    {
+        if (!twr_radio_pub_compact_flush())
+        {
+            return false;
+        }
+    }
+
+    _twr_radio_pub_compact_node_t *node = &_twr_radio_pub_compact.node[topic];
+
+    // Registration lost on the way is sent again with the next value
+    if ((node->count == 0) || (!node->registered && !node->reg_pending))
+    {
+        if (!_twr_radio_pub_compact_register(topic))
+        {
+            return false;
+        }
+
+        node->reg_pending = true;
+    }
+
+    if (node->count % TWR_RADIO_PUB_COMPACT_KEY_INTERVAL == 0)
+    {
+        node->key = true;
+    }
+
+    if (++node->count == TWR_RADIO_PUB_COMPACT_REG_INTERVAL)
+    {
+        node->count = 0;
+    }
+
+    uint8_t *buffer = _twr_radio_pub_compact.pending;
+
+    if (_twr_radio_pub_compact.pending_length == 0)
+    {
+        buffer[0] = TWR_RADIO_HEADER_PUB_COMPACT_KEY;
+
+        _twr_radio_pub_compact.pending_length = 1;
+    }
+
+    size_t length = _twr_radio_pub_compact.pending_length;
+
+    // Frame in queue carries absolute values only, deltas are computed right before transmission
+    if (null)
+    {
+        buffer[length++] = _TWR_RADIO_PUB_COMPACT_ENTRY_ABSOLUTE | _TWR_RADIO_PUB_COMPACT_ENTRY_NULL | topic;
+    }
+    else
+    {
+        buffer[length++] = _TWR_RADIO_PUB_COMPACT_ENTRY_ABSOLUTE | topic;
+
+        length += _twr_radio_pub_compact_varint_to_buffer(quantized, buffer + length);
+    }
+
+    _twr_radio_pub_compact.pending_length = length;
+    _twr_radio_pub_compact.pending_topics |= 1ULL << topic;
+
+    twr_scheduler_plan_now(_twr_radio_pub_compact.task_id);
+
+    return true;
+}
+
+bool twr_radio_pub_compact_flush(void)
+{
+    if (_twr_radio_pub_compact.pending_length == 0)
+    {
+        return true;
+    }
+
+    // Frame stays pending when queue is full, so it can be retried
+    if (!twr_radio_pub_queue_put(_twr_radio_pub_compact.pending, _twr_radio_pub_compact.pending_length))
+    {
+        return false;
+    }
+
+    _twr_radio_pub_compact.pending_length = 0;
+    _twr_radio_pub_compact.pending_topics = 0;
+
+    return true;
+}
+
+static size_t _twr_radio_pub_compact_encode(uint8_t *buffer, size_t length)
+{
+    uint8_t encoded[TWR_RADIO_MAX_BUFFER_SIZE];
+    size_t offset = 1;
+    size_t encoded_length = 2;
+
+    if (length > sizeof(encoded) - 1)
+    {
+        return length;
+    }
+
+    for (int i = 0; i < _twr_radio_pub_compact.count; i++)
+    {
+        _twr_radio_pub_compact.node[i].in_flight = false;
+    }
+
+    encoded[0] = TWR_RADIO_HEADER_PUB_COMPACT;
+    encoded[1] = _twr_radio_pub_compact.gen;
+
+    while (offset < length)
+    {
+        uint8_t header = buffer[offset++];
+        int topic = header & _TWR_RADIO_PUB_COMPACT_ENTRY_TOPIC;
+
+        if ((header & _TWR_RADIO_PUB_COMPACT_ENTRY_NULL) != 0)
+        {
+            encoded[encoded_length++] = header;
+
+            continue;
+        }
+
+        int32_t value;
+        size_t size = _twr_radio_pub_compact_varint_from_buffer(buffer + offset, length - offset, &value);
+
+        if (size == 0)
+        {
+            return length;
+        }
+
+        offset += size;
+
+        if (topic >= _twr_radio_pub_compact.count)
+        {
+            memcpy(encoded + encoded_length, buffer + offset - size - 1, size + 1);
+
+            encoded_length += size + 1;
+
+            continue;
+        }
+
+        _twr_radio_pub_compact_node_t *node = &_twr_radio_pub_compact.node[topic];
+
+        node->in_flight = true;
+        node->flight = value;
+
+        // Gateway which has not confirmed registration may not know the reference
+        if (node->registered && node->ref_valid && !node->key && ((uint8_t) (_twr_radio_pub_compact.gen - node->ref_gen) < _TWR_RADIO_PUB_COMPACT_REF_MAX_AGE))
+        {
+            int32_t delta = value - node->ref;
+
+            // Delta only pays off when it is shorter, absolute value also resets reference at gateway
+            if (_twr_radio_pub_compact_varint_size(delta) < size)
+            {
+                encoded[encoded_length++] = topic;
+                encoded_length += _twr_radio_pub_compact_varint_to_buffer(delta, encoded + encoded_length);
+
+                continue;
+            }
+        }
+
+        node->key = false;
+
+        encoded[encoded_length++] = _TWR_RADIO_PUB_COMPACT_ENTRY_ABSOLUTE | topic;
+        encoded_length += _twr_radio_pub_compact_varint_to_buffer(value, encoded + encoded_length);
+    }
+
+    memcpy(buffer, encoded, encoded_length);
+
+    return encoded_length;
+}
+
+static void _twr_radio_pub_compact_ack(const uint8_t *buffer, size_t length)
+{
+    if ((buffer[0] == TWR_RADIO_HEADER_PUB_COMPACT_REG) && (length >= 2) && (buffer[1] < _twr_radio_pub_compact.count))
+    {
+        _twr_radio_pub_compact.node[buffer[1]].registered = true;
+        _twr_radio_pub_compact.node[buffer[1]].reg_pending = false;
+
+        return;
+    }
+
+    if (buffer[0] != TWR_RADIO_HEADER_PUB_COMPACT)
+    {
+        return;
+    }
+
+    _twr_radio_pub_compact.gen++;
+
+    for (int i = 0; i < _twr_radio_pub_compact.count; i++)
+    {
+        _twr_radio_pub_compact_node_t *node = &_twr_radio_pub_compact.node[i];
+
+        if (node->in_flight)
+        {
+            node->ref = node->flight;
+            node->ref_gen = _twr_radio_pub_compact.gen;
+            node->ref_valid = true;
+            node->in_flight = false;
+        }
+    }
+}
+
+static size_t _twr_radio_pub_compact_tx_error(uint8_t *buffer, size_t length)
+{
+    if ((buffer[0] == TWR_RADIO_HEADER_PUB_COMPACT_REG) && (length >= 2) && (buffer[1] < _twr_radio_pub_compact.count))
+    {
+        // Gateway may not know the topic, values go absolute and registration is repeated
+        _twr_radio_pub_compact.node[buffer[1]].registered = false;
+        _twr_radio_pub_compact.node[buffer[1]].reg_pending = false;
+    }
+
+    if (buffer[0] != TWR_RADIO_HEADER_PUB_COMPACT)
+    {
+        return length;
+    }
+
+    uint8_t frame[TWR_RADIO_MAX_BUFFER_SIZE];
+
+    length = 1;
+
+    frame[0] = TWR_RADIO_HEADER_PUB_COMPACT_KEY;
+
+    for (int i = 0; i < _twr_radio_pub_compact.count; i++)
+    {
+        _twr_radio_pub_compact_node_t *node = &_twr_radio_pub_compact.node[i];
+
+        if (node->in_flight)
+        {
+            // Gateway may or may not have got the frame, so it is not known what it refers to
+            node->ref_valid = false;
+            node->in_flight = false;
+
+            frame[length++] = _TWR_RADIO_PUB_COMPACT_ENTRY_ABSOLUTE | i;
+            length += _twr_radio_pub_compact_varint_to_buffer(node->flight, frame + length);
+        }
+    }
+
+    // Null values and values of unknown topics are not worth keeping
+    memcpy(buffer, frame, length);
+
+    return length > 1 ? length : 0;
+}
+
+void _twr_radio_pub_compact_decode(uint64_t *id, uint8_t *buffer, size_t length)
+{
+#if TWR_RADIO_PUB_COMPACT_GATEWAY_TOPICS > 0
+    if (buffer[0] == TWR_RADIO_HEADER_PUB_COMPACT_REG)
+    {
+        if ((length < 1 + 1 + sizeof(float) + 1) || (buffer[1] > _TWR_RADIO_PUB_COMPACT_ENTRY_TOPIC))
+        {
+            return;
+        }
+
+        _twr_radio_pub_compact_gateway_t *entry = _twr_radio_pub_compact_gateway_find(id, buffer[1]);
+
+        // Periodic registration keeps references, node may already send deltas against them
+        bool keep = (entry != NULL) && (memcmp(&entry->resolution, buffer + 2, sizeof(float)) == 0);
+
+        if (entry == NULL)
+        {
+            entry = &_twr_radio_pub_compact.gateway[_twr_radio_pub_compact.gateway_next];
+
+            if (++_twr_radio_pub_compact.gateway_next == TWR_RADIO_PUB_COMPACT_GATEWAY_TOPICS)
+            {
+                _twr_radio_pub_compact.gateway_next = 0;
+            }
+        }
+
+        size_t len = length - 1 - 1 - sizeof(float);
+
+        if (len > sizeof(entry->subtopic) - 1)
+        {
+            len = sizeof(entry->subtopic) - 1;
+        }
+
+        entry->id = *id;
+        entry->topic = buffer[1];
+
+        if (!keep)
+        {
+            entry->valid = 0;
+        }
+
+        memcpy(&entry->resolution, buffer + 2, sizeof(float));
+        memcpy(entry->subtopic, buffer + 2 + sizeof(float), len);
+
+        entry->subtopic[len] = 0;
+
+        return;
+    }
+
+    // Frame with generation updates references, self-contained frame (e.g. replayed from store) does not
+    bool live = buffer[0] == TWR_RADIO_HEADER_PUB_COMPACT;
+    size_t offset = live ? 2 : 1;
+    uint8_t gen = live && (length >= 2) ? buffer[1] : 0;
+
+    while (offset < length)
+    {
+        uint8_t header = buffer[offset++];
+
+        _twr_radio_pub_compact_gateway_t *entry = _twr_radio_pub_compact_gateway_find(id, header & _TWR_RADIO_PUB_COMPACT_ENTRY_TOPIC);
+
+        if ((header & _TWR_RADIO_PUB_COMPACT_ENTRY_NULL) != 0)
+        {
+            if (entry != NULL)
+            {
+                twr_radio_pub_on_float(id, entry->subtopic, NULL);
+            }
+
+            continue;
+        }
+
+        int32_t value;
+        size_t size = _twr_radio_pub_compact_varint_from_buffer(buffer + offset, length - offset, &value);
+
+        if (size == 0)
+        {
+            return;
+        }
+
+        offset += size;
+
+        // Values of topic which has not been registered yet are lost
+        if (entry == NULL)
+        {
+            continue;
+        }
+
+        bool absolute = (header & _TWR_RADIO_PUB_COMPACT_ENTRY_ABSOLUTE) != 0;
+
+        if (!absolute)
+        {
+            int32_t ref;
+
+            if (!live || !_twr_radio_pub_compact_gateway_get(entry, gen, &ref))
+            {
+                continue;
+            }
+
+            value += ref;
+        }
+
+        if (live)
+        {
+            _twr_radio_pub_compact_gateway_set(entry, gen + 1, value, absolute);
+        }
+
+        float result = value * entry->resolution;
+
+        twr_radio_pub_on_float(id, entry->subtopic, &result);
+    }
+#else
+    (void) id;
+    (void) buffer;
+    (void) length;
+#endif
+}
+
+static void _twr_radio_pub_compact_task(void *param)
+{
+    (void) param;
+
+    if (!twr_radio_pub_compact_flush())
+    {
+        twr_scheduler_plan_current_relative(_TWR_RADIO_PUB_COMPACT_RETRY_INTERVAL);
+    }
+}
+
+static bool _twr_radio_pub_compact_register(int topic)
+{
+    const twr_radio_pub_compact_topic_t *item = &_twr_radio_pub_compact.topics[topic];
+
+    size_t len = strlen(item->subtopic);
+
+    if (len > TWR_RADIO_PUB_COMPACT_SUBTOPIC_SIZE - 1)
+    {
+        return false;
+    }
+
+    uint8_t buffer[1 + 1 + sizeof(float) + TWR_RADIO_PUB_COMPACT_SUBTOPIC_SIZE];
+
+    buffer[0] = TWR_RADIO_HEADER_PUB_COMPACT_REG;
+    buffer[1] = topic;
+
+    memcpy(buffer + 2, &item->resolution, sizeof(float));
+    memcpy(buffer + 2 + sizeof(float), item->subtopic, len);
+
+    return twr_radio_pub_queue_put(buffer, 1 + 1 + sizeof(float) + len);
+}
+
+static size_t _twr_radio_pub_compact_varint_to_buffer(int32_t value, uint8_t *buffer)
+{
+    // Zig-zag maps small negative numbers to small positive ones
+    uint32_t zigzag = ((uint32_t) value << 1) ^ (uint32_t) (value >> 31);
+    size_t size = 0;
+
+    while (zigzag >= 0x80)
+    {
+        buffer[size++] = (zigzag & 0x7f) | 0x80;
+
+        zigzag >>= 7;
+    }
+
+    buffer[size++] = zigzag;
+
+    return size;
+}
+
+static size_t _twr_radio_pub_compact_varint_from_buffer(const uint8_t *buffer, size_t length, int32_t *value)
+{
+    uint32_t zigzag = 0;
+
+    for (size_t i = 0; (i < length) && (i < 5); i++)
+    {
+        zigzag |= (uint32_t) (buffer[i] & 0x7f) << (7 * i);
+
+        if ((buffer[i] & 0x80) == 0)
+        {
+            *value = (int32_t) (zigzag >> 1) ^ -(int32_t) (zigzag & 1);
+
+            return i + 1;
+        }
+    }
+
+    return 0;
+}
+
+static size_t _twr_radio_pub_compact_varint_size(int32_t value)
+{
+    uint32_t zigzag = ((uint32_t) value << 1) ^ (uint32_t) (value >> 31);
+    size_t size = 1;
+
+    while (zigzag >= 0x80)
+    {
+        zigzag >>= 7;
+
+        size++;
+    }
+
+    return size;
+}
+
+#if TWR_RADIO_PUB_COMPACT_GATEWAY_TOPICS > 0
+
+static _twr_radio_pub_compact_gateway_t *_twr_radio_pub_compact_gateway_find(uint64_t *id, uint8_t topic)
+{
+    for (int i = 0; i < TWR_RADIO_PUB_COMPACT_GATEWAY_TOPICS; i++)
+    {
+        _twr_radio_pub_compact_gateway_t *entry = &_twr_radio_pub_compact.gateway[i];
+
+        if ((entry->id == *id) && (entry->topic == topic) && (entry->subtopic[0] != 0))
+        {
+            return entry;
+        }
+    }
+
+    return NULL;
+}
+
+static bool _twr_radio_pub_compact_gateway_get(_twr_radio_pub_compact_gateway_t *entry, uint8_t gen, int32_t *value)
+{
+    int best = -1;
+
+    // Reference is the newest value not newer than generation the node refers to
+    for (int i = 0; i < 2; i++)
+    {
+        if (((entry->valid & (1 << i)) == 0) || ((int8_t) (entry->gen[i] - gen) > 0))
+        {
+            continue;
+        }
+
+        if ((best < 0) || ((int8_t) (entry->gen[i] - entry->gen[best]) > 0))
+        {
+            best = i;
+        }
+    }
+
+    if (best < 0)
+    {
+        return false;
+    }
+
+    *value = entry->value[best];
+
+    return true;
+}
+
+static void _twr_radio_pub_compact_gateway_set(_twr_radio_pub_compact_gateway_t *entry, uint8_t gen, int32_t value, bool reset)
+{
+    if (reset)
+    {
+        entry->valid = 0;
+    }
+
+    int slot = -1;
+
+    for (int i = 0; i < 2; i++)
+    {
+        if (((entry->valid & (1 << i)) != 0) && (entry->gen[i] == gen))
+        {
+            slot = i;
+        }
+    }
+
+    if (slot < 0)
+    {
+        if ((entry->valid & 1) == 0)
+        {
+            slot = 0;
+        }
+        else if ((entry->valid & 2) == 0)
+        {
+            slot = 1;
+        }
+        else
+        {
+            slot = (int8_t) (entry->gen[0] - entry->gen[1]) < 0 ? 0 : 1;
+        }
+    }
+
+    entry->gen[slot] = gen;
+    entry->value[slot] = value;
+    entry->valid |= 1 << slot;
+}
+
+#endif
@@ -6,6 +6,7 @@
 #include <stm32l0xx.h>
 #include <stm32l0xx_hal_conf.h>
 #include <twr_rtc.h>
+#include <twr_profile.h>
 #include <twr_sleep.h>
 
 #define _TWR_SYSTEM_DEBUG_ENABLE 0
@@ -21,6 +22,12 @@ static int _twr_system_hsi16_enable_semaphore;
 
 static int _twr_system_pll_enable_semaphore;
 
+static bool _twr_system_pll_linger;
+
+static twr_tick_t _twr_system_pll_linger_time = TWR_SYSTEM_PLL_LINGER_TIME;
+
+static twr_tick_t _twr_system_pll_linger_timeout;
+
 static int _twr_system_deep_sleep_disable_semaphore;
 
 static void _twr_system_init_flash(void);
@@ -39,6 +46,8 @@ static void _twr_system_init_shutdown_i2c_sensors(void);
 
 static void _twr_system_switch_clock(twr_system_clock_t clock);
 
+static void _twr_system_pll_stop(void);
+
 void twr_system_init(void)
 {
     _twr_system_init_flash();
@@ -282,6 +291,10 @@ void twr_system_deep_sleep_enable(void)
     if (_twr_system_deep_sleep_disable_semaphore == 0)
     {
         SCB->SCR |= SCB_SCR_SLEEPDEEP_Msk;
+
+#ifdef TWR_PROFILE
+        _twr_profile_deep_sleep_unblocked();
+#endif
     }
 }
 
@@ -290,6 +303,10 @@ void twr_system_deep_sleep_disable(void)
     if (_twr_system_deep_sleep_disable_semaphore == 0)
     {
         SCB->SCR &= ~SCB_SCR_SLEEPDEEP_Msk;
+
+#ifdef TWR_PROFILE
+        _twr_profile_deep_sleep_blocked(__builtin_return_address(0));
+#endif
     }
 
     _twr_system_deep_sleep_disable_semaphore++;
@@ -327,7 +344,7 @@ void twr_system_enter_standby_mode(void)
 
 twr_system_clock_t twr_system_clock_get(void)
 {
-    if (_twr_system_pll_enable_semaphore != 0)
+    if (_twr_system_pll_enable_semaphore != 0 || _twr_system_pll_linger)
     {
         return TWR_SYSTEM_CLOCK_PLL;
     }
@@ -367,6 +384,10 @@ void twr_system_hsi16_enable(void)
 
         // Update SystemCoreClock variable
         SystemCoreClock = 16000000;
+
+#ifdef TWR_PROFILE
+        _twr_profile_clock_hsi16(true);
+#endif
     }
 
     twr_sleep_disable();
@@ -397,6 +418,10 @@ void twr_system_hsi16_disable(void)
 
         // Set regulator range to 1.2V
         PWR->CR |= PWR_CR_VOS;
+
+#ifdef TWR_PROFILE
+        _twr_profile_clock_hsi16(false);
+#endif
     }
 
     twr_sleep_enable();
@@ -406,6 +431,14 @@ void twr_system_pll_enable(void)
 {
     if (++_twr_system_pll_enable_semaphore == 1)
     {
+        if (_twr_system_pll_linger)
+        {
+            // PLL is still running after previous section, no need to wait for lock
+            _twr_system_pll_linger = false;
+
+            return;
+        }
+
         twr_system_hsi16_enable();
 
         // Turn PLL on
@@ -423,6 +456,10 @@ void twr_system_pll_enable(void)
 
         // Update SystemCoreClock variable
         SystemCoreClock = 32000000;
+
+#ifdef TWR_PROFILE
+        _twr_profile_clock_pll(true);
+#endif
     }
 }
 
@@ -430,18 +467,35 @@ void twr_system_pll_disable(void)
 {
     if (--_twr_system_pll_enable_semaphore == 0)
     {
-        _twr_system_switch_clock(TWR_SYSTEM_CLOCK_HSI);
+        // Keep PLL running for back-to-back sections, it is stopped by twr_system_pll_idle
+        _twr_system_pll_linger = true;
+        _twr_system_pll_linger_timeout = twr_tick_get() + _twr_system_pll_linger_time;
+    }
+}
+
+void twr_system_pll_set_linger_time(twr_tick_t linger_time)
+{
+    _twr_system_pll_linger_time = linger_time;
+}
 
-        // Turn PLL off
-        RCC->CR &= ~RCC_CR_PLLON;
+void twr_system_pll_idle(void)
+{
+    if (!_twr_system_pll_linger)
+    {
+        return;
+    }
 
-        while ((RCC->CR & RCC_CR_PLLRDY) != 0)
-        {
-            continue;
-        }
+    twr_irq_disable();
+
+    // Section may have been opened from interrupt in the meantime
+    if (_twr_system_pll_linger && twr_tick_get() >= _twr_system_pll_linger_timeout)
+    {
+        _twr_system_pll_linger = false;
 
-        twr_system_hsi16_disable();
+        _twr_system_pll_stop();
     }
+
+    twr_irq_enable();
 }
 
 uint32_t twr_system_get_clock(void)
@@ -513,6 +567,25 @@ void RTC_IRQHandler(void)
 }
 
 
+static void _twr_system_pll_stop(void)
+{
+    _twr_system_switch_clock(TWR_SYSTEM_CLOCK_HSI);
+
+    // Turn PLL off
+    RCC->CR &= ~RCC_CR_PLLON;
+
+    while ((RCC->CR & RCC_CR_PLLRDY) != 0)
+    {
+        continue;
+    }
+
+#ifdef TWR_PROFILE
+    _twr_profile_clock_pll(false);
+#endif
+
+    twr_system_hsi16_disable();
+}
+
 static void _twr_system_switch_clock(twr_system_clock_t clock)
 {
     uint32_t clock_mask = twr_system_clock_table[clock];
@@ -0,0 +1,7 @@
+#ifndef _NODE_CONFIG_H
+#define _NODE_CONFIG_H
+
+// GPS Module node publishing thermometer of Core Module
+#define NODE_THERMOMETER 1
+
+#endif
@@ -210,6 +210,14 @@ void twr_dma_channel_config(twr_dma_channel_t channel, twr_dma_channel_config_t
 
 void twr_dma_set_event_handler(twr_dma_channel_t channel, void (*event_handler)(twr_dma_channel_t, twr_dma_event_t, void *), void *event_param);
 
+//! @brief Check if DMA channel is used by a driver
+//! @details Channel is used while an event handler is set on it, drivers sharing a channel clear it when they are done.
+//! @param[in] channel DMA channel
+//! @return true If channel has event handler
+//! @return false If channel is free
+
+bool twr_dma_channel_is_used(twr_dma_channel_t channel);
+
 //! @brief Start DMA channel
 //! @param[in] channel DMA channel
 
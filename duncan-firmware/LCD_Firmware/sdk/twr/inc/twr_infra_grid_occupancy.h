@@ -0,0 +1,155 @@
+#ifndef _TWR_INFRA_GRID_OCCUPANCY_H
+#define _TWR_INFRA_GRID_OCCUPANCY_H
+
+#include <twr_common.h>
+
+//! @addtogroup twr_infra_grid_occupancy twr_infra_grid_occupancy
+//! @brief Occupancy detection and people counting on 8x8 thermal frames of Infra Grid Module
+//! @details Frames are processed in integers (quarters of degree of Celsius as returned by
+//!          twr_module_infra_grid_get_temperatures_raw). Pixels warmer than the learned background form blobs, blob
+//!          centroids are tracked between frames and counted when crossing the middle of the grid. Application is
+//!          expected to publish only events and counters, or the quantized frame from
+//!          twr_infra_grid_occupancy_encode_frame which fits into a single radio packet unless most of the frame
+//!          is in foreground.
+//! @{
+
+//! @brief Number of pixels in frame
+
+#define TWR_INFRA_GRID_OCCUPANCY_PIXELS 64
+
+//! @brief Maximum number of tracked blobs
+
+#define TWR_INFRA_GRID_OCCUPANCY_MAX_BLOBS 4
+
+//! @brief Size of buffer for encoded frame in bytes (worst case, all pixels in foreground)
+
+#define TWR_INFRA_GRID_OCCUPANCY_FRAME_SIZE (8 + TWR_INFRA_GRID_OCCUPANCY_PIXELS)
+
+//! @brief Callback events
+
+typedef enum
+{
+    //! @brief Background model has been learned, frames are evaluated from now on
+    TWR_INFRA_GRID_OCCUPANCY_EVENT_READY = 0,
+
+    //! @brief Number of blobs in the field of view has changed
+    TWR_INFRA_GRID_OCCUPANCY_EVENT_OCCUPANCY = 1,
+
+    //! @brief Blob crossed the middle of the grid in the direction of increasing column
+    TWR_INFRA_GRID_OCCUPANCY_EVENT_ENTER = 2,
+
+    //! @brief Blob crossed the middle of the grid in the direction of decreasing column
+    TWR_INFRA_GRID_OCCUPANCY_EVENT_LEAVE = 3
+
+} twr_infra_grid_occupancy_event_t;
+
+//! @brief Instance
+
+typedef struct twr_infra_grid_occupancy_t twr_infra_grid_occupancy_t;
+
+//! @cond
+
+typedef struct
+{
+    // Centroid in sixteenths of pixel
+    int16_t x;
+    int16_t y;
+
+} twr_infra_grid_occupancy_blob_t;
+
+struct twr_infra_grid_occupancy_t
+{
+    // Background in sixteenths of raw value (1/64 degree of Celsius)
+    int16_t _background[TWR_INFRA_GRID_OCCUPANCY_PIXELS];
+    int16_t _residual[TWR_INFRA_GRID_OCCUPANCY_PIXELS];
+    int8_t _delta[TWR_INFRA_GRID_OCCUPANCY_PIXELS];
+    uint64_t _mask;
+    twr_infra_grid_occupancy_blob_t _blob[TWR_INFRA_GRID_OCCUPANCY_MAX_BLOBS];
+    int _blob_count;
+    int16_t _threshold;
+    uint8_t _background_shift;
+    uint8_t _min_blob_size;
+    int _learn_count;
+    uint16_t _count_enter;
+    uint16_t _count_leave;
+    void (*_event_handler)(twr_infra_grid_occupancy_t *, twr_infra_grid_occupancy_event_t, void *);
+    void *_event_param;
+
+};
+
+//! @endcond
+
+//! @brief Initialize occupancy detector
+//! @param[in] self Instance
+
+void twr_infra_grid_occupancy_init(twr_infra_grid_occupancy_t *self);
+
+//! @brief Set callback function
+//! @param[in] self Instance
+//! @param[in] event_handler Function address
+//! @param[in] event_param Optional event parameter (can be NULL)
+
+void twr_infra_grid_occupancy_set_event_handler(twr_infra_grid_occupancy_t *self, void (*event_handler)(twr_infra_grid_occupancy_t *, twr_infra_grid_occupancy_event_t, void *), void *event_param);
+
+//! @brief Set foreground threshold
+//! @param[in] self Instance
+//! @param[in] threshold Difference from background in quarters of degree of Celsius (default 6, i.e. 1.5 °C)
+
+void twr_infra_grid_occupancy_set_threshold(twr_infra_grid_occupancy_t *self, int16_t threshold);
+
+//! @brief Set background adaptation rate
+//! @param[in] self Instance
+//! @param[in] shift Background follows empty pixels with weight 1 / 2^shift per frame (1 to 8, default 5)
+
+void twr_infra_grid_occupancy_set_background_rate(twr_infra_grid_occupancy_t *self, uint8_t shift);
+
+//! @brief Set minimum blob size
+//! @param[in] self Instance
+//! @param[in] pixels Minimum number of connected foreground pixels to be counted as blob (default 2)
+
+void twr_infra_grid_occupancy_set_min_blob_size(twr_infra_grid_occupancy_t *self, uint8_t pixels);
+
+//! @brief Forget background and learn it again from the next frames
+//! @param[in] self Instance
+
+void twr_infra_grid_occupancy_reset(twr_infra_grid_occupancy_t *self);
+
+//! @brief Process frame
+//! @param[in] self Instance
+//! @param[in] frame Array of 64 temperatures in quarters of degree of Celsius
+//! @return true If frame has been evaluated
+//! @return false If background is still being learned
+
+bool twr_infra_grid_occupancy_feed(twr_infra_grid_occupancy_t *self, const int16_t *frame);
+
+//! @brief Get number of blobs in the last frame
+//! @param[in] self Instance
+//! @return Number of blobs
+
+int twr_infra_grid_occupancy_get_blob_count(twr_infra_grid_occupancy_t *self);
+
+//! @brief Get foreground mask of the last frame
+//! @param[in] self Instance
+//! @return Bit n set if pixel n is foreground
+
+uint64_t twr_infra_grid_occupancy_get_mask(twr_infra_grid_occupancy_t *self);
+
+//! @brief Get people counters
+//! @param[in] self Instance
+//! @param[out] enter Number of enter crossings (can be NULL)
+//! @param[out] leave Number of leave crossings (can be NULL)
+
+void twr_infra_grid_occupancy_get_counters(twr_infra_grid_occupancy_t *self, uint16_t *enter, uint16_t *leave);
+
+//! @brief Encode difference of the last frame from background
+//! @details Foreground mask (8 bytes) is followed by one signed byte per foreground pixel in half degrees of Celsius.
+//! @param[in] self Instance
+//! @param[out] buffer Destination buffer
+//! @param[in] length Size of destination buffer
+//! @return Number of bytes written or 0 if buffer is too small
+
+size_t twr_infra_grid_occupancy_encode_frame(twr_infra_grid_occupancy_t *self, uint8_t *buffer, size_t length);
+
+//! @}
+
+#endif // _TWR_INFRA_GRID_OCCUPANCY_H
@@ -0,0 +1,140 @@
+#ifndef _TWR_MODULE_RS485_MODBUS_H
+#define _TWR_MODULE_RS485_MODBUS_H
+
+#include <twr_module_rs485.h>
+
+//! @addtogroup twr_module_rs485_modbus twr_module_rs485_modbus
+//! @brief Modbus RTU master on RS-485 Module
+//! @details Application gives a table of registers to poll, registers of the same slave and function at adjacent
+//!          addresses are read by a single request. Poll cycle sends the requests back to back, each one 3.5
+//!          character times after the previous response, and raises update event when all of them are done.
+//!          Response is collected from the receive FIFO of the module in one I2C transfer at the time it is
+//!          expected to be complete, end of shorter exception response is detected as silence of 3.5 characters.
+//!          Register writes are queued and sent before the next request of the poll cycle.
+//! @{
+
+//! @brief Maximum number of registers in poll table
+
+#ifndef TWR_MODULE_RS485_MODBUS_MAX_REGISTERS
+#define TWR_MODULE_RS485_MODBUS_MAX_REGISTERS 64
+#endif
+
+//! @brief Maximum number of requests poll table is coalesced into
+
+#ifndef TWR_MODULE_RS485_MODBUS_MAX_REQUESTS
+#define TWR_MODULE_RS485_MODBUS_MAX_REQUESTS 16
+#endif
+
+//! @brief Unused registers a request may read to join two polled ones (0 joins adjacent registers only)
+
+#ifndef TWR_MODULE_RS485_MODBUS_COALESCE_GAP
+#define TWR_MODULE_RS485_MODBUS_COALESCE_GAP 0
+#endif
+
+//! @brief Time slave has to start responding in milliseconds
+
+#ifndef TWR_MODULE_RS485_MODBUS_RESPONSE_TIMEOUT
+#define TWR_MODULE_RS485_MODBUS_RESPONSE_TIMEOUT 200
+#endif
+
+//! @brief Maximum number of registers read by one request, response fits receive FIFO of the module
+
+#define TWR_MODULE_RS485_MODBUS_MAX_COUNT 29
+
+//! @brief Read functions
+
+typedef enum
+{
+    //! @brief Read holding registers
+    TWR_MODULE_RS485_MODBUS_FUNCTION_READ_HOLDING_REGISTERS = 0x03,
+
+    //! @brief Read input registers
+    TWR_MODULE_RS485_MODBUS_FUNCTION_READ_INPUT_REGISTERS = 0x04
+
+} twr_module_rs485_modbus_function_t;
+
+//! @brief Register in poll table
+
+typedef struct
+{
+    //! @brief Slave address
+    uint8_t slave;
+
+    //! @brief Read function
+    twr_module_rs485_modbus_function_t function;
+
+    //! @brief Register address
+    uint16_t address;
+
+} twr_module_rs485_modbus_register_t;
+
+//! @brief Callback events
+
+typedef enum
+{
+    //! @brief Poll cycle is done, values are updated
+    TWR_MODULE_RS485_MODBUS_EVENT_UPDATE = 0,
+
+    //! @brief Register has been written
+    TWR_MODULE_RS485_MODBUS_EVENT_WRITE_DONE = 1,
+
+    //! @brief Slave has not confirmed register write
+    TWR_MODULE_RS485_MODBUS_EVENT_WRITE_ERROR = 2,
+
+    //! @brief Communication with module failed
+    TWR_MODULE_RS485_MODBUS_EVENT_ERROR = 3
+
+} twr_module_rs485_modbus_event_t;
+
+//! @brief Initialize RS-485 Module and Modbus master
+//! @param[in] baudrate Baudrate of the bus
+//! @return true On success
+//! @return false When module is not detected
+
+bool twr_module_rs485_modbus_init(twr_module_rs485_baudrate_t baudrate);
+
+//! @brief Set callback function
+//! @param[in] event_handler Function address
+//! @param[in] event_param Optional event parameter (can be NULL)
+
+void twr_module_rs485_modbus_set_event_handler(void (*event_handler)(twr_module_rs485_modbus_event_t, void *), void *event_param);
+
+//! @brief Set registers to poll
+//! @param[in] table Registers, index in table is the index of value (must stay valid)
+//! @param[in] count Number of registers
+//! @return true On success
+//! @return false If table has too many registers or needs too many requests
+
+bool twr_module_rs485_modbus_set_poll_table(const twr_module_rs485_modbus_register_t *table, int count);
+
+//! @brief Set poll interval
+//! @param[in] interval Poll interval
+
+void twr_module_rs485_modbus_set_update_interval(twr_tick_t interval);
+
+//! @brief Start poll cycle
+//! @return true On success
+//! @return false When poll cycle is in progress
+
+bool twr_module_rs485_modbus_poll(void);
+
+//! @brief Get value of register from last poll cycle
+//! @param[in] index Index of register in poll table
+//! @param[out] value Value
+//! @return true On success
+//! @return false If slave has not responded or reported exception
+
+bool twr_module_rs485_modbus_get_value(int index, uint16_t *value);
+
+//! @brief Queue write of single register
+//! @param[in] slave Slave address
+//! @param[in] address Register address
+//! @param[in] value Value
+//! @return true On success
+//! @return false On full queue
+
+bool twr_module_rs485_modbus_write(uint8_t slave, uint16_t address, uint16_t value);
+
+//! @}
+
+#endif // _TWR_MODULE_RS485_MODBUS_H
@@ -49,6 +49,13 @@ bool twr_queue_get(twr_queue_t *queue, void *buffer, size_t *length);
 
 void twr_queue_clear(twr_queue_t *queue);
 
+//! @brief Check whether queue is empty
+//! @param[in] queue Instance
+//! @return true If queue is empty
+//! @return false If queue holds at least one buffer
+
+bool twr_queue_is_empty(twr_queue_t *queue);
+
 //! @}
 
 #endif // _TWR_QUEUE_H
@@ -2,6 +2,7 @@
 #define _TWR_SLEEP_H
 
 #include <twr_system.h>
+#include <twr_profile.h>
 
 typedef struct twr_sleep_manager {
     int disable_sleep_semaphore;
@@ -39,7 +40,11 @@ void twr_sleep_enable(void);
 static inline void twr_sleep(void)
 {
     if (sleep_manager.disable_sleep_semaphore == 0) {
+#ifdef TWR_PROFILE
+        twr_profile_sleep();
+#else
         twr_system_sleep();
+#endif
     }
 }
 
@@ -0,0 +1,486 @@
+#include <twr_kv.h>
+#include <twr_eeprom.h>
+#include <twr_crc.h>
+
+#define _TWR_KV_SIGNATURE 0x3153564b
+#define _TWR_KV_CRC_POLYNOMIAL 0x07
+#define _TWR_KV_NONE 0xffff
+#define _TWR_KV_CHUNK_SIZE 16
+#define _TWR_KV_ALIGN(length) (((length) + 3) & ~3UL)
+
+typedef struct
+{
+    uint32_t signature;
+    uint8_t generation;
+    uint8_t reserved[2];
+    uint8_t crc;
+
+} _twr_kv_header_t;
+
+typedef struct
+{
+    uint8_t generation;
+    uint8_t key;
+    uint8_t length;
+    uint8_t crc;
+
+} _twr_kv_record_t;
+
+static struct
+{
+    bool ready;
+    uint32_t address;
+    size_t half_size;
+    uint32_t half;
+    uint8_t generation;
+    size_t head;
+    uint16_t index[TWR_KV_MAX_KEYS];
+
+} _twr_kv;
+
+static bool _twr_kv_header_read(uint32_t half, uint8_t *generation);
+static bool _twr_kv_header_write(uint32_t half, uint8_t generation);
+static bool _twr_kv_clear(uint32_t half, size_t offset);
+static void _twr_kv_scan(void);
+static uint8_t _twr_kv_record_crc(const _twr_kv_record_t *record, uint32_t data_address, const void *buffer);
+static bool _twr_kv_record_write(uint32_t half, size_t offset, _twr_kv_record_t *record, uint32_t data_address, const void *buffer);
+static bool _twr_kv_fits(size_t length);
+static bool _twr_kv_append(uint8_t key, const void *buffer, size_t length);
+static bool _twr_kv_equals(uint8_t key, const void *buffer, size_t length);
+
+bool twr_kv_init(uint32_t address, size_t size)
+{
+    memset(&_twr_kv, 0, sizeof(_twr_kv));
+
+    if ((address % 4 != 0) || (size % 8 != 0) || (address + size > twr_eeprom_get_size()))
+    {
+        return false;
+    }
+
+    if ((size / 2 < sizeof(_twr_kv_header_t) + sizeof(_twr_kv_record_t) + 4) || (size / 2 >= _TWR_KV_NONE))
+    {
+        return false;
+    }
+
+    _twr_kv.address = address;
+    _twr_kv.half_size = size / 2;
+
+    uint8_t generation_a;
+    uint8_t generation_b;
+
+    bool valid_a = _twr_kv_header_read(address, &generation_a);
+    bool valid_b = _twr_kv_header_read(address + _twr_kv.half_size, &generation_b);
+
+    if (valid_a && (!valid_b || (int8_t) (generation_a - generation_b) > 0))
+    {
+        _twr_kv.half = address;
+        _twr_kv.generation = generation_a;
+    }
+    else if (valid_b)
+    {
+        _twr_kv.half = address + _twr_kv.half_size;
+        _twr_kv.generation = generation_b;
+    }
+    else
+    {
+        // Blank or foreign region, start empty log
+        if (!_twr_kv_clear(address, sizeof(_twr_kv_header_t)) || !_twr_kv_header_write(address, 1))
+        {
+            return false;
+        }
+
+        _twr_kv.half = address;
+        _twr_kv.generation = 1;
+    }
+
+    _twr_kv_scan();
+
+    _twr_kv.ready = true;
+
+    return true;
+}
+
+bool twr_kv_is_ready(void)
+{
+    return _twr_kv.ready;
+}
+
+bool twr_kv_set(uint8_t key, const void *buffer, size_t length)
+{
+    if (!_twr_kv.ready || (key >= TWR_KV_MAX_KEYS) || (length == 0) || (length > TWR_KV_MAX_LENGTH))
+    {
+        return false;
+    }
+
+    // Do not wear EEPROM by storing the same value again
+    if (_twr_kv_equals(key, buffer, length))
+    {
+        return true;
+    }
+
+    // Compaction only makes room, failed EEPROM write is reported as it is
+    if (!_twr_kv_fits(length) && !twr_kv_compact())
+    {
+        return false;
+    }
+
+    return _twr_kv_append(key, buffer, length);
+}
+
+size_t twr_kv_get(uint8_t key, void *buffer, size_t length)
+{
+    size_t value_length = twr_kv_get_length(key);
+
+    if ((value_length == 0) || (value_length > length))
+    {
+        return 0;
+    }
+
+    uint32_t address = _twr_kv.half + _twr_kv.index[key] + sizeof(_twr_kv_record_t);
+
+    if (!twr_eeprom_read(address, buffer, value_length))
+    {
+        return 0;
+    }
+
+    return value_length;
+}
+
+size_t twr_kv_get_length(uint8_t key)
+{
+    if (!_twr_kv.ready || (key >= TWR_KV_MAX_KEYS) || (_twr_kv.index[key] == _TWR_KV_NONE))
+    {
+        return 0;
+    }
+
+    _twr_kv_record_t record;
+
+    twr_eeprom_read(_twr_kv.half + _twr_kv.index[key], &record, sizeof(record));
+
+    return record.length;
+}
+
+bool twr_kv_remove(uint8_t key)
+{
+    if (!_twr_kv.ready || (key >= TWR_KV_MAX_KEYS))
+    {
+        return false;
+    }
+
+    if (_twr_kv.index[key] == _TWR_KV_NONE)
+    {
+        return true;
+    }
+
+    // Zero length record marks removed key
+    if (_twr_kv_fits(0))
+    {
+        return _twr_kv_append(key, NULL, 0);
+    }
+
+    // Compaction drops the key as it is skipped from the new log
+    uint16_t offset = _twr_kv.index[key];
+
+    _twr_kv.index[key] = _TWR_KV_NONE;
+
+    if (!twr_kv_compact())
+    {
+        _twr_kv.index[key] = offset;
+
+        return false;
+    }
+
+    return true;
+}
+
+bool twr_kv_compact(void)
+{
+    if (!_twr_kv.ready)
+    {
+        return false;
+    }
+
+    uint32_t half = (_twr_kv.half == _twr_kv.address) ? _twr_kv.address + _twr_kv.half_size : _twr_kv.address;
+    uint16_t index[TWR_KV_MAX_KEYS];
+    size_t offset = sizeof(_twr_kv_header_t);
+
+    // Generation 0 is kept for cleared space, so it is skipped on wrap
+    uint8_t generation = _twr_kv.generation + 1 != 0 ? _twr_kv.generation + 1 : 1;
+
+    for (uint8_t key = 0; key < TWR_KV_MAX_KEYS; key++)
+    {
+        index[key] = _TWR_KV_NONE;
+
+        if (_twr_kv.index[key] == _TWR_KV_NONE)
+        {
+            continue;
+        }
+
+        _twr_kv_record_t record;
+
+        twr_eeprom_read(_twr_kv.half + _twr_kv.index[key], &record, sizeof(record));
+
+        size_t size = sizeof(record) + _TWR_KV_ALIGN(record.length);
+
+        if (offset + size > _twr_kv.half_size)
+        {
+            return false;
+        }
+
+        record.generation = generation;
+
+        if (!_twr_kv_record_write(half, offset, &record, _twr_kv.half + _twr_kv.index[key] + sizeof(record), NULL))
+        {
+            return false;
+        }
+
+        index[key] = offset;
+
+        offset += size;
+    }
+
+    // Generation wraps, so records left behind in the new half could match it again, clear them to end the log
+    if (!_twr_kv_clear(half, offset))
+    {
+        return false;
+    }
+
+    // New half becomes valid only once all records are in place
+    if (!_twr_kv_header_write(half, generation))
+    {
+        return false;
+    }
+
+    _twr_kv.half = half;
+    _twr_kv.generation = generation;
+    _twr_kv.head = offset;
+
+    memcpy(_twr_kv.index, index, sizeof(index));
+
+    return true;
+}
+
+size_t twr_kv_get_free(void)
+{
+    if (!_twr_kv.ready)
+    {
+        return 0;
+    }
+
+    return _twr_kv.half_size - _twr_kv.head;
+}
+
+static bool _twr_kv_header_read(uint32_t half, uint8_t *generation)
+{
+    _twr_kv_header_t header;
+
+    twr_eeprom_read(half, &header, sizeof(header));
+
+    if (header.signature != _TWR_KV_SIGNATURE)
+    {
+        return false;
+    }
+
+    if (header.crc != twr_crc8(_TWR_KV_CRC_POLYNOMIAL, &header, sizeof(header) - 1, 0))
+    {
+        return false;
+    }
+
+    *generation = header.generation;
+
+    return true;
+}
+
+static bool _twr_kv_header_write(uint32_t half, uint8_t generation)
+{
+    _twr_kv_header_t header = {
+        .signature = _TWR_KV_SIGNATURE,
+        .generation = generation
+    };
+
+    header.crc = twr_crc8(_TWR_KV_CRC_POLYNOMIAL, &header, sizeof(header) - 1, 0);
+
+    return twr_eeprom_write(half, &header, sizeof(header));
+}
+
+static bool _twr_kv_clear(uint32_t half, size_t offset)
+{
+    static const uint8_t zero[_TWR_KV_CHUNK_SIZE];
+
+    // Words already cleared are not programmed again by twr_eeprom_write
+    while (offset < _twr_kv.half_size)
+    {
+        size_t length = _twr_kv.half_size - offset < sizeof(zero) ? _twr_kv.half_size - offset : sizeof(zero);
+
+        if (!twr_eeprom_write(half + offset, zero, length))
+        {
+            return false;
+        }
+
+        offset += length;
+    }
+
+    return true;
+}
+
+static void _twr_kv_scan(void)
+{
+    size_t offset = sizeof(_twr_kv_header_t);
+
+    for (uint8_t key = 0; key < TWR_KV_MAX_KEYS; key++)
+    {
+        _twr_kv.index[key] = _TWR_KV_NONE;
+    }
+
+    while (offset + sizeof(_twr_kv_record_t) <= _twr_kv.half_size)
+    {
+        _twr_kv_record_t record;
+
+        twr_eeprom_read(_twr_kv.half + offset, &record, sizeof(record));
+
+        // Cleared space (generation 0) and records left over from older generations end the log
+        if (record.generation != _twr_kv.generation)
+        {
+            break;
+        }
+
+        size_t size = sizeof(record) + _TWR_KV_ALIGN(record.length);
+
+        if (offset + size > _twr_kv.half_size)
+        {
+            break;
+        }
+
+        // Record interrupted by power loss ends the log, next append overwrites it
+        if (record.crc != _twr_kv_record_crc(&record, _twr_kv.half + offset + sizeof(record), NULL))
+        {
+            break;
+        }
+
+        if (record.key < TWR_KV_MAX_KEYS)
+        {
+            _twr_kv.index[record.key] = record.length != 0 ? offset : _TWR_KV_NONE;
+        }
+
+        offset += size;
+    }
+
+    _twr_kv.head = offset;
+}
+
+static uint8_t _twr_kv_record_crc(const _twr_kv_record_t *record, uint32_t data_address, const void *buffer)
+{
+    uint8_t crc = twr_crc8(_TWR_KV_CRC_POLYNOMIAL, record, sizeof(*record) - 1, 0);
+
+    if (buffer != NULL)
+    {
+        return twr_crc8(_TWR_KV_CRC_POLYNOMIAL, buffer, record->length, crc);
+    }
+
+    uint8_t chunk[_TWR_KV_CHUNK_SIZE];
+
+    for (size_t i = 0; i < record->length; i += sizeof(chunk))
+    {
+        size_t length = record->length - i < sizeof(chunk) ? record->length - i : sizeof(chunk);
+
+        twr_eeprom_read(data_address + i, chunk, length);
+
+        crc = twr_crc8(_TWR_KV_CRC_POLYNOMIAL, chunk, length, crc);
+    }
+
+    return crc;
+}
+
+static bool _twr_kv_record_write(uint32_t half, size_t offset, _twr_kv_record_t *record, uint32_t data_address, const void *buffer)
+{
+    uint32_t address = half + offset + sizeof(*record);
+
+    record->crc = _twr_kv_record_crc(record, data_address, buffer);
+
+    // Data goes first, so torn write leaves the record header invalid
+    if (buffer != NULL)
+    {
+        if ((record->length != 0) && !twr_eeprom_write(address, buffer, record->length))
+        {
+            return false;
+        }
+    }
+    else
+    {
+        uint8_t chunk[_TWR_KV_CHUNK_SIZE];
+
+        for (size_t i = 0; i < record->length; i += sizeof(chunk))
+        {
+            size_t length = record->length - i < sizeof(chunk) ? record->length - i : sizeof(chunk);
+
+            twr_eeprom_read(data_address + i, chunk, length);
+
+            if (!twr_eeprom_write(address + i, chunk, length))
+            {
+                return false;
+            }
+        }
+    }
+
+    return twr_eeprom_write(half + offset, record, sizeof(*record));
+}
+
+static bool _twr_kv_fits(size_t length)
+{
+    return _twr_kv.head + sizeof(_twr_kv_record_t) + _TWR_KV_ALIGN(length) <= _twr_kv.half_size;
+}
+
+static bool _twr_kv_append(uint8_t key, const void *buffer, size_t length)
+{
+    size_t size = sizeof(_twr_kv_record_t) + _TWR_KV_ALIGN(length);
+
+    if (!_twr_kv_fits(length))
+    {
+        return false;
+    }
+
+    _twr_kv_record_t record = {
+        .generation = _twr_kv.generation,
+        .key = key,
+        .length = length
+    };
+
+    static const uint8_t empty;
+
+    if (!_twr_kv_record_write(_twr_kv.half, _twr_kv.head, &record, 0, buffer != NULL ? buffer : &empty))
+    {
+        // Partially written record is overwritten by the next append
+        return false;
+    }
+
+    _twr_kv.index[key] = length != 0 ? _twr_kv.head : _TWR_KV_NONE;
+
+    _twr_kv.head += size;
+
+    return true;
+}
+
+static bool _twr_kv_equals(uint8_t key, const void *buffer, size_t length)
+{
+    if (twr_kv_get_length(key) != length)
+    {
+        return false;
+    }
+
+    uint32_t address = _twr_kv.half + _twr_kv.index[key] + sizeof(_twr_kv_record_t);
+    uint8_t chunk[_TWR_KV_CHUNK_SIZE];
+
+    for (size_t i = 0; i < length; i += sizeof(chunk))
+    {
+        size_t chunk_length = length - i < sizeof(chunk) ? length - i : sizeof(chunk);
+
+        twr_eeprom_read(address + i, chunk, chunk_length);
+
+        if (memcmp(chunk, (const uint8_t *) buffer + i, chunk_length) != 0)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
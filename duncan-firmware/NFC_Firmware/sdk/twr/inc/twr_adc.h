@@ -3,6 +3,7 @@
 
 #include <twr_common.h>
 #include <stm32l083xx.h>
+#include <twr_fixed.h>
 
 //! @addtogroup twr_adc twr_adc
 //! @brief Driver for ADC (analog to digital converter)
@@ -95,6 +96,39 @@ typedef enum
 
 } twr_adc_event_t;
 
+//! @brief ADC scan channel, channels are converted in ascending order of their bits
+
+typedef enum
+{
+    //! @brief ADC channel A0
+    TWR_ADC_SCAN_A0 = ADC_CHSELR_CHSEL0,
+
+    //! @brief ADC channel A1
+    TWR_ADC_SCAN_A1 = ADC_CHSELR_CHSEL1,
+
+    //! @brief ADC channel A2
+    TWR_ADC_SCAN_A2 = ADC_CHSELR_CHSEL2,
+
+    //! @brief ADC channel A3
+    TWR_ADC_SCAN_A3 = ADC_CHSELR_CHSEL3,
+
+    //! @brief ADC channel A4
+    TWR_ADC_SCAN_A4 = ADC_CHSELR_CHSEL4,
+
+    //! @brief ADC channel A5
+    TWR_ADC_SCAN_A5 = ADC_CHSELR_CHSEL5,
+
+    //! @brief ADC channel A6
+    TWR_ADC_SCAN_A6 = ADC_CHSELR_CHSEL6,
+
+    //! @brief Internal reference, updates VDDA
+    TWR_ADC_SCAN_VREFINT = ADC_CHSELR_CHSEL17,
+
+    //! @brief Internal temperature sensor
+    TWR_ADC_SCAN_TEMPERATURE = ADC_CHSELR_CHSEL18
+
+} twr_adc_scan_channel_t;
+
 //! @brief Initialize ADC converter
 
 void twr_adc_init();
@@ -145,6 +179,14 @@ bool twr_adc_async_get_value(twr_adc_channel_t channel, uint16_t *result);
 
 bool twr_adc_async_get_voltage(twr_adc_channel_t channel, float *result);
 
+//! @brief Get asynchronous measurement result in volts as fixed-point value
+//! @param[in] channel ADC channel
+//! @param[out] result Pointer to variable where result in volts will be stored
+//! @return true On success
+//! @return false On failure
+
+bool twr_adc_async_get_voltage_fixed(twr_adc_channel_t channel, twr_fixed_t *result);
+
 //! @brief Get voltage on VDDA pin
 //! @param[out] vdda_voltage Pointer to destination where VDDA will be stored
 //! @return true On valid VDDA
@@ -152,6 +194,13 @@ bool twr_adc_async_get_voltage(twr_adc_channel_t channel, float *result);
 
 bool twr_adc_get_vdda_voltage(float *vdda_voltage);
 
+//! @brief Get voltage on VDDA pin as fixed-point value
+//! @param[out] vdda_voltage Pointer to destination where VDDA will be stored
+//! @return true On valid VDDA
+//! @return false On invalid VDDA
+
+bool twr_adc_get_vdda_voltage_fixed(twr_fixed_t *vdda_voltage);
+
 //! @brief Calibration
 //! @return true On success
 //! @return false On failure
@@ -170,6 +219,43 @@ void twr_adc_resolution_set(twr_adc_channel_t channel, twr_adc_resolution_t reso
 
 void twr_adc_oversampling_set(twr_adc_channel_t channel, twr_adc_oversampling_t oversampling);
 
+//! @brief Begin conversion of set of channels in one DMA sequence (uses DMA channel 1)
+//! @param[in] channels Channels to convert (bitwise OR of twr_adc_scan_channel_t)
+//! @param[in] oversampling Oversampling applied to every channel of scan
+//! @return true On success
+//! @return false If ADC is busy or channel set is invalid
+
+bool twr_adc_scan(uint32_t channels, twr_adc_oversampling_t oversampling);
+
+//! @brief Set callback function called when scan is done
+//! @param[in] event_handler Function address
+//! @param[in] event_param Optional event parameter (can be NULL)
+
+void twr_adc_scan_set_event_handler(void (*event_handler)(twr_adc_event_t, void *), void *event_param);
+
+//! @brief Get result of last scan
+//! @param[in] channel ADC scan channel
+//! @param[out] result Pointer to variable where result (left aligned to 16 bits) will be stored
+//! @return true On success
+//! @return false If channel was not part of successful scan
+
+bool twr_adc_scan_get_value(twr_adc_scan_channel_t channel, uint16_t *result);
+
+//! @brief Get result of last scan in volts
+//! @param[in] channel ADC scan channel
+//! @param[out] result Pointer to variable where result in volts will be stored
+//! @return true On success
+//! @return false If channel was not part of successful scan or VDDA is unknown
+
+bool twr_adc_scan_get_voltage(twr_adc_scan_channel_t channel, float *result);
+
+//! @brief Get temperature of MCU from last scan
+//! @param[out] temperature Pointer to variable where temperature in degrees of Celsius will be stored
+//! @return true On success
+//! @return false If temperature sensor was not part of successful scan or VDDA is unknown
+
+bool twr_adc_scan_get_temperature(float *temperature);
+
 //! @}
 
 #endif // _TWR_ADC_H
@@ -0,0 +1,92 @@
+#ifndef _TWR_KV_H
+#define _TWR_KV_H
+
+#include <twr_common.h>
+
+//! @addtogroup twr_kv twr_kv
+//! @brief Log-structured key-value store in EEPROM
+//! @details Values are appended as CRC protected records, the newest record of each key wins. Region is split into two
+//!          halves, when the active half gets full the live records are compacted into the other one.
+//! @{
+
+//! @brief Number of keys (key has to be lower than this value)
+
+#ifndef TWR_KV_MAX_KEYS
+#define TWR_KV_MAX_KEYS 32
+#endif
+
+//! @brief Maximum length of value in bytes
+
+#define TWR_KV_MAX_LENGTH 255
+
+//! @brief Keys reserved for SDK
+
+enum
+{
+    //! @brief Radio peer devices
+    TWR_KV_KEY_RADIO_PEERS = 0,
+
+    //! @brief First key free for application use
+    TWR_KV_KEY_USER = 8
+
+};
+
+//! @brief Initialize key-value store and build index from EEPROM
+//! @details Call before twr_radio_init to keep radio peer devices in the store.
+//! @param[in] address EEPROM start address of the region (multiple of 4)
+//! @param[in] size Size of the region in bytes (multiple of 8)
+//! @return true On success
+//! @return false On invalid region or EEPROM write failure
+
+bool twr_kv_init(uint32_t address, size_t size);
+
+//! @brief Check if key-value store has been initialized
+//! @return true If initialized
+//! @return false If not initialized
+
+bool twr_kv_is_ready(void);
+
+//! @brief Store value
+//! @param[in] key Key
+//! @param[in] buffer Pointer to value
+//! @param[in] length Length of value in bytes (1 to TWR_KV_MAX_LENGTH)
+//! @return true On success
+//! @return false On failure
+
+bool twr_kv_set(uint8_t key, const void *buffer, size_t length);
+
+//! @brief Load value
+//! @param[in] key Key
+//! @param[out] buffer Pointer to destination buffer
+//! @param[in] length Size of destination buffer
+//! @return Length of value or 0 if key is not present or value does not fit into buffer
+
+size_t twr_kv_get(uint8_t key, void *buffer, size_t length);
+
+//! @brief Get length of stored value
+//! @param[in] key Key
+//! @return Length of value or 0 if key is not present
+
+size_t twr_kv_get_length(uint8_t key);
+
+//! @brief Remove value
+//! @param[in] key Key
+//! @return true On success
+//! @return false On failure
+
+bool twr_kv_remove(uint8_t key);
+
+//! @brief Rewrite live records into the other half of the region
+//! @return true On success
+//! @return false On failure
+
+bool twr_kv_compact(void);
+
+//! @brief Get number of free bytes in the active half
+//! @return Number of bytes
+
+size_t twr_kv_get_free(void);
+
+//! @}
+
+#endif // _TWR_KV_H
@@ -5,6 +5,7 @@
 #include <twr_button.h>
 #include <twr_led.h>
 #include <twr_spirit1.h>
+#include <twr_fixed.h>
 
 //! @addtogroup twr_radio twr_radio
 //! @brief Radio implementation
@@ -100,6 +101,13 @@ typedef enum
     TWR_RADIO_HEADER_PUB_VALUE_INT   = 0x1e,
 
     TWR_RADIO_HEADER_SUB_REG         = 0x20,
+    TWR_RADIO_HEADER_PUB_STORED      = 0x21,
+    TWR_RADIO_HEADER_PUB_COMPACT_REG = 0x22,
+    TWR_RADIO_HEADER_PUB_COMPACT_KEY = 0x23,
+    TWR_RADIO_HEADER_PUB_COMPACT     = 0x24,
+    TWR_RADIO_HEADER_OTA_BEGIN       = 0x25,
+    TWR_RADIO_HEADER_OTA_DATA        = 0x26,
+    TWR_RADIO_HEADER_OTA_STATUS      = 0x27,
 
     TWR_RADIO_HEADER_ACK             = 0xaa,
 
@@ -127,6 +135,30 @@ struct twr_radio_sub_t {
     void *param;
 };
 
+//! @brief Statistics of frames sent to peer, they drive number of retransmissions and ACK listen window
+
+typedef struct
+{
+    //! @brief Frames sent (delivery ratio is ack_count / tx_count)
+    uint32_t tx_count;
+
+    //! @brief Frames acknowledged
+    uint32_t ack_count;
+
+    //! @brief Retransmissions of all frames
+    uint32_t retransmit_count;
+
+    //! @brief Transmissions per acknowledged frame in 1/16, smoothed
+    uint16_t attempts;
+
+    //! @brief Time from end of transmission to ACK in milliseconds, smoothed
+    twr_tick_t ack_latency;
+
+    //! @brief RSSI of ACK in dBm, smoothed
+    int rssi;
+
+} twr_radio_link_t;
+
 typedef struct
 {
     uint64_t id;
@@ -134,6 +166,8 @@ typedef struct
     bool message_id_synced;
     twr_radio_mode_t mode;
     int rssi;
+    twr_radio_link_t link;
+    uint8_t downlink_pending;
 
 } twr_radio_peer_t;
 
@@ -188,12 +222,49 @@ void twr_radio_set_rx_timeout_for_sleeping_node(twr_tick_t timeout);
 
 twr_radio_peer_t *twr_radio_get_peer_device(uint64_t id);
 
+//! @brief Get statistics of frames sent to peer device
+//! @param[in] id Peer device ID
+//! @param[out] link Statistics
+//! @return true On success
+//! @return false If device is not a peer
+
+bool twr_radio_get_link(uint64_t id, twr_radio_link_t *link);
+
+//! @brief Get age of the received publish being decoded
+//! @return Age in seconds of publish replayed from twr_radio_store of the node, 0 for live publish
+
+uint32_t twr_radio_get_rx_age(void);
+
+//! @brief Enable uplink slots synchronized by gateway (gateway)
+//! @details Each ACK then carries RTC time of gateway, phase of the slot frame and slot of the node, which is its
+//!          index among peer devices. Node which received such ACK postpones its transmissions to its slot, does not
+//!          spread retransmissions with growing backoff and if sleeping, opens the receive window after ACK only when
+//!          gateway has a frame queued for it. Slot frame is slot length times number of peer devices. Node falls
+//!          back to random access when it has not been acknowledged for 15 minutes.
+//! @param[in] slot_length Slot length in milliseconds (up to 255, 0 disables)
+
+void twr_radio_set_tdma(twr_tick_t slot_length);
+
+//! @brief Check whether node transmits in slot assigned by gateway
+//! @return true If node is synchronized
+//! @return false If node uses random access
+
+bool twr_radio_is_tdma_synced(void);
+
+//! @brief Get RTC time of gateway extrapolated from last synchronization (node)
+//! @param[out] timestamp Timestamp in seconds
+//! @return true On success
+//! @return false If node is not synchronized
+
+bool twr_radio_get_tdma_timestamp(uint32_t *timestamp);
+
 uint8_t *twr_radio_id_to_buffer(uint64_t *id, uint8_t *buffer);
 uint8_t *twr_radio_bool_to_buffer(bool *value, uint8_t *buffer);
 uint8_t *twr_radio_int_to_buffer(int *value, uint8_t *buffer);
 uint8_t *twr_radio_uint16_to_buffer(uint16_t *value, uint8_t *buffer);
 uint8_t *twr_radio_uint32_to_buffer(uint32_t *value, uint8_t *buffer);
 uint8_t *twr_radio_float_to_buffer(float *value, uint8_t *buffer);
+uint8_t *twr_radio_fixed_to_buffer(twr_fixed_t *value, uint8_t *buffer);
 uint8_t *twr_radio_data_to_buffer(void *data, size_t length, uint8_t *buffer);
 uint8_t *twr_radio_id_from_buffer(uint8_t *buffer, uint64_t *id);
 uint8_t *twr_radio_bool_from_buffer(uint8_t *buffer, bool *value, bool **pointer);
@@ -205,6 +276,33 @@ uint8_t *twr_radio_data_from_buffer(uint8_t *buffer, void *data, size_t length);
 
 void twr_radio_init_pairing_button();
 
+//! @cond
+
+typedef struct
+{
+    bool (*is_ready)(void);
+    size_t (*get_backlog)(void);
+    bool (*put)(const void *buffer, size_t length);
+    size_t (*batch)(uint8_t *buffer, size_t size);
+    void (*batch_done)(void);
+    twr_tick_t (*get_interval)(bool online);
+
+} _twr_radio_store_hook_t;
+
+typedef struct
+{
+    size_t (*encode)(uint8_t *buffer, size_t length);
+    void (*ack)(const uint8_t *buffer, size_t length);
+    size_t (*tx_error)(uint8_t *buffer, size_t length);
+
+} _twr_radio_pub_compact_hook_t;
+
+void _twr_radio_set_ota_decode(void (*decode)(uint64_t *, uint8_t *, size_t));
+void _twr_radio_set_store_hook(const _twr_radio_store_hook_t *hook);
+void _twr_radio_set_pub_compact_hook(const _twr_radio_pub_compact_hook_t *hook);
+
+//! @endcond
+
 //! @}
 
 #endif // _TWR_RADIO_H
@@ -0,0 +1,349 @@
+#include <twr_profile.h>
+
+#ifdef TWR_PROFILE
+
+#include <twr_irq.h>
+#include <twr_log.h>
+#include <stm32l0xx_hal.h>
+
+// Wake-up counters of SysTick and of all NVIC interrupts
+#define _TWR_PROFILE_WAKEUP_SOURCES 33
+
+typedef struct
+{
+    bool on;
+    twr_tick_t since;
+    twr_tick_t total;
+
+} _twr_profile_interval_t;
+
+static struct
+{
+    twr_tick_t tick_reset;
+
+    twr_profile_task_t task[TWR_SCHEDULER_MAX_TASKS];
+    twr_scheduler_task_id_t task_id;
+    uint32_t task_start;
+
+    twr_tick_t sleep;
+    twr_tick_t deep_sleep;
+    uint32_t wakeup_count;
+    uint32_t wakeup[_TWR_PROFILE_WAKEUP_SOURCES];
+
+    _twr_profile_interval_t hsi16;
+    _twr_profile_interval_t pll;
+    uint32_t pll_start_count;
+    _twr_profile_interval_t blocked;
+
+    twr_profile_holder_t holder[TWR_PROFILE_MAX_HOLDERS];
+    int holder_current;
+
+} _twr_profile = { .holder_current = -1 };
+
+static uint32_t _twr_profile_get_microseconds(void);
+static void _twr_profile_interval_update(_twr_profile_interval_t *interval, bool on, twr_tick_t now);
+static twr_tick_t _twr_profile_interval_get(_twr_profile_interval_t *interval, twr_tick_t now);
+
+void twr_profile_reset(void)
+{
+    twr_irq_disable();
+
+    twr_tick_t now = twr_tick_get();
+
+    _twr_profile.tick_reset = now;
+
+    memset(_twr_profile.task, 0, sizeof(_twr_profile.task));
+    memset(_twr_profile.wakeup, 0, sizeof(_twr_profile.wakeup));
+    memset(_twr_profile.holder, 0, sizeof(_twr_profile.holder));
+
+    _twr_profile.sleep = 0;
+    _twr_profile.deep_sleep = 0;
+    _twr_profile.wakeup_count = 0;
+    _twr_profile.pll_start_count = 0;
+
+    // Clocks and semaphore which are on keep counting from now
+    _twr_profile.hsi16.since = now;
+    _twr_profile.hsi16.total = 0;
+    _twr_profile.pll.since = now;
+    _twr_profile.pll.total = 0;
+    _twr_profile.blocked.since = now;
+    _twr_profile.blocked.total = 0;
+
+    _twr_profile.holder_current = -1;
+
+    twr_irq_enable();
+}
+
+void twr_profile_sleep(void)
+{
+    twr_tick_t tick = twr_tick_get();
+
+    bool deep = (SCB->SCR & SCB_SCR_SLEEPDEEP_Msk) != 0;
+
+    // Pending interrupt wakes the core up even if masked, so the wake-up source can be read before it is serviced
+    twr_irq_disable();
+
+    twr_system_sleep();
+
+    uint32_t pending = NVIC->ISPR[0] & NVIC->ISER[0];
+    bool systick = (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) != 0;
+
+    twr_irq_enable();
+
+    // Tick is incremented by RTC interrupt serviced right now
+    tick = twr_tick_get() - tick;
+
+    if (deep)
+    {
+        _twr_profile.deep_sleep += tick;
+    }
+    else
+    {
+        _twr_profile.sleep += tick;
+    }
+
+    _twr_profile.wakeup_count++;
+
+    if (pending != 0)
+    {
+        int irq = 0;
+
+        // Lowest interrupt number is serviced first unless priorities say otherwise
+        while ((pending & (1UL << irq)) == 0)
+        {
+            irq++;
+        }
+
+        _twr_profile.wakeup[1 + irq]++;
+    }
+    else if (systick)
+    {
+        _twr_profile.wakeup[0]++;
+    }
+}
+
+bool twr_profile_get_task(twr_scheduler_task_id_t task_id, twr_profile_task_t *task)
+{
+    if ((task_id >= TWR_SCHEDULER_MAX_TASKS) || (_twr_profile.task[task_id].task == NULL))
+    {
+        return false;
+    }
+
+    *task = _twr_profile.task[task_id];
+
+    return true;
+}
+
+void twr_profile_get_system(twr_profile_system_t *system)
+{
+    twr_irq_disable();
+
+    twr_tick_t now = twr_tick_get();
+
+    system->elapsed = now - _twr_profile.tick_reset;
+    system->sleep = _twr_profile.sleep;
+    system->deep_sleep = _twr_profile.deep_sleep;
+    system->hsi16_on = _twr_profile_interval_get(&_twr_profile.hsi16, now);
+    system->pll_on = _twr_profile_interval_get(&_twr_profile.pll, now);
+    system->pll_start_count = _twr_profile.pll_start_count;
+    system->deep_sleep_blocked = _twr_profile_interval_get(&_twr_profile.blocked, now);
+    system->wakeup_count = _twr_profile.wakeup_count;
+
+    twr_irq_enable();
+}
+
+bool twr_profile_get_holder(int index, twr_profile_holder_t *holder)
+{
+    if ((index < 0) || (index >= TWR_PROFILE_MAX_HOLDERS) || (_twr_profile.holder[index].caller == NULL))
+    {
+        return false;
+    }
+
+    twr_irq_disable();
+
+    *holder = _twr_profile.holder[index];
+
+    if (index == _twr_profile.holder_current)
+    {
+        holder->blocked += twr_tick_get() - _twr_profile.blocked.since;
+    }
+
+    twr_irq_enable();
+
+    return true;
+}
+
+uint32_t twr_profile_get_wakeup_count(IRQn_Type irq)
+{
+    if ((irq < SysTick_IRQn) || (irq >= _TWR_PROFILE_WAKEUP_SOURCES - 1))
+    {
+        return 0;
+    }
+
+    return irq == SysTick_IRQn ? _twr_profile.wakeup[0] : _twr_profile.wakeup[1 + irq];
+}
+
+void twr_profile_log(void)
+{
+    twr_profile_system_t system;
+
+    twr_profile_get_system(&system);
+
+    twr_log_info("profile: elapsed=%lu sleep=%lu stop=%lu hsi16=%lu pll=%lu pll_starts=%lu blocked=%lu wakeups=%lu",
+            (unsigned long) system.elapsed, (unsigned long) system.sleep, (unsigned long) system.deep_sleep,
+            (unsigned long) system.hsi16_on, (unsigned long) system.pll_on, (unsigned long) system.pll_start_count,
+            (unsigned long) system.deep_sleep_blocked, (unsigned long) system.wakeup_count);
+
+    for (twr_scheduler_task_id_t i = 0; i < TWR_SCHEDULER_MAX_TASKS; i++)
+    {
+        twr_profile_task_t task;
+
+        if (twr_profile_get_task(i, &task))
+        {
+            twr_log_info("profile: task %u 0x%lx calls=%lu run=%lu ms max=%lu us", (unsigned) i, (unsigned long) (uintptr_t) task.task,
+                    (unsigned long) task.call_count, (unsigned long) (task.run_time / 1000), (unsigned long) task.run_time_max);
+        }
+    }
+
+    for (int i = 0; i < TWR_PROFILE_MAX_HOLDERS; i++)
+    {
+        twr_profile_holder_t holder;
+
+        if (twr_profile_get_holder(i, &holder))
+        {
+            twr_log_info("profile: holder %p count=%lu blocked=%lu", holder.caller,
+                    (unsigned long) holder.count, (unsigned long) holder.blocked);
+        }
+    }
+
+    for (int i = 0; i < _TWR_PROFILE_WAKEUP_SOURCES; i++)
+    {
+        if (_twr_profile.wakeup[i] != 0)
+        {
+            twr_log_info("profile: wakeup irq=%d count=%lu", i - 1, (unsigned long) _twr_profile.wakeup[i]);
+        }
+    }
+}
+
+void _twr_profile_task_begin(twr_scheduler_task_id_t task_id, void (*task)(void *))
+{
+    twr_profile_task_t *profile = &_twr_profile.task[task_id];
+
+    if (profile->task != task)
+    {
+        // Slot has been reused by another task
+        memset(profile, 0, sizeof(*profile));
+
+        profile->task = task;
+    }
+
+    _twr_profile.task_id = task_id;
+    _twr_profile.task_start = _twr_profile_get_microseconds();
+}
+
+void _twr_profile_task_end(void)
+{
+    uint32_t duration = _twr_profile_get_microseconds() - _twr_profile.task_start;
+
+    twr_profile_task_t *profile = &_twr_profile.task[_twr_profile.task_id];
+
+    profile->call_count++;
+    profile->run_time += duration;
+
+    if (profile->run_time_max < duration)
+    {
+        profile->run_time_max = duration;
+    }
+}
+
+void _twr_profile_clock_hsi16(bool on)
+{
+    _twr_profile_interval_update(&_twr_profile.hsi16, on, twr_tick_get());
+}
+
+void _twr_profile_clock_pll(bool on)
+{
+    if (on && !_twr_profile.pll.on)
+    {
+        _twr_profile.pll_start_count++;
+    }
+
+    _twr_profile_interval_update(&_twr_profile.pll, on, twr_tick_get());
+}
+
+void _twr_profile_deep_sleep_blocked(const void *caller)
+{
+    twr_tick_t now = twr_tick_get();
+
+    _twr_profile_interval_update(&_twr_profile.blocked, true, now);
+
+    _twr_profile.holder_current = -1;
+
+    for (int i = 0; i < TWR_PROFILE_MAX_HOLDERS; i++)
+    {
+        if ((_twr_profile.holder[i].caller == caller) || (_twr_profile.holder[i].caller == NULL))
+        {
+            _twr_profile.holder[i].caller = caller;
+            _twr_profile.holder[i].count++;
+
+            _twr_profile.holder_current = i;
+
+            break;
+        }
+    }
+}
+
+void _twr_profile_deep_sleep_unblocked(void)
+{
+    twr_tick_t now = twr_tick_get();
+
+    if (_twr_profile.holder_current >= 0)
+    {
+        _twr_profile.holder[_twr_profile.holder_current].blocked += now - _twr_profile.blocked.since;
+
+        _twr_profile.holder_current = -1;
+    }
+
+    _twr_profile_interval_update(&_twr_profile.blocked, false, now);
+}
+
+static uint32_t _twr_profile_get_microseconds(void)
+{
+    uint32_t tick;
+    uint32_t value;
+
+    // SysTick counts down from LOAD to zero every millisecond at any system clock
+    do
+    {
+        tick = HAL_GetTick();
+        value = SysTick->VAL;
+
+    } while (tick != HAL_GetTick());
+
+    uint32_t load = SysTick->LOAD + 1;
+
+    return tick * 1000 + ((load - 1 - value) * 1000) / load;
+}
+
+static void _twr_profile_interval_update(_twr_profile_interval_t *interval, bool on, twr_tick_t now)
+{
+    if (interval->on == on)
+    {
+        return;
+    }
+
+    if (!on)
+    {
+        interval->total += now - interval->since;
+    }
+
+    interval->on = on;
+    interval->since = now;
+}
+
+static twr_tick_t _twr_profile_interval_get(_twr_profile_interval_t *interval, twr_tick_t now)
+{
+    return interval->on ? interval->total + now - interval->since : interval->total;
+}
+
+#endif
@@ -0,0 +1,869 @@
+#include <twr_radio_ota.h>
+#include <twr_scheduler.h>
+#include <twr_sha256.h>
+#include <twr_eeprom.h>
+#include <twr_irq.h>
+#include <twr_timer.h>
+#include <stm32l0xx.h>
+
+#define _TWR_RADIO_OTA_FLASH_BASE 0x08000000
+#define _TWR_RADIO_OTA_PAGE_SIZE 128
+#define _TWR_RADIO_OTA_HALF_PAGE_SIZE 64
+#define _TWR_RADIO_OTA_FLASH_SR_ERROR (FLASH_SR_WRPERR | FLASH_SR_PGAERR | FLASH_SR_SIZERR | FLASH_SR_OPTVERR | FLASH_SR_RDERR | FLASH_SR_NOTZEROERR | FLASH_SR_FWWERR)
+#define _TWR_RADIO_OTA_APPLY_STEP 1024
+#define _TWR_RADIO_OTA_VERIFY_STEP 4096
+#define _TWR_RADIO_OTA_INSTALL_DELAY 2000
+#define _TWR_RADIO_OTA_POWER_RETRY (60 * 1000)
+#define _TWR_RADIO_OTA_PVD_SETTLE_TIME 100
+#define _TWR_RADIO_OTA_COPIER_MAGIC 0x4f544143
+#define _TWR_RADIO_OTA_COPIER_HEADER_SIZE 8
+#define _TWR_RADIO_OTA_COPIER_ATTEMPTS 3
+#define _TWR_RADIO_OTA_OP_COPY 0x00
+#define _TWR_RADIO_OTA_OP_LITERAL 0x01
+
+// Functions which run while flash is being programmed, placed in .data so startup copies them to RAM
+#define _TWR_RADIO_OTA_RAM_FUNCTION __attribute__((section(".data._twr_radio_ota_ram_function"), noinline, long_call))
+
+// Copier is copied as is into flash after staging region, it has to be position independent and must not call anything
+#define _TWR_RADIO_OTA_COPIER_FUNCTION __attribute__((section(".data._twr_radio_ota_copier"), noinline, long_call))
+
+typedef enum
+{
+    _TWR_RADIO_OTA_STATE_IDLE = 0,
+    _TWR_RADIO_OTA_STATE_APPLY = 1,
+    _TWR_RADIO_OTA_STATE_VERIFY = 2,
+    _TWR_RADIO_OTA_STATE_INSTALL = 3
+
+} _twr_radio_ota_state_t;
+
+typedef enum
+{
+    _TWR_RADIO_OTA_PARSE_OP = 0,
+    _TWR_RADIO_OTA_PARSE_LENGTH = 1,
+    _TWR_RADIO_OTA_PARSE_SOURCE = 2,
+    _TWR_RADIO_OTA_PARSE_DATA = 3
+
+} _twr_radio_ota_parse_t;
+
+// Running image ends with initial values of .data
+extern uint32_t _sidata;
+extern uint32_t _sdata;
+extern uint32_t _edata;
+
+static struct
+{
+    _twr_radio_ota_state_t state;
+    twr_radio_ota_manifest_t manifest;
+    uint32_t received;
+    uint8_t window[TWR_RADIO_OTA_WINDOW_SIZE];
+    size_t window_length;
+    size_t window_position;
+    bool report;
+
+    _twr_radio_ota_parse_t parse;
+    uint8_t op;
+    uint32_t varint;
+    int shift;
+    uint32_t length;
+    uint32_t source;
+
+    uint32_t output;
+    uint32_t half_page[_TWR_RADIO_OTA_HALF_PAGE_SIZE / sizeof(uint32_t)];
+
+    twr_sha256_t sha256;
+    uint32_t verified;
+
+    twr_scheduler_task_id_t task_id;
+
+} _twr_radio_ota;
+
+static void _twr_radio_ota_task(void *param);
+static twr_radio_ota_status_t _twr_radio_ota_apply(void);
+static twr_radio_ota_status_t _twr_radio_ota_verify(void);
+static bool _twr_radio_ota_parse_varint(uint8_t data);
+static bool _twr_radio_ota_write(const uint8_t *buffer, size_t length);
+static bool _twr_radio_ota_flush(void);
+static uint32_t _twr_radio_ota_get_image_size(void);
+static void _twr_radio_ota_send_status(twr_radio_ota_status_t status);
+static void _twr_radio_ota_decode_begin(uint8_t *buffer);
+static void _twr_radio_ota_decode_data(uint8_t *buffer, size_t length);
+static void _twr_radio_ota_flash_unlock(void);
+static void _twr_radio_ota_flash_lock(void);
+static bool _twr_radio_ota_is_supply_ok(void);
+static bool _twr_radio_ota_flash_erase_page(uint32_t address) _TWR_RADIO_OTA_RAM_FUNCTION;
+static bool _twr_radio_ota_flash_program_half_page(uint32_t address, const uint32_t *buffer) _TWR_RADIO_OTA_RAM_FUNCTION;
+static void _twr_radio_ota_install(uint32_t length) _TWR_RADIO_OTA_RAM_FUNCTION;
+static void _twr_radio_ota_copier(void) _TWR_RADIO_OTA_COPIER_FUNCTION;
+
+__attribute__((weak)) void twr_radio_ota_on_status(uint64_t *id, twr_radio_ota_status_t status, uint32_t offset) { (void) id; (void) status; (void) offset; }
+
+void twr_radio_ota_init(void)
+{
+    memset(&_twr_radio_ota, 0, sizeof(_twr_radio_ota));
+
+    _twr_radio_ota.task_id = twr_scheduler_register(_twr_radio_ota_task, NULL, TWR_TICK_INFINITY);
+
+    _twr_radio_set_ota_decode(_twr_radio_ota_decode);
+}
+
+bool twr_radio_ota_begin(uint64_t *id, const twr_radio_ota_manifest_t *manifest)
+{
+    uint8_t buffer[1 + TWR_RADIO_ID_SIZE + sizeof(uint32_t) * 2 + sizeof(manifest->sha256)];
+
+    buffer[0] = TWR_RADIO_HEADER_OTA_BEGIN;
+
+    uint8_t *pbuffer = twr_radio_id_to_buffer(id, buffer + 1);
+
+    pbuffer = twr_radio_data_to_buffer((void *) &manifest->image_size, sizeof(manifest->image_size), pbuffer);
+    pbuffer = twr_radio_data_to_buffer((void *) &manifest->patch_size, sizeof(manifest->patch_size), pbuffer);
+
+    memcpy(pbuffer, manifest->sha256, sizeof(manifest->sha256));
+
+    return twr_radio_pub_queue_put(buffer, sizeof(buffer));
+}
+
+bool twr_radio_ota_data(uint64_t *id, uint32_t offset, const void *buffer, size_t length)
+{
+    uint8_t qbuffer[1 + TWR_RADIO_ID_SIZE + sizeof(offset) + TWR_RADIO_OTA_CHUNK_SIZE];
+
+    if (length > TWR_RADIO_OTA_CHUNK_SIZE)
+    {
+        return false;
+    }
+
+    qbuffer[0] = TWR_RADIO_HEADER_OTA_DATA;
+
+    uint8_t *pbuffer = twr_radio_id_to_buffer(id, qbuffer + 1);
+
+    pbuffer = twr_radio_uint32_to_buffer(&offset, pbuffer);
+
+    memcpy(pbuffer, buffer, length);
+
+    return twr_radio_pub_queue_put(qbuffer, 1 + TWR_RADIO_ID_SIZE + sizeof(offset) + length);
+}
+
+void _twr_radio_ota_decode(uint64_t *id, uint8_t *buffer, size_t length)
+{
+    if ((buffer[0] == TWR_RADIO_HEADER_OTA_STATUS) && (length == 1 + 1 + sizeof(uint32_t)))
+    {
+        uint32_t offset;
+
+        twr_radio_data_from_buffer(buffer + 2, &offset, sizeof(offset));
+
+        twr_radio_ota_on_status(id, (twr_radio_ota_status_t) buffer[1], offset);
+    }
+    else if ((buffer[0] == TWR_RADIO_HEADER_OTA_BEGIN) && (length == 1 + TWR_RADIO_ID_SIZE + sizeof(uint32_t) * 2 + 32))
+    {
+        _twr_radio_ota_decode_begin(buffer + 1 + TWR_RADIO_ID_SIZE);
+    }
+    else if ((buffer[0] == TWR_RADIO_HEADER_OTA_DATA) && (length > 1 + TWR_RADIO_ID_SIZE + sizeof(uint32_t)))
+    {
+        _twr_radio_ota_decode_data(buffer + 1 + TWR_RADIO_ID_SIZE, length - 1 - TWR_RADIO_ID_SIZE);
+    }
+}
+
+static void _twr_radio_ota_decode_begin(uint8_t *buffer)
+{
+    twr_radio_ota_manifest_t manifest;
+
+    buffer = twr_radio_data_from_buffer(buffer, &manifest.image_size, sizeof(manifest.image_size));
+    buffer = twr_radio_data_from_buffer(buffer, &manifest.patch_size, sizeof(manifest.patch_size));
+
+    memcpy(manifest.sha256, buffer, sizeof(manifest.sha256));
+
+    twr_radio_listen(TWR_RADIO_OTA_LISTEN_TIMEOUT);
+
+    if ((_twr_radio_ota.state != _TWR_RADIO_OTA_STATE_IDLE) && (memcmp(&manifest, &_twr_radio_ota.manifest, sizeof(manifest)) == 0))
+    {
+        // Same update again, gateway learns where to continue
+        _twr_radio_ota.report = true;
+
+        twr_scheduler_plan_now(_twr_radio_ota.task_id);
+
+        return;
+    }
+
+    if (_twr_radio_ota.state == _TWR_RADIO_OTA_STATE_INSTALL)
+    {
+        return;
+    }
+
+    _twr_radio_ota.state = _TWR_RADIO_OTA_STATE_IDLE;
+    _twr_radio_ota.manifest = manifest;
+    _twr_radio_ota.received = 0;
+
+    if ((manifest.image_size == 0) || (manifest.image_size > TWR_RADIO_OTA_STAGING_SIZE) ||
+        (_twr_radio_ota_get_image_size() > TWR_RADIO_OTA_STAGING_ADDRESS - _TWR_RADIO_OTA_FLASH_BASE))
+    {
+        _twr_radio_ota_send_status(TWR_RADIO_OTA_STATUS_ERROR_SIZE);
+
+        return;
+    }
+
+    _twr_radio_ota.window_length = 0;
+    _twr_radio_ota.window_position = 0;
+    _twr_radio_ota.parse = _TWR_RADIO_OTA_PARSE_OP;
+    _twr_radio_ota.output = 0;
+    _twr_radio_ota.report = true;
+
+    _twr_radio_ota.state = _TWR_RADIO_OTA_STATE_APPLY;
+
+    twr_scheduler_plan_now(_twr_radio_ota.task_id);
+}
+
+static void _twr_radio_ota_decode_data(uint8_t *buffer, size_t length)
+{
+    uint32_t offset;
+
+    buffer = twr_radio_data_from_buffer(buffer, &offset, sizeof(offset));
+
+    length -= sizeof(offset);
+
+    twr_radio_listen(TWR_RADIO_OTA_LISTEN_TIMEOUT);
+
+    if (_twr_radio_ota.state != _TWR_RADIO_OTA_STATE_APPLY)
+    {
+        if (_twr_radio_ota.state == _TWR_RADIO_OTA_STATE_IDLE)
+        {
+            _twr_radio_ota_send_status(TWR_RADIO_OTA_STATUS_ERROR_STATE);
+        }
+
+        return;
+    }
+
+    if ((offset != _twr_radio_ota.received) || (_twr_radio_ota.window_length + length > sizeof(_twr_radio_ota.window)) ||
+        (offset + length > _twr_radio_ota.manifest.patch_size))
+    {
+        // Lost chunk or lost status, gateway has to go back to offset reported after current window
+        _twr_radio_ota.report = true;
+
+        twr_scheduler_plan_now(_twr_radio_ota.task_id);
+
+        return;
+    }
+
+    memcpy(_twr_radio_ota.window + _twr_radio_ota.window_length, buffer, length);
+
+    _twr_radio_ota.window_length += length;
+
+    _twr_radio_ota.received += length;
+
+    twr_scheduler_plan_now(_twr_radio_ota.task_id);
+}
+
+static void _twr_radio_ota_task(void *param)
+{
+    (void) param;
+
+    twr_radio_ota_status_t status = TWR_RADIO_OTA_STATUS_READY;
+
+    if (twr_eeprom_is_busy())
+    {
+        // Both share the programming interface of NVM
+        twr_scheduler_plan_current_from_now(10);
+
+        return;
+    }
+
+    switch (_twr_radio_ota.state)
+    {
+        case _TWR_RADIO_OTA_STATE_APPLY:
+        {
+            status = _twr_radio_ota_apply();
+
+            break;
+        }
+        case _TWR_RADIO_OTA_STATE_VERIFY:
+        {
+            status = _twr_radio_ota_verify();
+
+            break;
+        }
+        case _TWR_RADIO_OTA_STATE_INSTALL:
+        {
+            if (!_twr_radio_ota_is_supply_ok())
+            {
+                // Verified image stays in staging region, install waits for supply to recover
+                _twr_radio_ota_send_status(TWR_RADIO_OTA_STATUS_ERROR_POWER);
+
+                twr_scheduler_plan_current_from_now(_TWR_RADIO_OTA_POWER_RETRY);
+
+                return;
+            }
+
+            _twr_radio_ota_flash_unlock();
+
+            _twr_radio_ota_install(_twr_radio_ota.manifest.image_size);
+
+            return;
+        }
+        case _TWR_RADIO_OTA_STATE_IDLE:
+        default:
+        {
+            return;
+        }
+    }
+
+    if (status != TWR_RADIO_OTA_STATUS_READY)
+    {
+        _twr_radio_ota.state = _TWR_RADIO_OTA_STATE_IDLE;
+
+        _twr_radio_ota_send_status(status);
+    }
+}
+
+static twr_radio_ota_status_t _twr_radio_ota_apply(void)
+{
+    size_t budget = _TWR_RADIO_OTA_APPLY_STEP;
+
+    while (budget != 0)
+    {
+        if (_twr_radio_ota.parse == _TWR_RADIO_OTA_PARSE_DATA)
+        {
+            size_t length = _twr_radio_ota.length < budget ? _twr_radio_ota.length : budget;
+
+            if (_twr_radio_ota.op == _TWR_RADIO_OTA_OP_COPY)
+            {
+                if (!_twr_radio_ota_write((const uint8_t *) _TWR_RADIO_OTA_FLASH_BASE + _twr_radio_ota.source, length))
+                {
+                    return TWR_RADIO_OTA_STATUS_ERROR_FLASH;
+                }
+
+                _twr_radio_ota.source += length;
+            }
+            else
+            {
+                size_t available = _twr_radio_ota.window_length - _twr_radio_ota.window_position;
+
+                if (length > available)
+                {
+                    length = available;
+                }
+
+                if (length == 0)
+                {
+                    break;
+                }
+
+                if (!_twr_radio_ota_write(_twr_radio_ota.window + _twr_radio_ota.window_position, length))
+                {
+                    return TWR_RADIO_OTA_STATUS_ERROR_FLASH;
+                }
+
+                _twr_radio_ota.window_position += length;
+            }
+
+            _twr_radio_ota.length -= length;
+
+            budget -= length;
+
+            if (_twr_radio_ota.length == 0)
+            {
+                _twr_radio_ota.parse = _TWR_RADIO_OTA_PARSE_OP;
+            }
+
+            continue;
+        }
+
+        if (_twr_radio_ota.window_position == _twr_radio_ota.window_length)
+        {
+            break;
+        }
+
+        uint8_t data = _twr_radio_ota.window[_twr_radio_ota.window_position++];
+
+        budget--;
+
+        if (_twr_radio_ota.parse == _TWR_RADIO_OTA_PARSE_OP)
+        {
+            if ((data != _TWR_RADIO_OTA_OP_COPY) && (data != _TWR_RADIO_OTA_OP_LITERAL))
+            {
+                return TWR_RADIO_OTA_STATUS_ERROR_PATCH;
+            }
+
+            _twr_radio_ota.op = data;
+            _twr_radio_ota.varint = 0;
+            _twr_radio_ota.shift = 0;
+            _twr_radio_ota.parse = _TWR_RADIO_OTA_PARSE_LENGTH;
+        }
+        else if (!_twr_radio_ota_parse_varint(data))
+        {
+            return TWR_RADIO_OTA_STATUS_ERROR_PATCH;
+        }
+    }
+
+    if (budget == 0)
+    {
+        twr_scheduler_plan_current_now();
+
+        return TWR_RADIO_OTA_STATUS_READY;
+    }
+
+    if (_twr_radio_ota.received == _twr_radio_ota.manifest.patch_size)
+    {
+        if ((_twr_radio_ota.parse != _TWR_RADIO_OTA_PARSE_OP) || (_twr_radio_ota.output != _twr_radio_ota.manifest.image_size))
+        {
+            return TWR_RADIO_OTA_STATUS_ERROR_PATCH;
+        }
+
+        if (!_twr_radio_ota_flush())
+        {
+            return TWR_RADIO_OTA_STATUS_ERROR_FLASH;
+        }
+
+        twr_sha256_init(&_twr_radio_ota.sha256);
+
+        _twr_radio_ota.verified = 0;
+
+        _twr_radio_ota.state = _TWR_RADIO_OTA_STATE_VERIFY;
+
+        twr_scheduler_plan_current_now();
+
+        return TWR_RADIO_OTA_STATUS_READY;
+    }
+
+    // Status is sent once the window is applied and no further chunk would fit, or to resynchronize gateway
+    if (_twr_radio_ota.report || (_twr_radio_ota.window_length > sizeof(_twr_radio_ota.window) - TWR_RADIO_OTA_CHUNK_SIZE))
+    {
+        _twr_radio_ota.window_length = 0;
+        _twr_radio_ota.window_position = 0;
+        _twr_radio_ota.report = false;
+
+        _twr_radio_ota_send_status(TWR_RADIO_OTA_STATUS_READY);
+    }
+
+    return TWR_RADIO_OTA_STATUS_READY;
+}
+
+static twr_radio_ota_status_t _twr_radio_ota_verify(void)
+{
+    uint32_t length = _twr_radio_ota.manifest.image_size - _twr_radio_ota.verified;
+
+    if (length > _TWR_RADIO_OTA_VERIFY_STEP)
+    {
+        length = _TWR_RADIO_OTA_VERIFY_STEP;
+    }
+
+    twr_sha256_update(&_twr_radio_ota.sha256, (const uint8_t *) TWR_RADIO_OTA_STAGING_ADDRESS + _twr_radio_ota.verified, length);
+
+    _twr_radio_ota.verified += length;
+
+    if (_twr_radio_ota.verified < _twr_radio_ota.manifest.image_size)
+    {
+        twr_scheduler_plan_current_now();
+
+        return TWR_RADIO_OTA_STATUS_READY;
+    }
+
+    uint8_t sha256[32];
+
+    twr_sha256_final(&_twr_radio_ota.sha256, sha256, false);
+
+    if (memcmp(sha256, _twr_radio_ota.manifest.sha256, sizeof(sha256)) != 0)
+    {
+        return TWR_RADIO_OTA_STATUS_ERROR_VERIFY;
+    }
+
+    _twr_radio_ota_send_status(TWR_RADIO_OTA_STATUS_DONE);
+
+    // Give the status time to reach gateway
+    _twr_radio_ota.state = _TWR_RADIO_OTA_STATE_INSTALL;
+
+    twr_scheduler_plan_current_from_now(_TWR_RADIO_OTA_INSTALL_DELAY);
+
+    return TWR_RADIO_OTA_STATUS_READY;
+}
+
+static bool _twr_radio_ota_parse_varint(uint8_t data)
+{
+    if (_twr_radio_ota.shift > 28)
+    {
+        return false;
+    }
+
+    _twr_radio_ota.varint |= (uint32_t) (data & 0x7f) << _twr_radio_ota.shift;
+    _twr_radio_ota.shift += 7;
+
+    if ((data & 0x80) != 0)
+    {
+        return true;
+    }
+
+    uint32_t value = _twr_radio_ota.varint;
+
+    _twr_radio_ota.varint = 0;
+    _twr_radio_ota.shift = 0;
+
+    if (_twr_radio_ota.parse == _TWR_RADIO_OTA_PARSE_LENGTH)
+    {
+        if ((value == 0) || (value > _twr_radio_ota.manifest.image_size - _twr_radio_ota.output))
+        {
+            return false;
+        }
+
+        _twr_radio_ota.length = value;
+
+        _twr_radio_ota.parse = _twr_radio_ota.op == _TWR_RADIO_OTA_OP_COPY ? _TWR_RADIO_OTA_PARSE_SOURCE : _TWR_RADIO_OTA_PARSE_DATA;
+
+        return true;
+    }
+
+    // Source is relative to output offset, zig-zag encoded
+    int32_t delta = (int32_t) (value >> 1) ^ -(int32_t) (value & 1);
+
+    uint32_t source = _twr_radio_ota.output + delta;
+
+    if ((source > _twr_radio_ota_get_image_size()) || (_twr_radio_ota.length > _twr_radio_ota_get_image_size() - source))
+    {
+        return false;
+    }
+
+    _twr_radio_ota.source = source;
+
+    _twr_radio_ota.parse = _TWR_RADIO_OTA_PARSE_DATA;
+
+    return true;
+}
+
+static bool _twr_radio_ota_write(const uint8_t *buffer, size_t length)
+{
+    while (length != 0)
+    {
+        size_t offset = _twr_radio_ota.output % _TWR_RADIO_OTA_HALF_PAGE_SIZE;
+        size_t chunk = _TWR_RADIO_OTA_HALF_PAGE_SIZE - offset;
+
+        if (chunk > length)
+        {
+            chunk = length;
+        }
+
+        memcpy((uint8_t *) _twr_radio_ota.half_page + offset, buffer, chunk);
+
+        _twr_radio_ota.output += chunk;
+
+        buffer += chunk;
+
+        length -= chunk;
+
+        if ((_twr_radio_ota.output % _TWR_RADIO_OTA_HALF_PAGE_SIZE == 0) && !_twr_radio_ota_flush())
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static bool _twr_radio_ota_flush(void)
+{
+    size_t offset = _twr_radio_ota.output % _TWR_RADIO_OTA_HALF_PAGE_SIZE;
+    uint32_t address = TWR_RADIO_OTA_STAGING_ADDRESS + _twr_radio_ota.output - offset;
+
+    if (offset != 0)
+    {
+        // Last half page, tail stays erased
+        memset((uint8_t *) _twr_radio_ota.half_page + offset, 0xff, _TWR_RADIO_OTA_HALF_PAGE_SIZE - offset);
+    }
+    else
+    {
+        address -= _TWR_RADIO_OTA_HALF_PAGE_SIZE;
+    }
+
+    _twr_radio_ota_flash_unlock();
+
+    bool ok = true;
+
+    if ((address % _TWR_RADIO_OTA_PAGE_SIZE) == 0)
+    {
+        ok = _twr_radio_ota_flash_erase_page(address);
+    }
+
+    if (ok)
+    {
+        twr_irq_disable();
+
+        ok = _twr_radio_ota_flash_program_half_page(address, _twr_radio_ota.half_page);
+
+        twr_irq_enable();
+    }
+
+    _twr_radio_ota_flash_lock();
+
+    return ok;
+}
+
+static uint32_t _twr_radio_ota_get_image_size(void)
+{
+    return (uint32_t) &_sidata + ((uint32_t) &_edata - (uint32_t) &_sdata) - _TWR_RADIO_OTA_FLASH_BASE;
+}
+
+static void _twr_radio_ota_send_status(twr_radio_ota_status_t status)
+{
+    uint8_t buffer[1 + 1 + sizeof(uint32_t)];
+
+    buffer[0] = TWR_RADIO_HEADER_OTA_STATUS;
+    buffer[1] = status;
+
+    twr_radio_uint32_to_buffer(&_twr_radio_ota.received, buffer + 2);
+
+    twr_radio_pub_queue_put(buffer, sizeof(buffer));
+}
+
+static void _twr_radio_ota_flash_unlock(void)
+{
+    twr_irq_disable();
+
+    if ((FLASH->PECR & FLASH_PECR_PELOCK) != 0)
+    {
+        FLASH->PEKEYR = FLASH_PEKEY1;
+        FLASH->PEKEYR = FLASH_PEKEY2;
+    }
+
+    if ((FLASH->PECR & FLASH_PECR_PRGLOCK) != 0)
+    {
+        FLASH->PRGKEYR = FLASH_PRGKEY1;
+        FLASH->PRGKEYR = FLASH_PRGKEY2;
+    }
+
+    twr_irq_enable();
+}
+
+static void _twr_radio_ota_flash_lock(void)
+{
+    twr_irq_disable();
+
+    FLASH->PECR |= FLASH_PECR_PRGLOCK;
+    FLASH->PECR |= FLASH_PECR_PELOCK;
+
+    twr_irq_enable();
+}
+
+static bool _twr_radio_ota_is_supply_ok(void)
+{
+    // Programmable voltage detector compares supply with threshold without need of ADC
+    twr_irq_disable();
+
+    uint32_t cr = PWR->CR;
+
+    PWR->CR = (cr & ~PWR_CR_PLS_Msk) | ((TWR_RADIO_OTA_INSTALL_PVD_LEVEL << PWR_CR_PLS_Pos) & PWR_CR_PLS_Msk) | PWR_CR_PVDE;
+
+    twr_irq_enable();
+
+    twr_timer_start();
+    twr_timer_delay(_TWR_RADIO_OTA_PVD_SETTLE_TIME);
+    twr_timer_stop();
+
+    // Output is set while supply is below threshold
+    bool ok = (PWR->CSR & PWR_CSR_PVDO) == 0;
+
+    twr_irq_disable();
+
+    PWR->CR = (PWR->CR & ~(PWR_CR_PLS_Msk | PWR_CR_PVDE)) | (cr & (PWR_CR_PLS_Msk | PWR_CR_PVDE));
+
+    twr_irq_enable();
+
+    return ok;
+}
+
+static bool _twr_radio_ota_flash_erase_page(uint32_t address)
+{
+    FLASH->SR = _TWR_RADIO_OTA_FLASH_SR_ERROR;
+
+    FLASH->PECR |= FLASH_PECR_ERASE | FLASH_PECR_PROG;
+
+    *(__IO uint32_t *) address = 0;
+
+    while ((FLASH->SR & FLASH_SR_BSY) != 0)
+    {
+        continue;
+    }
+
+    FLASH->PECR &= ~(FLASH_PECR_ERASE | FLASH_PECR_PROG);
+
+    return (FLASH->SR & _TWR_RADIO_OTA_FLASH_SR_ERROR) == 0;
+}
+
+static bool _twr_radio_ota_flash_program_half_page(uint32_t address, const uint32_t *buffer)
+{
+    FLASH->SR = _TWR_RADIO_OTA_FLASH_SR_ERROR;
+
+    FLASH->PECR |= FLASH_PECR_FPRG | FLASH_PECR_PROG;
+
+    // Interrupts are disabled by caller, no other access to flash may come between the 16 words
+    for (int i = 0; i < _TWR_RADIO_OTA_HALF_PAGE_SIZE / 4; i++)
+    {
+        *(__IO uint32_t *) address = buffer[i];
+    }
+
+    while ((FLASH->SR & FLASH_SR_BSY) != 0)
+    {
+        continue;
+    }
+
+    FLASH->PECR &= ~(FLASH_PECR_FPRG | FLASH_PECR_PROG);
+
+    return (FLASH->SR & _TWR_RADIO_OTA_FLASH_SR_ERROR) == 0;
+}
+
+static void _twr_radio_ota_install(uint32_t length)
+{
+    uint32_t half_page[_TWR_RADIO_OTA_HALF_PAGE_SIZE / sizeof(uint32_t)];
+    const uint32_t *copier = (const uint32_t *) ((uint32_t) _twr_radio_ota_copier & ~1UL);
+    uint32_t entry = (TWR_RADIO_OTA_COPIER_ADDRESS + _TWR_RADIO_OTA_COPIER_HEADER_SIZE) | 1;
+
+    __disable_irq();
+
+    // Copier goes to the second bank which is not touched by install, header tells it the length of image
+    for (uint32_t offset = 0; offset < TWR_RADIO_OTA_COPIER_SIZE; offset += _TWR_RADIO_OTA_PAGE_SIZE)
+    {
+        _twr_radio_ota_flash_erase_page(TWR_RADIO_OTA_COPIER_ADDRESS + offset);
+    }
+
+    for (uint32_t offset = 0; offset < TWR_RADIO_OTA_COPIER_SIZE; offset += _TWR_RADIO_OTA_HALF_PAGE_SIZE)
+    {
+        for (size_t i = 0; i < sizeof(half_page) / sizeof(uint32_t); i++)
+        {
+            uint32_t position = offset / sizeof(uint32_t) + i;
+
+            if (position == 0)
+            {
+                half_page[i] = _TWR_RADIO_OTA_COPIER_MAGIC;
+            }
+            else if (position == 1)
+            {
+                half_page[i] = length;
+            }
+            else
+            {
+                half_page[i] = copier[position - _TWR_RADIO_OTA_COPIER_HEADER_SIZE / sizeof(uint32_t)];
+            }
+        }
+
+        _twr_radio_ota_flash_program_half_page(TWR_RADIO_OTA_COPIER_ADDRESS + offset, half_page);
+    }
+
+    // First page of running image becomes boot stub, initial stack pointer and every vector lead to copier, so reset
+    // at any point of install resumes it; this page is written back last by copier
+    uint32_t stack = *(const uint32_t *) _TWR_RADIO_OTA_FLASH_BASE;
+
+    _twr_radio_ota_flash_erase_page(_TWR_RADIO_OTA_FLASH_BASE);
+
+    for (uint32_t half = 0; half < _TWR_RADIO_OTA_PAGE_SIZE; half += _TWR_RADIO_OTA_HALF_PAGE_SIZE)
+    {
+        for (size_t i = 0; i < sizeof(half_page) / sizeof(uint32_t); i++)
+        {
+            half_page[i] = ((half == 0) && (i == 0)) ? stack : entry;
+        }
+
+        _twr_radio_ota_flash_program_half_page(_TWR_RADIO_OTA_FLASH_BASE + half, half_page);
+    }
+
+    __DSB();
+
+    ((void (*)(void)) entry)();
+}
+
+static void _twr_radio_ota_copier(void)
+{
+    const __IO uint32_t *header = (const __IO uint32_t *) TWR_RADIO_OTA_COPIER_ADDRESS;
+    uint32_t half_page[_TWR_RADIO_OTA_HALF_PAGE_SIZE / sizeof(uint32_t)];
+
+    // Runs from second bank, entered from install or by reset through boot stub, nothing else is available here
+    __disable_irq();
+
+    if ((FLASH->PECR & FLASH_PECR_PELOCK) != 0)
+    {
+        FLASH->PEKEYR = FLASH_PEKEY1;
+        FLASH->PEKEYR = FLASH_PEKEY2;
+    }
+
+    if ((FLASH->PECR & FLASH_PECR_PRGLOCK) != 0)
+    {
+        FLASH->PRGKEYR = FLASH_PRGKEY1;
+        FLASH->PRGKEYR = FLASH_PRGKEY2;
+    }
+
+    uint32_t length = header[1];
+    uint32_t offset = _TWR_RADIO_OTA_PAGE_SIZE;
+
+    for (;;)
+    {
+        // Page with boot stub goes last
+        if (offset >= length)
+        {
+            offset = 0;
+        }
+
+        __IO uint32_t *destination = (__IO uint32_t *) (_TWR_RADIO_OTA_FLASH_BASE + offset);
+        const __IO uint32_t *source = (const __IO uint32_t *) (TWR_RADIO_OTA_STAGING_ADDRESS + offset);
+
+        for (int attempt = 0; attempt < _TWR_RADIO_OTA_COPIER_ATTEMPTS; attempt++)
+        {
+            FLASH->SR = _TWR_RADIO_OTA_FLASH_SR_ERROR;
+            FLASH->PECR |= FLASH_PECR_ERASE | FLASH_PECR_PROG;
+
+            *destination = 0;
+
+            while ((FLASH->SR & FLASH_SR_BSY) != 0)
+            {
+                continue;
+            }
+
+            FLASH->PECR &= ~(FLASH_PECR_ERASE | FLASH_PECR_PROG);
+
+            for (int half = 0; half < _TWR_RADIO_OTA_PAGE_SIZE / 4; half += _TWR_RADIO_OTA_HALF_PAGE_SIZE / 4)
+            {
+                for (int i = 0; i < _TWR_RADIO_OTA_HALF_PAGE_SIZE / 4; i++)
+                {
+                    half_page[i] = source[half + i];
+                }
+
+                FLASH->SR = _TWR_RADIO_OTA_FLASH_SR_ERROR;
+                FLASH->PECR |= FLASH_PECR_FPRG | FLASH_PECR_PROG;
+
+                for (int i = 0; i < _TWR_RADIO_OTA_HALF_PAGE_SIZE / 4; i++)
+                {
+                    destination[half] = half_page[i];
+                }
+
+                while ((FLASH->SR & FLASH_SR_BSY) != 0)
+                {
+                    continue;
+                }
+
+                FLASH->PECR &= ~(FLASH_PECR_FPRG | FLASH_PECR_PROG);
+            }
+
+            bool same = true;
+
+            for (int i = 0; i < _TWR_RADIO_OTA_PAGE_SIZE / 4; i++)
+            {
+                if (destination[i] != source[i])
+                {
+                    same = false;
+                }
+            }
+
+            if (same)
+            {
+                break;
+            }
+        }
+
+        if (offset == 0)
+        {
+            break;
+        }
+
+        offset += _TWR_RADIO_OTA_PAGE_SIZE;
+    }
+
+    __DSB();
+
+    SCB->AIRCR = (0x5fa << SCB_AIRCR_VECTKEY_Pos) | SCB_AIRCR_SYSRESETREQ_Msk;
+
+    for (;;)
+    {
+        continue;
+    }
+}
@@ -0,0 +1,13 @@
+#ifndef _NODE_CONFIG_H
+#define _NODE_CONFIG_H
+
+// NFC Tag node publishing thermometer of Core Module, tag content is written from raps/-/set/nfc
+#define NODE_THERMOMETER 1
+
+#define NODE_TEMPERATURE_UPDATE_INTERVAL (60 * 60 * 1000)
+
+void twr_set_nfc(uint64_t *id, const char *topic, void *value, void *param);
+
+#define NODE_SUBS {"raps/-/set/nfc", TWR_RADIO_SUB_PT_STRING, twr_set_nfc, NULL},
+
+#endif
@@ -0,0 +1,144 @@
+#ifndef _TWR_PROFILE_H
+#define _TWR_PROFILE_H
+
+#include <twr_scheduler.h>
+#include <twr_system.h>
+
+//! @addtogroup twr_profile twr_profile
+//! @brief Scheduler and power state profiling
+//! @details Profiling is opt-in, build the firmware with TWR_PROFILE defined (e.g. add
+//!          target_compile_definitions(${CMAKE_PROJECT_NAME} PUBLIC TWR_PROFILE) to application CMakeLists.txt).
+//!          Without it the hooks in scheduler and system code compile out and this module is empty.
+//!
+//!          Task run time is measured in microseconds from SysTick, which runs whenever the core runs. Clock on-time,
+//!          sleep residency and deep sleep blocked time are measured in ticks of RTC, which keeps running in Stop mode.
+//!          Task and semaphore holder are identified by function address, use the map file or addr2line to resolve
+//!          them. Values can be logged by twr_profile_log or read by getters and published over radio by application.
+//! @{
+
+//! @brief Maximum number of tracked deep sleep semaphore holders
+
+#ifndef TWR_PROFILE_MAX_HOLDERS
+#define TWR_PROFILE_MAX_HOLDERS 8
+#endif
+
+//! @brief Task statistics
+
+typedef struct
+{
+    //! @brief Task function (NULL if slot has not run yet)
+    void (*task)(void *);
+
+    //! @brief Number of task calls
+    uint32_t call_count;
+
+    //! @brief Cumulative run time in microseconds
+    uint64_t run_time;
+
+    //! @brief Longest single run in microseconds
+    uint32_t run_time_max;
+
+} twr_profile_task_t;
+
+//! @brief System statistics
+
+typedef struct
+{
+    //! @brief Time since reset of statistics
+    twr_tick_t elapsed;
+
+    //! @brief Time spent in Sleep mode (deep sleep disabled)
+    twr_tick_t sleep;
+
+    //! @brief Time spent in Stop mode
+    twr_tick_t deep_sleep;
+
+    //! @brief Time with HSI16 on (includes PLL on-time, PLL runs from HSI16)
+    twr_tick_t hsi16_on;
+
+    //! @brief Time with PLL on
+    twr_tick_t pll_on;
+
+    //! @brief Number of PLL start-ups (each one waits for PLL lock)
+    uint32_t pll_start_count;
+
+    //! @brief Time with deep sleep disabled
+    twr_tick_t deep_sleep_blocked;
+
+    //! @brief Number of wake-ups from sleep
+    uint32_t wakeup_count;
+
+} twr_profile_system_t;
+
+//! @brief Deep sleep semaphore holder statistics
+
+typedef struct
+{
+    //! @brief Return address of twr_system_deep_sleep_disable call which blocked deep sleep
+    const void *caller;
+
+    //! @brief Number of times the caller blocked deep sleep
+    uint32_t count;
+
+    //! @brief Time deep sleep was blocked, until the semaphore was released by anyone
+    twr_tick_t blocked;
+
+} twr_profile_holder_t;
+
+#ifdef TWR_PROFILE
+
+//! @cond
+
+void _twr_profile_task_begin(twr_scheduler_task_id_t task_id, void (*task)(void *));
+void _twr_profile_task_end(void);
+void _twr_profile_clock_hsi16(bool on);
+void _twr_profile_clock_pll(bool on);
+void _twr_profile_deep_sleep_blocked(const void *caller);
+void _twr_profile_deep_sleep_unblocked(void);
+
+//! @endcond
+
+//! @brief Clear all statistics
+
+void twr_profile_reset(void);
+
+//! @brief Sleep until interrupt and record sleep time and wake-up source (called by twr_sleep)
+
+void twr_profile_sleep(void);
+
+//! @brief Get task statistics
+//! @param[in] task_id Task ID
+//! @param[out] task Task statistics
+//! @return true If task has run since reset of statistics
+//! @return false If task has not run
+
+bool twr_profile_get_task(twr_scheduler_task_id_t task_id, twr_profile_task_t *task);
+
+//! @brief Get system statistics
+//! @param[out] system System statistics, clocks and semaphore still on are counted up to now
+
+void twr_profile_get_system(twr_profile_system_t *system);
+
+//! @brief Get deep sleep semaphore holder statistics
+//! @param[in] index Holder index (0 to TWR_PROFILE_MAX_HOLDERS - 1)
+//! @param[out] holder Holder statistics
+//! @return true If holder exists
+//! @return false If index is out of range or holder is unused
+
+bool twr_profile_get_holder(int index, twr_profile_holder_t *holder);
+
+//! @brief Get number of wake-ups by interrupt
+//! @param[in] irq Interrupt number (e.g. RTC_IRQn, EXTI4_15_IRQn)
+//! @return Number of wake-ups where the interrupt was the first one pending
+
+uint32_t twr_profile_get_wakeup_count(IRQn_Type irq);
+
+//! @brief Log all statistics with twr_log_info
+
+void twr_profile_log(void);
+
+#endif
+
+//! @}
+
+#endif // _TWR_PROFILE_H
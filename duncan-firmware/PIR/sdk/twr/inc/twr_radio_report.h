@@ -0,0 +1,119 @@
+#ifndef _TWR_RADIO_REPORT_H
+#define _TWR_RADIO_REPORT_H
+
+#include <twr_common.h>
+#include <twr_tick.h>
+
+//! @addtogroup twr_radio_report twr_radio_report
+//! @brief Send-on-delta and heartbeat reporting policy for radio publishes
+//! @details Each measured quantity gets one instance with a reporting policy. Sensor event handler feeds every new
+//!          value, instance decides whether the value is worth publishing and if so, raises the publish event where
+//!          application calls the matching twr_radio_pub function. Policy is evaluated on feed, so the sensor update
+//!          interval has to be shorter than the heartbeat interval and postponed publishes go out with a later value.
+//! @{
+
+//! @brief Dead band which disables publishing on change, value goes out on rate or heartbeat only
+
+#define TWR_RADIO_REPORT_DEAD_BAND_DISABLED (-1.f)
+
+//! @brief Reporting policy, may be shared by instances and changed at run time
+
+typedef struct
+{
+    //! @brief Publish if value differs from last published value by at least this much (0 publishes every value,
+    //!        TWR_RADIO_REPORT_DEAD_BAND_DISABLED or any negative value disables)
+    float dead_band;
+
+    //! @brief Added to dead band when value moves in the opposite direction than at last publish
+    float hysteresis;
+
+    //! @brief Publish if value changes at least by this much per second between two feeds (0 disables)
+    float rate;
+
+    //! @brief Smoothing of fed values, each value has weight 1 / 2^smoothing (0 disables)
+    uint8_t smoothing;
+
+    //! @brief Minimum time between two publishes, publish due sooner is postponed
+    twr_tick_t min_interval;
+
+    //! @brief Maximum time between two publishes (0 disables heartbeat)
+    twr_tick_t max_interval;
+
+} twr_radio_report_config_t;
+
+//! @brief Callback events
+
+typedef enum
+{
+    //! @brief Value should be published now
+    TWR_RADIO_REPORT_EVENT_PUBLISH = 0
+
+} twr_radio_report_event_t;
+
+//! @brief Reporting instance
+
+typedef struct twr_radio_report_t twr_radio_report_t;
+
+//! @cond
+
+struct twr_radio_report_t
+{
+    const twr_radio_report_config_t *_config;
+    void (*_event_handler)(twr_radio_report_t *, twr_radio_report_event_t, void *);
+    void *_event_param;
+    bool _valid;
+    float _filtered;
+    twr_tick_t _tick_feed;
+    bool _published;
+    float _value;
+    int _direction;
+    twr_tick_t _tick_publish;
+    bool _pending;
+    bool _forced;
+};
+
+//! @endcond
+
+//! @brief Initialize reporting instance
+//! @param[in] self Instance
+//! @param[in] config Reporting policy (must stay valid while instance is in use)
+
+void twr_radio_report_init(twr_radio_report_t *self, const twr_radio_report_config_t *config);
+
+//! @brief Set callback function
+//! @param[in] self Instance
+//! @param[in] event_handler Function address
+//! @param[in] event_param Optional event parameter (can be NULL)
+
+void twr_radio_report_set_event_handler(twr_radio_report_t *self, void (*event_handler)(twr_radio_report_t *, twr_radio_report_event_t, void *), void *event_param);
+
+//! @brief Set reporting policy
+//! @param[in] self Instance
+//! @param[in] config Reporting policy (must stay valid while instance is in use)
+
+void twr_radio_report_set_config(twr_radio_report_t *self, const twr_radio_report_config_t *config);
+
+//! @brief Feed new value and publish it if policy says so
+//! @param[in] self Instance
+//! @param[in] value Measured value
+//! @return true If publish event has been raised
+//! @return false If value has not been published
+
+bool twr_radio_report_feed(twr_radio_report_t *self, float value);
+
+//! @brief Publish next fed value regardless of policy (e.g. after configuration change or on state transition)
+//! @param[in] self Instance
+
+void twr_radio_report_force(twr_radio_report_t *self);
+
+//! @brief Get last published value (the one being published during publish event)
+//! @param[in] self Instance
+//! @param[out] value Value
+//! @return true If value is valid
+//! @return false If nothing has been published yet
+
+bool twr_radio_report_get_value(twr_radio_report_t *self, float *value);
+
+//! @}
+
+#endif // _TWR_RADIO_REPORT_H
@@ -0,0 +1,519 @@
+#include <twr_module_rs485_modbus.h>
+#include <twr_crc.h>
+
+#define _TWR_MODULE_RS485_MODBUS_FUNCTION_WRITE_REGISTER 0x06
+#define _TWR_MODULE_RS485_MODBUS_EXCEPTION 0x80
+#define _TWR_MODULE_RS485_MODBUS_REQUEST_LENGTH 8
+#define _TWR_MODULE_RS485_MODBUS_EXCEPTION_LENGTH 5
+#define _TWR_MODULE_RS485_MODBUS_WRITE_QUEUE_LENGTH 4
+#define _TWR_MODULE_RS485_MODBUS_CHARACTER_BITS 11
+
+typedef enum
+{
+    TWR_MODULE_RS485_MODBUS_STATE_IDLE = 0,
+    TWR_MODULE_RS485_MODBUS_STATE_RECEIVE = 1
+
+} twr_module_rs485_modbus_state_t;
+
+typedef struct
+{
+    uint8_t slave;
+    uint8_t function;
+    uint16_t address;
+    uint8_t count;
+    uint8_t first;
+    uint8_t length;
+
+} twr_module_rs485_modbus_request_t;
+
+typedef struct
+{
+    uint8_t slave;
+    uint16_t address;
+    uint16_t value;
+
+} twr_module_rs485_modbus_write_t;
+
+static struct
+{
+    twr_module_rs485_modbus_state_t state;
+    twr_scheduler_task_id_t task_id;
+    twr_scheduler_task_id_t task_id_interval;
+    twr_tick_t update_interval;
+    void (*event_handler)(twr_module_rs485_modbus_event_t, void *);
+    void *event_param;
+
+    uint32_t character_us;
+    twr_tick_t silence;
+
+    const twr_module_rs485_modbus_register_t *table;
+    uint8_t order[TWR_MODULE_RS485_MODBUS_MAX_REGISTERS];
+    uint16_t values[TWR_MODULE_RS485_MODBUS_MAX_REGISTERS];
+    uint8_t valid[(TWR_MODULE_RS485_MODBUS_MAX_REGISTERS + 7) / 8];
+
+    twr_module_rs485_modbus_request_t requests[TWR_MODULE_RS485_MODBUS_MAX_REQUESTS];
+    int requests_length;
+    int request;
+    bool polling;
+
+    twr_module_rs485_modbus_write_t writes[_TWR_MODULE_RS485_MODBUS_WRITE_QUEUE_LENGTH];
+    int writes_head;
+    int writes_length;
+    bool writing;
+
+    uint8_t frame[_TWR_MODULE_RS485_MODBUS_REQUEST_LENGTH];
+    uint8_t response[5 + 2 * TWR_MODULE_RS485_MODBUS_MAX_COUNT];
+    size_t response_length;
+    size_t expected_length;
+    size_t silence_length;
+    twr_tick_t tick_silence;
+    twr_tick_t tick_timeout;
+
+} _twr_module_rs485_modbus;
+
+static void _twr_module_rs485_modbus_task(void *param);
+static void _twr_module_rs485_modbus_task_interval(void *param);
+static bool _twr_module_rs485_modbus_transmit(uint8_t slave, uint8_t function, uint16_t address, uint16_t data, size_t expected_length);
+static void _twr_module_rs485_modbus_done(bool success);
+static twr_tick_t _twr_module_rs485_modbus_characters(size_t count);
+
+bool twr_module_rs485_modbus_init(twr_module_rs485_baudrate_t baudrate)
+{
+    memset(&_twr_module_rs485_modbus, 0, sizeof(_twr_module_rs485_modbus));
+
+    if (!twr_module_rs485_init())
+    {
+        return false;
+    }
+
+    if (!twr_module_rs485_set_baudrate(baudrate))
+    {
+        return false;
+    }
+
+    uint32_t rate;
+
+    switch (baudrate)
+    {
+        case TWR_MODULE_RS485_BAUDRATE_19200: rate = 19200; break;
+        case TWR_MODULE_RS485_BAUDRATE_38400: rate = 38400; break;
+        case TWR_MODULE_RS485_BAUDRATE_57600: rate = 57600; break;
+        case TWR_MODULE_RS485_BAUDRATE_115200: rate = 115200; break;
+        case TWR_MODULE_RS485_BAUDRATE_9600:
+        default: rate = 9600; break;
+    }
+
+    _twr_module_rs485_modbus.character_us = (_TWR_MODULE_RS485_MODBUS_CHARACTER_BITS * 1000000UL + rate - 1) / rate;
+
+    // Modbus fixes the inter-frame silence to 1.75 ms above 19200 baud
+    _twr_module_rs485_modbus.silence = rate > 19200 ? 2 : _twr_module_rs485_modbus_characters(4);
+
+    _twr_module_rs485_modbus.update_interval = TWR_TICK_INFINITY;
+
+    _twr_module_rs485_modbus.task_id = twr_scheduler_register(_twr_module_rs485_modbus_task, NULL, TWR_TICK_INFINITY);
+    _twr_module_rs485_modbus.task_id_interval = twr_scheduler_register(_twr_module_rs485_modbus_task_interval, NULL, TWR_TICK_INFINITY);
+
+    return true;
+}
+
+void twr_module_rs485_modbus_set_event_handler(void (*event_handler)(twr_module_rs485_modbus_event_t, void *), void *event_param)
+{
+    _twr_module_rs485_modbus.event_handler = event_handler;
+    _twr_module_rs485_modbus.event_param = event_param;
+}
+
+bool twr_module_rs485_modbus_set_poll_table(const twr_module_rs485_modbus_register_t *table, int count)
+{
+    if ((count < 0) || (count > TWR_MODULE_RS485_MODBUS_MAX_REGISTERS) || _twr_module_rs485_modbus.polling)
+    {
+        return false;
+    }
+
+    uint8_t *order = _twr_module_rs485_modbus.order;
+
+    // Sort by slave, function and address, so registers one request can read are next to each other
+    for (int i = 0; i < count; i++)
+    {
+        uint32_t key = ((uint32_t) table[i].slave << 24) | ((uint32_t) table[i].function << 16) | table[i].address;
+
+        int j = i;
+
+        for (; j > 0; j--)
+        {
+            const twr_module_rs485_modbus_register_t *r = &table[order[j - 1]];
+
+            if ((((uint32_t) r->slave << 24) | ((uint32_t) r->function << 16) | r->address) <= key)
+            {
+                break;
+            }
+
+            order[j] = order[j - 1];
+        }
+
+        order[j] = i;
+    }
+
+    int length = 0;
+
+    for (int i = 0; i < count; i++)
+    {
+        const twr_module_rs485_modbus_register_t *r = &table[order[i]];
+
+        twr_module_rs485_modbus_request_t *request = length > 0 ? &_twr_module_rs485_modbus.requests[length - 1] : NULL;
+
+        if ((request != NULL) && (request->slave == r->slave) && (request->function == r->function) &&
+            (r->address <= request->address + request->count + TWR_MODULE_RS485_MODBUS_COALESCE_GAP) &&
+            (r->address + 1 - request->address <= TWR_MODULE_RS485_MODBUS_MAX_COUNT))
+        {
+            if (r->address + 1 - request->address > request->count)
+            {
+                request->count = r->address + 1 - request->address;
+            }
+
+            request->length++;
+
+            continue;
+        }
+
+        if (length == TWR_MODULE_RS485_MODBUS_MAX_REQUESTS)
+        {
+            _twr_module_rs485_modbus.requests_length = 0;
+
+            return false;
+        }
+
+        request = &_twr_module_rs485_modbus.requests[length++];
+
+        request->slave = r->slave;
+        request->function = r->function;
+        request->address = r->address;
+        request->count = 1;
+        request->first = i;
+        request->length = 1;
+    }
+
+    _twr_module_rs485_modbus.table = table;
+    _twr_module_rs485_modbus.requests_length = length;
+
+    memset(_twr_module_rs485_modbus.valid, 0, sizeof(_twr_module_rs485_modbus.valid));
+
+    return true;
+}
+
+void twr_module_rs485_modbus_set_update_interval(twr_tick_t interval)
+{
+    _twr_module_rs485_modbus.update_interval = interval;
+
+    if (_twr_module_rs485_modbus.update_interval == TWR_TICK_INFINITY)
+    {
+        twr_scheduler_plan_absolute(_twr_module_rs485_modbus.task_id_interval, TWR_TICK_INFINITY);
+    }
+    else
+    {
+        twr_scheduler_plan_relative(_twr_module_rs485_modbus.task_id_interval, _twr_module_rs485_modbus.update_interval);
+
+        twr_module_rs485_modbus_poll();
+    }
+}
+
+bool twr_module_rs485_modbus_poll(void)
+{
+    if (_twr_module_rs485_modbus.polling)
+    {
+        return false;
+    }
+
+    _twr_module_rs485_modbus.polling = true;
+    _twr_module_rs485_modbus.request = 0;
+
+    if (_twr_module_rs485_modbus.state == TWR_MODULE_RS485_MODBUS_STATE_IDLE)
+    {
+        twr_scheduler_plan_now(_twr_module_rs485_modbus.task_id);
+    }
+
+    return true;
+}
+
+bool twr_module_rs485_modbus_get_value(int index, uint16_t *value)
+{
+    if ((index < 0) || (index >= TWR_MODULE_RS485_MODBUS_MAX_REGISTERS) || ((_twr_module_rs485_modbus.valid[index / 8] & (1 << (index % 8))) == 0))
+    {
+        return false;
+    }
+
+    *value = _twr_module_rs485_modbus.values[index];
+
+    return true;
+}
+
+bool twr_module_rs485_modbus_write(uint8_t slave, uint16_t address, uint16_t value)
+{
+    if (_twr_module_rs485_modbus.writes_length == _TWR_MODULE_RS485_MODBUS_WRITE_QUEUE_LENGTH)
+    {
+        return false;
+    }
+
+    int i = (_twr_module_rs485_modbus.writes_head + _twr_module_rs485_modbus.writes_length) % _TWR_MODULE_RS485_MODBUS_WRITE_QUEUE_LENGTH;
+
+    _twr_module_rs485_modbus.writes[i].slave = slave;
+    _twr_module_rs485_modbus.writes[i].address = address;
+    _twr_module_rs485_modbus.writes[i].value = value;
+
+    _twr_module_rs485_modbus.writes_length++;
+
+    if (_twr_module_rs485_modbus.state == TWR_MODULE_RS485_MODBUS_STATE_IDLE)
+    {
+        twr_scheduler_plan_now(_twr_module_rs485_modbus.task_id);
+    }
+
+    return true;
+}
+
+static void _twr_module_rs485_modbus_task_interval(void *param)
+{
+    (void) param;
+
+    twr_module_rs485_modbus_poll();
+
+    twr_scheduler_plan_current_relative(_twr_module_rs485_modbus.update_interval);
+}
+
+static void _twr_module_rs485_modbus_task(void *param)
+{
+    (void) param;
+
+    if (_twr_module_rs485_modbus.state == TWR_MODULE_RS485_MODBUS_STATE_IDLE)
+    {
+        bool result;
+
+        if (_twr_module_rs485_modbus.writes_length != 0)
+        {
+            twr_module_rs485_modbus_write_t *write = &_twr_module_rs485_modbus.writes[_twr_module_rs485_modbus.writes_head];
+
+            _twr_module_rs485_modbus.writing = true;
+
+            // Slave echoes the request
+            result = _twr_module_rs485_modbus_transmit(write->slave, _TWR_MODULE_RS485_MODBUS_FUNCTION_WRITE_REGISTER, write->address, write->value, _TWR_MODULE_RS485_MODBUS_REQUEST_LENGTH);
+        }
+        else if (_twr_module_rs485_modbus.polling && (_twr_module_rs485_modbus.request < _twr_module_rs485_modbus.requests_length))
+        {
+            twr_module_rs485_modbus_request_t *request = &_twr_module_rs485_modbus.requests[_twr_module_rs485_modbus.request];
+
+            result = _twr_module_rs485_modbus_transmit(request->slave, request->function, request->address, request->count, 5 + 2 * request->count);
+        }
+        else
+        {
+            if (_twr_module_rs485_modbus.polling)
+            {
+                _twr_module_rs485_modbus.polling = false;
+
+                if (_twr_module_rs485_modbus.event_handler != NULL)
+                {
+                    _twr_module_rs485_modbus.event_handler(TWR_MODULE_RS485_MODBUS_EVENT_UPDATE, _twr_module_rs485_modbus.event_param);
+                }
+            }
+
+            return;
+        }
+
+        if (!result)
+        {
+            _twr_module_rs485_modbus.writing = false;
+            _twr_module_rs485_modbus.polling = false;
+
+            if (_twr_module_rs485_modbus.event_handler != NULL)
+            {
+                _twr_module_rs485_modbus.event_handler(TWR_MODULE_RS485_MODBUS_EVENT_ERROR, _twr_module_rs485_modbus.event_param);
+            }
+
+            return;
+        }
+
+        _twr_module_rs485_modbus.state = TWR_MODULE_RS485_MODBUS_STATE_RECEIVE;
+
+        // Nothing to do before the whole response can be in the FIFO
+        twr_scheduler_plan_current_from_now(_twr_module_rs485_modbus_characters(_TWR_MODULE_RS485_MODBUS_REQUEST_LENGTH + _twr_module_rs485_modbus.expected_length));
+
+        return;
+    }
+
+    twr_tick_t now = twr_tick_get();
+
+    size_t missing = _twr_module_rs485_modbus.expected_length - _twr_module_rs485_modbus.response_length;
+
+    size_t length;
+
+    if (!twr_module_rs485_available(&length))
+    {
+        _twr_module_rs485_modbus_done(false);
+
+        return;
+    }
+
+    if (length > missing)
+    {
+        length = missing;
+    }
+
+    // Read only what is in the FIFO, so the read returns without waiting
+    if ((length != 0) && (twr_module_rs485_read(_twr_module_rs485_modbus.response + _twr_module_rs485_modbus.response_length, length, 0) != length))
+    {
+        _twr_module_rs485_modbus_done(false);
+
+        return;
+    }
+
+    _twr_module_rs485_modbus.response_length += length;
+
+    uint8_t *response = _twr_module_rs485_modbus.response;
+
+    if ((_twr_module_rs485_modbus.response_length >= _TWR_MODULE_RS485_MODBUS_EXCEPTION_LENGTH) && ((response[1] & _TWR_MODULE_RS485_MODBUS_EXCEPTION) != 0))
+    {
+        _twr_module_rs485_modbus.response_length = _TWR_MODULE_RS485_MODBUS_EXCEPTION_LENGTH;
+
+        _twr_module_rs485_modbus_done(false);
+
+        return;
+    }
+
+    if (_twr_module_rs485_modbus.response_length == _twr_module_rs485_modbus.expected_length)
+    {
+        size_t n = _twr_module_rs485_modbus.response_length;
+
+        uint16_t crc = twr_crc16_modbus(response, n - 2);
+
+        bool success = (response[0] == _twr_module_rs485_modbus.frame[0]) && (response[1] == _twr_module_rs485_modbus.frame[1]) &&
+                       (response[n - 2] == (crc & 0xff)) && (response[n - 1] == (crc >> 8));
+
+        if (success && _twr_module_rs485_modbus.writing)
+        {
+            success = memcmp(response, _twr_module_rs485_modbus.frame, _TWR_MODULE_RS485_MODBUS_REQUEST_LENGTH) == 0;
+        }
+        else if (success)
+        {
+            success = response[2] == n - 5;
+        }
+
+        _twr_module_rs485_modbus_done(success);
+
+        return;
+    }
+
+    if (length != 0)
+    {
+        _twr_module_rs485_modbus.tick_silence = now;
+    }
+    else if ((_twr_module_rs485_modbus.response_length != 0) && (now - _twr_module_rs485_modbus.tick_silence >= _twr_module_rs485_modbus.silence))
+    {
+        // Frame ended short of expected length
+        _twr_module_rs485_modbus_done(false);
+
+        return;
+    }
+
+    if ((_twr_module_rs485_modbus.response_length == 0) && (now >= _twr_module_rs485_modbus.tick_timeout))
+    {
+        _twr_module_rs485_modbus_done(false);
+
+        return;
+    }
+
+    twr_tick_t wait = _twr_module_rs485_modbus_characters(missing - length);
+
+    twr_scheduler_plan_current_from_now(wait < _twr_module_rs485_modbus.silence ? wait : _twr_module_rs485_modbus.silence);
+}
+
+static bool _twr_module_rs485_modbus_transmit(uint8_t slave, uint8_t function, uint16_t address, uint16_t data, size_t expected_length)
+{
+    uint8_t *frame = _twr_module_rs485_modbus.frame;
+
+    frame[0] = slave;
+    frame[1] = function;
+    frame[2] = address >> 8;
+    frame[3] = address;
+    frame[4] = data >> 8;
+    frame[5] = data;
+
+    uint16_t crc = twr_crc16_modbus(frame, 6);
+
+    frame[6] = crc;
+    frame[7] = crc >> 8;
+
+    size_t available;
+
+    if (!twr_module_rs485_available(&available))
+    {
+        return false;
+    }
+
+    // Leftovers of late or broken response must not be taken for the response to this request
+    while (available != 0)
+    {
+        size_t length = available < sizeof(_twr_module_rs485_modbus.response) ? available : sizeof(_twr_module_rs485_modbus.response);
+
+        if (twr_module_rs485_read(_twr_module_rs485_modbus.response, length, 0) != length)
+        {
+            return false;
+        }
+
+        available -= length;
+    }
+
+    if (twr_module_rs485_write(frame, _TWR_MODULE_RS485_MODBUS_REQUEST_LENGTH) != _TWR_MODULE_RS485_MODBUS_REQUEST_LENGTH)
+    {
+        return false;
+    }
+
+    _twr_module_rs485_modbus.response_length = 0;
+    _twr_module_rs485_modbus.expected_length = expected_length;
+    _twr_module_rs485_modbus.tick_timeout = twr_tick_get() + _twr_module_rs485_modbus_characters(_TWR_MODULE_RS485_MODBUS_REQUEST_LENGTH) + TWR_MODULE_RS485_MODBUS_RESPONSE_TIMEOUT;
+
+    return true;
+}
+
+static void _twr_module_rs485_modbus_done(bool success)
+{
+    _twr_module_rs485_modbus.state = TWR_MODULE_RS485_MODBUS_STATE_IDLE;
+
+    if (_twr_module_rs485_modbus.writing)
+    {
+        _twr_module_rs485_modbus.writing = false;
+
+        _twr_module_rs485_modbus.writes_head = (_twr_module_rs485_modbus.writes_head + 1) % _TWR_MODULE_RS485_MODBUS_WRITE_QUEUE_LENGTH;
+        _twr_module_rs485_modbus.writes_length--;
+
+        if (_twr_module_rs485_modbus.event_handler != NULL)
+        {
+            _twr_module_rs485_modbus.event_handler(success ? TWR_MODULE_RS485_MODBUS_EVENT_WRITE_DONE : TWR_MODULE_RS485_MODBUS_EVENT_WRITE_ERROR, _twr_module_rs485_modbus.event_param);
+        }
+    }
+    else
+    {
+        twr_module_rs485_modbus_request_t *request = &_twr_module_rs485_modbus.requests[_twr_module_rs485_modbus.request++];
+
+        for (int i = request->first; i < request->first + request->length; i++)
+        {
+            int index = _twr_module_rs485_modbus.order[i];
+
+            uint8_t *data = _twr_module_rs485_modbus.response + 3 + 2 * (_twr_module_rs485_modbus.table[index].address - request->address);
+
+            if (success)
+            {
+                _twr_module_rs485_modbus.values[index] = ((uint16_t) data[0] << 8) | data[1];
+                _twr_module_rs485_modbus.valid[index / 8] |= 1 << (index % 8);
+            }
+            else
+            {
+                _twr_module_rs485_modbus.valid[index / 8] &= ~(1 << (index % 8));
+            }
+        }
+    }
+
+    // Next request goes out right after the inter-frame silence
+    twr_scheduler_plan_current_from_now(_twr_module_rs485_modbus.silence);
+}
+
+static twr_tick_t _twr_module_rs485_modbus_characters(size_t count)
+{
+    return (count * _twr_module_rs485_modbus.character_us + 999) / 1000;
+}
@@ -0,0 +1,151 @@
+#include <twr_radio_report.h>
+#include <math.h>
+
+static bool _twr_radio_report_is_due(twr_radio_report_t *self, float value, twr_tick_t now);
+
+void twr_radio_report_init(twr_radio_report_t *self, const twr_radio_report_config_t *config)
+{
+    memset(self, 0, sizeof(*self));
+
+    self->_config = config;
+}
+
+void twr_radio_report_set_event_handler(twr_radio_report_t *self, void (*event_handler)(twr_radio_report_t *, twr_radio_report_event_t, void *), void *event_param)
+{
+    self->_event_handler = event_handler;
+    self->_event_param = event_param;
+}
+
+void twr_radio_report_set_config(twr_radio_report_t *self, const twr_radio_report_config_t *config)
+{
+    self->_config = config;
+}
+
+bool twr_radio_report_feed(twr_radio_report_t *self, float value)
+{
+    if (isnan(value))
+    {
+        return false;
+    }
+
+    twr_tick_t now = twr_tick_get();
+
+    if (_twr_radio_report_is_due(self, value, now))
+    {
+        self->_pending = true;
+    }
+
+    if (!self->_pending)
+    {
+        return false;
+    }
+
+    if (self->_published && !self->_forced && (now - self->_tick_publish < self->_config->min_interval))
+    {
+        return false;
+    }
+
+    if (self->_published && (self->_filtered != self->_value))
+    {
+        self->_direction = self->_filtered > self->_value ? 1 : -1;
+    }
+
+    self->_published = true;
+    self->_value = self->_filtered;
+    self->_tick_publish = now;
+    self->_pending = false;
+    self->_forced = false;
+
+    if (self->_event_handler != NULL)
+    {
+        self->_event_handler(self, TWR_RADIO_REPORT_EVENT_PUBLISH, self->_event_param);
+    }
+
+    return true;
+}
+
+void twr_radio_report_force(twr_radio_report_t *self)
+{
+    self->_pending = true;
+    self->_forced = true;
+}
+
+bool twr_radio_report_get_value(twr_radio_report_t *self, float *value)
+{
+    if (!self->_published)
+    {
+        return false;
+    }
+
+    *value = self->_value;
+
+    return true;
+}
+
+static bool _twr_radio_report_is_due(twr_radio_report_t *self, float value, twr_tick_t now)
+{
+    const twr_radio_report_config_t *config = self->_config;
+
+    if (!self->_valid)
+    {
+        self->_valid = true;
+        self->_filtered = value;
+        self->_tick_feed = now;
+
+        return true;
+    }
+
+    float previous = self->_filtered;
+
+    if (config->smoothing != 0)
+    {
+        self->_filtered += (value - self->_filtered) / (float) (1UL << config->smoothing);
+    }
+    else
+    {
+        self->_filtered = value;
+    }
+
+    twr_tick_t elapsed = now - self->_tick_feed;
+
+    self->_tick_feed = now;
+
+    if (!self->_published)
+    {
+        return true;
+    }
+
+    if ((config->max_interval != 0) && (now - self->_tick_publish >= config->max_interval))
+    {
+        return true;
+    }
+
+    float delta = self->_filtered - self->_value;
+
+    // Zero dead band publishes every value, negative one disables the delta trigger
+    if (config->dead_band >= 0.f)
+    {
+        float threshold = config->dead_band;
+
+        // Reversal has to overcome hysteresis, so noise around threshold does not publish back and forth
+        if ((threshold > 0.f) && (((delta > 0.f) && (self->_direction < 0)) || ((delta < 0.f) && (self->_direction > 0))))
+        {
+            threshold += config->hysteresis;
+        }
+
+        if (fabsf(delta) >= threshold)
+        {
+            return true;
+        }
+    }
+
+    if ((config->rate > 0.f) && (elapsed != 0))
+    {
+        if (fabsf(self->_filtered - previous) * 1000.f >= config->rate * (float) elapsed)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,711 @@
+#include <node.h>
+
+#define _NODE_PAIRING_RETRY_INTERVAL 1000
+#define _NODE_CONFIG_FIELDS 10
+#define _NODE_CONFIG1 0x01
+#define _NODE_CONFIG2 0x02
+
+// Position of one comma separated field of gateway configuration in node settings
+
+typedef enum
+{
+    _NODE_FIELD_NONE = 0,
+    _NODE_FIELD_INTERVAL = 1,
+    _NODE_FIELD_HEARTBEAT = 2,
+    _NODE_FIELD_VALUE = 3
+
+} _node_field_type_t;
+
+typedef struct
+{
+    uint16_t offset;
+    uint8_t type;
+
+} _node_field_t;
+
+#define _NODE_SKIP { 0, _NODE_FIELD_NONE }
+#define _NODE_INTERVAL(member) { offsetof(node_settings_t, member), _NODE_FIELD_INTERVAL }
+#define _NODE_HEARTBEAT(member) { offsetof(node_settings_t, member.max_interval), _NODE_FIELD_HEARTBEAT }
+#define _NODE_DEAD_BAND(member) { offsetof(node_settings_t, member.dead_band), _NODE_FIELD_VALUE }
+
+// Field of sensor that is not fitted is skipped without naming missing member
+
+#if NODE_UPDATE_SERVICE
+#define _NODE_SERVICE(member) _NODE_INTERVAL(member)
+#define _NODE_NORMAL(member) _NODE_SKIP
+#else
+#define _NODE_SERVICE(member) _NODE_SKIP
+#define _NODE_NORMAL(member) _NODE_INTERVAL(member)
+#endif
+
+#if NODE_BATTERY
+#define _NODE_IF_BATTERY(field) field
+#else
+#define _NODE_IF_BATTERY(field) _NODE_SKIP
+#endif
+
+#if NODE_HAS_TEMPERATURE
+#define _NODE_IF_TEMPERATURE(field) field
+#else
+#define _NODE_IF_TEMPERATURE(field) _NODE_SKIP
+#endif
+
+#if NODE_HAS_HUMIDITY
+#define _NODE_IF_HUMIDITY(field) field
+#else
+#define _NODE_IF_HUMIDITY(field) _NODE_SKIP
+#endif
+
+#if NODE_HAS_ILLUMINANCE
+#define _NODE_IF_ILLUMINANCE(field) field
+#else
+#define _NODE_IF_ILLUMINANCE(field) _NODE_SKIP
+#endif
+
+#if NODE_HAS_PRESSURE
+#define _NODE_IF_PRESSURE(field) field
+#else
+#define _NODE_IF_PRESSURE(field) _NODE_SKIP
+#endif
+
+#if NODE_HAS_CO2
+#define _NODE_IF_CO2(field) field
+#else
+#define _NODE_IF_CO2(field) _NODE_SKIP
+#endif
+
+#if NODE_HAS_TVOC
+#define _NODE_IF_TVOC(field) field
+#else
+#define _NODE_IF_TVOC(field) _NODE_SKIP
+#endif
+
+// Layout of raps/-/get/config1, intervals in minutes
+
+static const _node_field_t _node_config1[_NODE_CONFIG_FIELDS] =
+{
+    _NODE_SKIP, // Application task interval
+    _NODE_IF_BATTERY(_NODE_INTERVAL(battery_update_interval)),
+    _NODE_SKIP, // Update service interval
+    _NODE_SKIP, // Update normal interval
+    _NODE_IF_PRESSURE(_NODE_SERVICE(pressure_update_interval)),
+    _NODE_IF_PRESSURE(_NODE_NORMAL(pressure_update_interval)),
+    _NODE_IF_TEMPERATURE(_NODE_SERVICE(temperature_update_interval)),
+    _NODE_IF_TEMPERATURE(_NODE_NORMAL(temperature_update_interval)),
+    _NODE_IF_HUMIDITY(_NODE_SERVICE(humidity_update_interval)),
+    _NODE_IF_HUMIDITY(_NODE_NORMAL(humidity_update_interval))
+};
+
+// Layout of raps/-/get/config2, gateway sends lux meter settings to Climate Module nodes instead of CO2 and VOC
+
+static const _node_field_t _node_config2[_NODE_CONFIG_FIELDS] =
+{
+#if NODE_CLIMATE_MODULE
+    _NODE_SERVICE(illuminance_update_interval),
+    _NODE_NORMAL(illuminance_update_interval),
+    _NODE_HEARTBEAT(temperature),
+    _NODE_DEAD_BAND(temperature),
+    _NODE_HEARTBEAT(humidity),
+    _NODE_DEAD_BAND(humidity),
+    _NODE_HEARTBEAT(illuminance),
+    _NODE_DEAD_BAND(illuminance),
+    _NODE_HEARTBEAT(pressure),
+    _NODE_DEAD_BAND(pressure)
+#else
+    _NODE_IF_CO2(_NODE_SERVICE(co2_update_interval)),
+    _NODE_IF_CO2(_NODE_NORMAL(co2_update_interval)),
+    _NODE_IF_TVOC(_NODE_SERVICE(tvoc_update_interval)),
+    _NODE_IF_TVOC(_NODE_NORMAL(tvoc_update_interval)),
+    _NODE_IF_TEMPERATURE(_NODE_HEARTBEAT(temperature)),
+    _NODE_IF_TEMPERATURE(_NODE_DEAD_BAND(temperature)),
+    _NODE_IF_HUMIDITY(_NODE_HEARTBEAT(humidity)),
+    _NODE_IF_HUMIDITY(_NODE_DEAD_BAND(humidity)),
+    _NODE_IF_PRESSURE(_NODE_HEARTBEAT(pressure)),
+    _NODE_IF_PRESSURE(_NODE_DEAD_BAND(pressure))
+#endif
+};
+
+static struct
+{
+    twr_scheduler_task_id_t task_id;
+    uint64_t radio_id;
+    char radio_id_string[17];
+    uint8_t config_received;
+    node_settings_t settings;
+
+#if NODE_THERMOMETER
+    twr_tmp112_t tmp112;
+#endif
+#if NODE_TAG_HUMIDITY
+    twr_tag_humidity_t tag_humidity;
+#endif
+#if NODE_TAG_BAROMETER
+    twr_tag_barometer_t tag_barometer;
+#endif
+#if NODE_TAG_VOC_LP
+    twr_tag_voc_lp_t tag_voc_lp;
+#endif
+
+#if NODE_HAS_TEMPERATURE
+    twr_radio_report_t temperature;
+#endif
+#if NODE_HAS_HUMIDITY
+    twr_radio_report_t humidity;
+#endif
+#if NODE_HAS_ILLUMINANCE
+    twr_radio_report_t illuminance;
+#endif
+#if NODE_HAS_PRESSURE
+    twr_radio_report_t pressure;
+    float altitude;
+    bool altitude_valid;
+#endif
+#if NODE_HAS_CO2
+    twr_radio_report_t co2;
+#endif
+#if NODE_HAS_TVOC
+    twr_radio_report_t tvoc;
+#endif
+#if NODE_BATTERY
+    float battery_voltage;
+    float battery_percentage;
+    bool battery_valid;
+#endif
+
+} _node;
+
+static void _node_task(void *param);
+static void _node_get_config1(uint64_t *id, const char *topic, void *value, void *param);
+static void _node_get_config2(uint64_t *id, const char *topic, void *value, void *param);
+static void _node_config_parse(const _node_field_t *fields, const char *value);
+static void _node_sensors_update(void);
+static void _node_report_event_handler(twr_radio_report_t *self, twr_radio_report_event_t event, void *event_param);
+
+static const twr_radio_sub_t _node_subs[] =
+{
+    {"raps/-/get/config1", TWR_RADIO_SUB_PT_STRING, _node_get_config1, NULL},
+    {"raps/-/get/config2", TWR_RADIO_SUB_PT_STRING, _node_get_config2, NULL},
+    NODE_SUBS
+};
+
+#if NODE_THERMOMETER
+static void _node_tmp112_event_handler(twr_tmp112_t *self, twr_tmp112_event_t event, void *event_param)
+{
+    (void) event_param;
+
+    float value;
+
+    if (event == TWR_TMP112_EVENT_UPDATE && twr_tmp112_get_temperature_celsius(self, &value))
+    {
+        twr_radio_report_feed(&_node.temperature, value);
+    }
+}
+#endif
+
+#if NODE_CLIMATE_MODULE
+static void _node_climate_module_event_handler(twr_module_climate_event_t event, void *event_param)
+{
+    (void) event_param;
+
+    float value;
+
+    if (event == TWR_MODULE_CLIMATE_EVENT_UPDATE_THERMOMETER)
+    {
+        if (twr_module_climate_get_temperature_celsius(&value))
+        {
+            twr_radio_report_feed(&_node.temperature, value);
+        }
+    }
+    else if (event == TWR_MODULE_CLIMATE_EVENT_UPDATE_HYGROMETER)
+    {
+        if (twr_module_climate_get_humidity_percentage(&value))
+        {
+            twr_radio_report_feed(&_node.humidity, value);
+        }
+    }
+    else if (event == TWR_MODULE_CLIMATE_EVENT_UPDATE_LUX_METER)
+    {
+        if (twr_module_climate_get_illuminance_lux(&value))
+        {
+            if (value < 1)
+            {
+                value = 0;
+            }
+
+            float last;
+
+            // Darkness and light are always reported, whatever the dead band
+            if (twr_radio_report_get_value(&_node.illuminance, &last) && (((value == 0) && (last != 0)) || ((value > 1) && (last == 0))))
+            {
+                twr_radio_report_force(&_node.illuminance);
+            }
+
+            twr_radio_report_feed(&_node.illuminance, value);
+        }
+    }
+    else if (event == TWR_MODULE_CLIMATE_EVENT_UPDATE_BAROMETER)
+    {
+        _node.altitude_valid = twr_module_climate_get_altitude_meter(&_node.altitude);
+
+        if (twr_module_climate_get_pressure_pascal(&value))
+        {
+            twr_radio_report_feed(&_node.pressure, value);
+        }
+    }
+}
+#endif
+
+#if NODE_TAG_HUMIDITY
+static void _node_tag_humidity_event_handler(twr_tag_humidity_t *self, twr_tag_humidity_event_t event, void *event_param)
+{
+    (void) event_param;
+
+    float value;
+
+    if (event == TWR_TAG_HUMIDITY_EVENT_UPDATE && twr_tag_humidity_get_humidity_percentage(self, &value))
+    {
+        twr_radio_report_feed(&_node.humidity, value);
+    }
+}
+#endif
+
+#if NODE_TAG_BAROMETER
+static void _node_tag_barometer_event_handler(twr_tag_barometer_t *self, twr_tag_barometer_event_t event, void *event_param)
+{
+    (void) event_param;
+
+    float value;
+
+    if (event != TWR_TAG_BAROMETER_EVENT_UPDATE)
+    {
+        return;
+    }
+
+    _node.altitude_valid = twr_tag_barometer_get_altitude_meter(self, &_node.altitude);
+
+    if (twr_tag_barometer_get_pressure_pascal(self, &value))
+    {
+        twr_radio_report_feed(&_node.pressure, value);
+    }
+}
+#endif
+
+#if NODE_TAG_VOC_LP
+static void _node_tag_voc_lp_event_handler(twr_tag_voc_lp_t *self, twr_tag_voc_lp_event_t event, void *event_param)
+{
+    (void) event_param;
+
+    uint16_t value;
+
+    if (event == TWR_TAG_VOC_LP_EVENT_UPDATE && twr_tag_voc_lp_get_tvoc_ppb(self, &value))
+    {
+        twr_radio_report_feed(&_node.tvoc, value);
+    }
+}
+#endif
+
+#if NODE_CO2_MODULE
+static void _node_co2_module_event_handler(twr_module_co2_event_t event, void *event_param)
+{
+    (void) event_param;
+
+    float value;
+
+    if (event == TWR_MODULE_CO2_EVENT_UPDATE && twr_module_co2_get_concentration_ppm(&value))
+    {
+        twr_radio_report_feed(&_node.co2, value);
+    }
+}
+#endif
+
+#if NODE_BATTERY
+static void _node_battery_event_handler(twr_module_battery_event_t event, void *event_param)
+{
+    (void) event_param;
+
+    int percentage;
+
+    if (event != TWR_MODULE_BATTERY_EVENT_UPDATE)
+    {
+        return;
+    }
+
+    if (twr_module_battery_get_voltage(&_node.battery_voltage))
+    {
+        _node.battery_valid = true;
+
+        twr_radio_pub_battery(&_node.battery_voltage);
+    }
+
+    if (twr_module_battery_get_charge_level(&percentage))
+    {
+        _node.battery_percentage = percentage;
+    }
+}
+#endif
+
+void node_init(void)
+{
+    memset(&_node, 0, sizeof(_node));
+
+    // Defaults until gateway configuration is received
+#if NODE_BATTERY
+    _node.settings.battery_update_interval = NODE_BATTERY_UPDATE_INTERVAL;
+#endif
+#if NODE_HAS_TEMPERATURE
+    _node.settings.temperature_update_interval = NODE_TEMPERATURE_UPDATE_INTERVAL;
+    _node.settings.temperature.dead_band = NODE_TEMPERATURE_DEAD_BAND;
+    _node.settings.temperature.max_interval = NODE_HEARTBEAT_INTERVAL;
+    twr_radio_report_init(&_node.temperature, &_node.settings.temperature);
+    twr_radio_report_set_event_handler(&_node.temperature, _node_report_event_handler, NULL);
+#endif
+#if NODE_HAS_HUMIDITY
+    _node.settings.humidity_update_interval = NODE_HUMIDITY_UPDATE_INTERVAL;
+    _node.settings.humidity.dead_band = NODE_HUMIDITY_DEAD_BAND;
+    _node.settings.humidity.max_interval = NODE_HEARTBEAT_INTERVAL;
+    twr_radio_report_init(&_node.humidity, &_node.settings.humidity);
+    twr_radio_report_set_event_handler(&_node.humidity, _node_report_event_handler, NULL);
+#endif
+#if NODE_HAS_ILLUMINANCE
+    _node.settings.illuminance_update_interval = NODE_ILLUMINANCE_UPDATE_INTERVAL;
+    _node.settings.illuminance.dead_band = NODE_ILLUMINANCE_DEAD_BAND;
+    _node.settings.illuminance.max_interval = NODE_HEARTBEAT_INTERVAL;
+    twr_radio_report_init(&_node.illuminance, &_node.settings.illuminance);
+    twr_radio_report_set_event_handler(&_node.illuminance, _node_report_event_handler, NULL);
+#endif
+#if NODE_HAS_PRESSURE
+    _node.settings.pressure_update_interval = NODE_PRESSURE_UPDATE_INTERVAL;
+    _node.settings.pressure.dead_band = NODE_PRESSURE_DEAD_BAND;
+    _node.settings.pressure.max_interval = NODE_HEARTBEAT_INTERVAL;
+    twr_radio_report_init(&_node.pressure, &_node.settings.pressure);
+    twr_radio_report_set_event_handler(&_node.pressure, _node_report_event_handler, NULL);
+#endif
+#if NODE_HAS_CO2
+    _node.settings.co2_update_interval = NODE_CO2_UPDATE_INTERVAL;
+    _node.settings.co2.dead_band = NODE_CO2_DEAD_BAND;
+    _node.settings.co2.max_interval = NODE_HEARTBEAT_INTERVAL;
+    twr_radio_report_init(&_node.co2, &_node.settings.co2);
+    twr_radio_report_set_event_handler(&_node.co2, _node_report_event_handler, NULL);
+#endif
+#if NODE_HAS_TVOC
+    _node.settings.tvoc_update_interval = NODE_TVOC_UPDATE_INTERVAL;
+    _node.settings.tvoc.dead_band = NODE_TVOC_DEAD_BAND;
+    _node.settings.tvoc.max_interval = NODE_HEARTBEAT_INTERVAL;
+    twr_radio_report_init(&_node.tvoc, &_node.settings.tvoc);
+    twr_radio_report_set_event_handler(&_node.tvoc, _node_report_event_handler, NULL);
+#endif
+
+    // Initialize radio
+    twr_radio_init(TWR_RADIO_MODE_NODE_LISTENING);
+    twr_radio_set_rx_timeout_for_sleeping_node(500);
+    twr_radio_set_subs((twr_radio_sub_t *) _node_subs, sizeof(_node_subs) / sizeof(_node_subs[0]));
+
+#if NODE_BATTERY
+    twr_module_battery_init();
+    twr_module_battery_set_event_handler(_node_battery_event_handler, NULL);
+#endif
+
+#if NODE_THERMOMETER
+    twr_tmp112_init(&_node.tmp112, TWR_I2C_I2C0, 0x49);
+    twr_tmp112_set_event_handler(&_node.tmp112, _node_tmp112_event_handler, NULL);
+#endif
+
+#if NODE_CLIMATE_MODULE
+    twr_module_climate_init();
+    twr_module_climate_set_event_handler(_node_climate_module_event_handler, NULL);
+#endif
+
+#if NODE_TAG_HUMIDITY
+    twr_tag_humidity_init(&_node.tag_humidity, TWR_TAG_HUMIDITY_REVISION_R2, TWR_I2C_I2C0, TWR_TAG_HUMIDITY_I2C_ADDRESS_DEFAULT);
+    twr_tag_humidity_set_event_handler(&_node.tag_humidity, _node_tag_humidity_event_handler, NULL);
+#endif
+
+#if NODE_TAG_BAROMETER
+    twr_tag_barometer_init(&_node.tag_barometer, TWR_I2C_I2C0);
+    twr_tag_barometer_set_event_handler(&_node.tag_barometer, _node_tag_barometer_event_handler, NULL);
+#endif
+
+#if NODE_TAG_VOC_LP
+    twr_tag_voc_lp_init(&_node.tag_voc_lp, TWR_I2C_I2C0);
+    twr_tag_voc_lp_set_event_handler(&_node.tag_voc_lp, _node_tag_voc_lp_event_handler, NULL);
+#endif
+
+#if NODE_CO2_MODULE
+    twr_module_co2_init();
+    twr_module_co2_set_event_handler(_node_co2_module_event_handler, NULL);
+#endif
+
+    _node_sensors_update();
+
+    _node.task_id = twr_scheduler_register(_node_task, NULL, 0);
+}
+
+bool node_get_value(node_value_t value, float *out)
+{
+#if NODE_HAS_TEMPERATURE
+    if (value == NODE_VALUE_TEMPERATURE)
+    {
+        return twr_radio_report_get_value(&_node.temperature, out);
+    }
+#endif
+#if NODE_HAS_HUMIDITY
+    if (value == NODE_VALUE_HUMIDITY)
+    {
+        return twr_radio_report_get_value(&_node.humidity, out);
+    }
+#endif
+#if NODE_HAS_ILLUMINANCE
+    if (value == NODE_VALUE_ILLUMINANCE)
+    {
+        return twr_radio_report_get_value(&_node.illuminance, out);
+    }
+#endif
+#if NODE_HAS_PRESSURE
+    if (value == NODE_VALUE_PRESSURE)
+    {
+        return twr_radio_report_get_value(&_node.pressure, out);
+    }
+
+    if (value == NODE_VALUE_ALTITUDE)
+    {
+        *out = _node.altitude;
+
+        return _node.altitude_valid;
+    }
+#endif
+#if NODE_HAS_CO2
+    if (value == NODE_VALUE_CO2)
+    {
+        return twr_radio_report_get_value(&_node.co2, out);
+    }
+#endif
+#if NODE_HAS_TVOC
+    if (value == NODE_VALUE_TVOC)
+    {
+        return twr_radio_report_get_value(&_node.tvoc, out);
+    }
+#endif
+#if NODE_BATTERY
+    if (value == NODE_VALUE_BATTERY_VOLTAGE)
+    {
+        *out = _node.battery_voltage;
+
+        return _node.battery_valid;
+    }
+
+    if (value == NODE_VALUE_BATTERY_PERCENTAGE)
+    {
+        *out = _node.battery_percentage;
+
+        return _node.battery_valid;
+    }
+#endif
+
+    (void) value;
+    (void) out;
+
+    return false;
+}
+
+const node_settings_t *node_get_settings(void)
+{
+    return &_node.settings;
+}
+
+static void _node_task(void *param)
+{
+    (void) param;
+
+    // Pair under radio ID as soon as radio knows it
+    if (_node.radio_id == 0)
+    {
+        _node.radio_id = twr_radio_get_my_id();
+
+        if (_node.radio_id == 0)
+        {
+            twr_scheduler_plan_current_from_now(_NODE_PAIRING_RETRY_INTERVAL);
+
+            return;
+        }
+
+        snprintf(_node.radio_id_string, sizeof(_node.radio_id_string), "%llX", _node.radio_id);
+
+        twr_log_debug("Node: register with ID %s", _node.radio_id_string);
+
+        twr_radio_pairing_request(_node.radio_id_string, "1");
+    }
+
+    if (_node.config_received == (_NODE_CONFIG1 | _NODE_CONFIG2))
+    {
+        _node.config_received = 0;
+        _node.settings.configured = true;
+
+        _node_sensors_update();
+
+        bool applied = true;
+
+        twr_radio_pub_bool("settings/are/applied", &applied);
+    }
+}
+
+static void _node_get_config1(uint64_t *id, const char *topic, void *value, void *param)
+{
+    (void) id;
+    (void) topic;
+    (void) param;
+
+    _node_config_parse(_node_config1, value);
+
+    _node.config_received |= _NODE_CONFIG1;
+
+    twr_scheduler_plan_now(_node.task_id);
+}
+
+static void _node_get_config2(uint64_t *id, const char *topic, void *value, void *param)
+{
+    (void) id;
+    (void) topic;
+    (void) param;
+
+    _node_config_parse(_node_config2, value);
+
+    _node.config_received |= _NODE_CONFIG2;
+
+    twr_scheduler_plan_now(_node.task_id);
+}
+
+static void _node_config_parse(const _node_field_t *fields, const char *value)
+{
+    const char *p = value;
+
+    for (int i = 0; i < _NODE_CONFIG_FIELDS; i++)
+    {
+        char *end;
+        float number = strtof(p, &end);
+
+        if ((end != p) && (number >= 0.f) && (fields[i].type != _NODE_FIELD_NONE))
+        {
+            uint8_t *member = (uint8_t *) &_node.settings + fields[i].offset;
+
+            // Negative numbers are not accepted, configured dead band 0 publishes every sample
+            if (fields[i].type == _NODE_FIELD_VALUE)
+            {
+                memcpy(member, &number, sizeof(number));
+            }
+            else if ((number > 0.f) || (fields[i].type == _NODE_FIELD_HEARTBEAT))
+            {
+                twr_tick_t interval = (twr_tick_t) (number * 60 * 1000);
+
+                memcpy(member, &interval, sizeof(interval));
+            }
+        }
+
+        p = strchr(end, ',');
+
+        if (p == NULL)
+        {
+            break;
+        }
+
+        p++;
+    }
+}
+
+static void _node_sensors_update(void)
+{
+#if NODE_BATTERY
+    twr_module_battery_set_update_interval(_node.settings.battery_update_interval);
+#endif
+
+#if NODE_THERMOMETER
+    twr_tmp112_set_update_interval(&_node.tmp112, _node.settings.temperature_update_interval);
+#endif
+
+#if NODE_CLIMATE_MODULE
+    twr_module_climate_set_update_interval_thermometer(_node.settings.temperature_update_interval);
+    twr_module_climate_set_update_interval_hygrometer(_node.settings.humidity_update_interval);
+    twr_module_climate_set_update_interval_lux_meter(_node.settings.illuminance_update_interval);
+    twr_module_climate_set_update_interval_barometer(_node.settings.pressure_update_interval);
+    twr_module_climate_measure_all_sensors();
+#endif
+
+#if NODE_TAG_HUMIDITY
+    twr_tag_humidity_set_update_interval(&_node.tag_humidity, _node.settings.humidity_update_interval);
+#endif
+
+#if NODE_TAG_BAROMETER
+    twr_tag_barometer_set_update_interval(&_node.tag_barometer, _node.settings.pressure_update_interval);
+#endif
+
+#if NODE_TAG_VOC_LP
+    twr_tag_voc_lp_set_update_interval(&_node.tag_voc_lp, _node.settings.tvoc_update_interval);
+#endif
+
+#if NODE_CO2_MODULE
+    twr_module_co2_set_update_interval(_node.settings.co2_update_interval);
+#endif
+}
+
+static void _node_report_event_handler(twr_radio_report_t *self, twr_radio_report_event_t event, void *event_param)
+{
+    (void) event_param;
+
+    float value;
+
+    if ((event != TWR_RADIO_REPORT_EVENT_PUBLISH) || !twr_radio_report_get_value(self, &value))
+    {
+        return;
+    }
+
+#if NODE_HAS_TEMPERATURE
+    if (self == &_node.temperature)
+    {
+        twr_radio_pub_temperature(NODE_TEMPERATURE_CHANNEL, &value);
+    }
+#endif
+#if NODE_HAS_HUMIDITY
+    if (self == &_node.humidity)
+    {
+        twr_radio_pub_humidity(NODE_HUMIDITY_CHANNEL, &value);
+    }
+#endif
+#if NODE_HAS_ILLUMINANCE
+    if (self == &_node.illuminance)
+    {
+        twr_radio_pub_luminosity(NODE_ILLUMINANCE_CHANNEL, &value);
+    }
+#endif
+#if NODE_HAS_PRESSURE
+    if (self == &_node.pressure)
+    {
+        if (!_node.altitude_valid)
+        {
+            // Try again with next measurement
+            twr_radio_report_force(self);
+
+            return;
+        }
+
+        twr_radio_pub_barometer(NODE_PRESSURE_CHANNEL, &value, &_node.altitude);
+    }
+#endif
+#if NODE_HAS_CO2
+    if (self == &_node.co2)
+    {
+        twr_radio_pub_co2(&value);
+    }
+#endif
+#if NODE_HAS_TVOC
+    if (self == &_node.tvoc)
+    {
+        int tvoc = value;
+
+        twr_radio_pub_int("voc-lp-sensor/0:0/tvoc", &tvoc);
+    }
+#endif
+
+#if NODE_NOTIFY_APPLICATION
+    // Let application task show the new value
+    twr_scheduler_plan_now(0);
+#endif
+}
@@ -0,0 +1,237 @@
+#ifndef _NODE_H
+#define _NODE_H
+
+#include <twr.h>
+
+// Node description of the firmware variant, see "Node description" below
+#include <node_config.h>
+
+// Shared sensor pipeline of the Duncan firmware variants
+//
+// Every variant describes its node in src/node_config.h by defining which sensors are fitted, their radio channels,
+// update intervals and reporting policy. This file is compiled into the variant with that description, so only
+// the drivers of fitted sensors are referenced (and linked, unused ones are dropped by --gc-sections), every sensor
+// instance and setting is a plain member of one static structure sized for the variant and events are dispatched
+// by direct calls chosen at compile time.
+//
+// Node takes care of radio pairing under its radio ID, gateway configuration received on raps/-/get/config1 and
+// raps/-/get/config2, battery and publishing of measured values through twr_radio_report. Application keeps only
+// what is specific to the variant (buttons, PIR, GPS, NFC, LCD).
+//
+// Flash and RAM of a variant are printed by linker (--print-memory-usage), run time of node and sensor tasks is
+// available when the variant is built with TWR_PROFILE.
+
+// Node description, defaults for what variant does not define
+
+// Thermometer (TMP112) on Core Module
+#ifndef NODE_THERMOMETER
+#define NODE_THERMOMETER 0
+#endif
+
+// Climate Module (thermometer, hygrometer, lux meter and barometer)
+#ifndef NODE_CLIMATE_MODULE
+#define NODE_CLIMATE_MODULE 0
+#endif
+
+// Humidity Tag (revision R2)
+#ifndef NODE_TAG_HUMIDITY
+#define NODE_TAG_HUMIDITY 0
+#endif
+
+// Barometer Tag
+#ifndef NODE_TAG_BAROMETER
+#define NODE_TAG_BAROMETER 0
+#endif
+
+// VOC-LP Tag
+#ifndef NODE_TAG_VOC_LP
+#define NODE_TAG_VOC_LP 0
+#endif
+
+// CO2 Module
+#ifndef NODE_CO2_MODULE
+#define NODE_CO2_MODULE 0
+#endif
+
+// Battery Module (or Mini Battery Module)
+#ifndef NODE_BATTERY
+#define NODE_BATTERY 1
+#endif
+
+// Radio channels of published values
+#ifndef NODE_TEMPERATURE_CHANNEL
+#if NODE_THERMOMETER
+#define NODE_TEMPERATURE_CHANNEL TWR_RADIO_PUB_CHANNEL_R1_I2C0_ADDRESS_ALTERNATE
+#else
+#define NODE_TEMPERATURE_CHANNEL TWR_RADIO_PUB_CHANNEL_R1_I2C0_ADDRESS_DEFAULT
+#endif
+#endif
+
+#ifndef NODE_HUMIDITY_CHANNEL
+#if NODE_TAG_HUMIDITY
+#define NODE_HUMIDITY_CHANNEL TWR_RADIO_PUB_CHANNEL_R2_I2C0_ADDRESS_DEFAULT
+#else
+#define NODE_HUMIDITY_CHANNEL TWR_RADIO_PUB_CHANNEL_R1_I2C0_ADDRESS_DEFAULT
+#endif
+#endif
+
+#ifndef NODE_ILLUMINANCE_CHANNEL
+#define NODE_ILLUMINANCE_CHANNEL TWR_RADIO_PUB_CHANNEL_R1_I2C0_ADDRESS_DEFAULT
+#endif
+
+#ifndef NODE_PRESSURE_CHANNEL
+#define NODE_PRESSURE_CHANNEL TWR_RADIO_PUB_CHANNEL_R1_I2C0_ADDRESS_DEFAULT
+#endif
+
+// Sensors run on service intervals of gateway configuration instead of normal ones
+#ifndef NODE_UPDATE_SERVICE
+#define NODE_UPDATE_SERVICE 0
+#endif
+
+// Default update intervals in milliseconds (until gateway configuration is received)
+#ifndef NODE_BATTERY_UPDATE_INTERVAL
+#define NODE_BATTERY_UPDATE_INTERVAL (60 * 60 * 1000)
+#endif
+
+#ifndef NODE_TEMPERATURE_UPDATE_INTERVAL
+#define NODE_TEMPERATURE_UPDATE_INTERVAL (5 * 60 * 1000)
+#endif
+
+#ifndef NODE_HUMIDITY_UPDATE_INTERVAL
+#define NODE_HUMIDITY_UPDATE_INTERVAL (5 * 60 * 1000)
+#endif
+
+#ifndef NODE_ILLUMINANCE_UPDATE_INTERVAL
+#define NODE_ILLUMINANCE_UPDATE_INTERVAL (5 * 60 * 1000)
+#endif
+
+#ifndef NODE_PRESSURE_UPDATE_INTERVAL
+#define NODE_PRESSURE_UPDATE_INTERVAL (5 * 60 * 1000)
+#endif
+
+#ifndef NODE_CO2_UPDATE_INTERVAL
+#define NODE_CO2_UPDATE_INTERVAL (5 * 60 * 1000)
+#endif
+
+#ifndef NODE_TVOC_UPDATE_INTERVAL
+#define NODE_TVOC_UPDATE_INTERVAL (5 * 60 * 1000)
+#endif
+
+// Default reporting policy, value is published when it moves by dead band or when heartbeat interval elapses,
+// dead band 0 publishes every sample and TWR_RADIO_REPORT_DEAD_BAND_DISABLED publishes on heartbeat only
+#ifndef NODE_HEARTBEAT_INTERVAL
+#define NODE_HEARTBEAT_INTERVAL (15 * 60 * 1000)
+#endif
+
+#ifndef NODE_TEMPERATURE_DEAD_BAND
+#define NODE_TEMPERATURE_DEAD_BAND 0.2f
+#endif
+
+#ifndef NODE_HUMIDITY_DEAD_BAND
+#define NODE_HUMIDITY_DEAD_BAND 5.f
+#endif
+
+#ifndef NODE_ILLUMINANCE_DEAD_BAND
+#define NODE_ILLUMINANCE_DEAD_BAND 25.f
+#endif
+
+#ifndef NODE_PRESSURE_DEAD_BAND
+#define NODE_PRESSURE_DEAD_BAND 20.f
+#endif
+
+#ifndef NODE_CO2_DEAD_BAND
+#define NODE_CO2_DEAD_BAND 50.f
+#endif
+
+#ifndef NODE_TVOC_DEAD_BAND
+#define NODE_TVOC_DEAD_BAND 5.f
+#endif
+
+// Application task is planned after every publish (e.g. to redraw values on LCD)
+#ifndef NODE_NOTIFY_APPLICATION
+#define NODE_NOTIFY_APPLICATION 0
+#endif
+
+// Additional radio subscriptions of variant, comma terminated entries of twr_radio_sub_t
+#ifndef NODE_SUBS
+#define NODE_SUBS
+#endif
+
+// Measured quantities, each has its reporting instance when any fitted sensor provides it
+#define NODE_HAS_TEMPERATURE (NODE_THERMOMETER || NODE_CLIMATE_MODULE)
+#define NODE_HAS_HUMIDITY (NODE_CLIMATE_MODULE || NODE_TAG_HUMIDITY)
+#define NODE_HAS_ILLUMINANCE (NODE_CLIMATE_MODULE)
+#define NODE_HAS_PRESSURE (NODE_CLIMATE_MODULE || NODE_TAG_BAROMETER)
+#define NODE_HAS_CO2 (NODE_CO2_MODULE)
+#define NODE_HAS_TVOC (NODE_TAG_VOC_LP)
+
+#if NODE_THERMOMETER && NODE_CLIMATE_MODULE
+#error "Climate Module has its own thermometer, fit only one of them"
+#endif
+
+#if NODE_CLIMATE_MODULE && (NODE_TAG_HUMIDITY || NODE_TAG_BAROMETER)
+#error "Climate Module already measures humidity and pressure"
+#endif
+
+// Values kept by node
+
+typedef enum
+{
+    NODE_VALUE_TEMPERATURE = 0,
+    NODE_VALUE_HUMIDITY = 1,
+    NODE_VALUE_ILLUMINANCE = 2,
+    NODE_VALUE_PRESSURE = 3,
+    NODE_VALUE_ALTITUDE = 4,
+    NODE_VALUE_CO2 = 5,
+    NODE_VALUE_TVOC = 6,
+    NODE_VALUE_BATTERY_VOLTAGE = 7,
+    NODE_VALUE_BATTERY_PERCENTAGE = 8
+
+} node_value_t;
+
+// Settings of node, only the members of fitted sensors are present
+
+typedef struct
+{
+#if NODE_BATTERY
+    twr_tick_t battery_update_interval;
+#endif
+#if NODE_HAS_TEMPERATURE
+    twr_tick_t temperature_update_interval;
+    twr_radio_report_config_t temperature;
+#endif
+#if NODE_HAS_HUMIDITY
+    twr_tick_t humidity_update_interval;
+    twr_radio_report_config_t humidity;
+#endif
+#if NODE_HAS_ILLUMINANCE
+    twr_tick_t illuminance_update_interval;
+    twr_radio_report_config_t illuminance;
+#endif
+#if NODE_HAS_PRESSURE
+    twr_tick_t pressure_update_interval;
+    twr_radio_report_config_t pressure;
+#endif
+#if NODE_HAS_CO2
+    twr_tick_t co2_update_interval;
+    twr_radio_report_config_t co2;
+#endif
+#if NODE_HAS_TVOC
+    twr_tick_t tvoc_update_interval;
+    twr_radio_report_config_t tvoc;
+#endif
+    // Keeps structure valid when nothing is fitted
+    bool configured;
+
+} node_settings_t;
+
+// Initialize radio, battery and fitted sensors and start pairing, called from application_init after twr_log_init
+void node_init(void);
+
+// Get last published value (or last measured value for altitude and battery percentage)
+bool node_get_value(node_value_t value, float *out);
+
+// Get current settings
+const node_settings_t *node_get_settings(void);
+
+#endif // _NODE_H
@@ -0,0 +1,76 @@
+#!/usr/bin/env python3
+"""Tests of twr_bitpack.py, run by "python3 -m unittest" from this directory.
+
+Expected messages were produced by twr_bitpack_encode() of the SDK compiled for host.
+"""
+
+import math
+import unittest
+
+import twr_bitpack
+
+NAN = float('nan')
+
+
+class TestBitpack(unittest.TestCase):
+
+    def setUp(self):
+        self.sensors = twr_bitpack.parse_schema('t:-40:0.1:11,h:0:0.5:8,x:0:1:3')
+        self.wide = twr_bitpack.parse_schema('c:0:1:32,q:-1:0.25:5')
+
+    def test_parse_schema(self):
+        self.assertEqual(self.sensors, [('t', -40.0, 0.1, 11), ('h', 0.0, 0.5, 8), ('x', 0.0, 1.0, 3)])
+        self.assertEqual(twr_bitpack.length(self.sensors), 3)
+        self.assertEqual(twr_bitpack.length(self.wide), 5)
+        for text in ('t:0:1:0', 't:0:1:33', 't:0:0:8', 't:0:1'):
+            with self.assertRaises(ValueError):
+                twr_bitpack.parse_schema(text)
+
+    def test_encode_matches_c_encoder(self):
+        vectors = [
+            (self.sensors, [22.35, 55, NAN], '4e0ddc'),
+            (self.sensors, [-100, 1000, 6], '001fd8'),
+            (self.sensors, [1000, -5, 7], 'ffc018'),
+            (self.wide, [123456, 2.5], '0001e24070'),
+            (self.wide, [NAN, NAN], 'fffffffff8'),
+            (self.wide, [4e9, -3], 'ee6b280000'),
+        ]
+        for fields, values, message in vectors:
+            self.assertEqual(twr_bitpack.encode(fields, values).hex(), message)
+
+    def test_clamp(self):
+        # Below minimum gives the lowest code, above range the highest code which is not the missing value
+        self.assertEqual(twr_bitpack.decode(self.sensors, twr_bitpack.encode(self.sensors, [-100, 1000, 7])),
+                         [-40.0, 127.0, 6.0])
+
+    def test_missing_value(self):
+        # Padding after the last field is zero
+        self.assertEqual(twr_bitpack.encode(self.sensors, [None, None, None]).hex(), 'fffffc')
+        self.assertEqual(twr_bitpack.decode(self.sensors, bytes.fromhex('ffffff')), [None, None, None])
+        self.assertEqual(twr_bitpack.decode(self.wide, twr_bitpack.encode(self.wide, [NAN, 0])), [None, 0.0])
+
+    def test_decode(self):
+        t, h, x = twr_bitpack.decode(self.sensors, bytes.fromhex('4e0ddc'))
+        self.assertAlmostEqual(t, 22.4, places=6)
+        self.assertEqual(h, 55.0)
+        self.assertIsNone(x)
+        # Trailing bytes after the message are ignored
+        self.assertEqual(twr_bitpack.decode(self.wide, bytes.fromhex('0001e24070ff')), [123456.0, 2.5])
+        with self.assertRaises(ValueError):
+            twr_bitpack.decode(self.wide, bytes.fromhex('0001e240'))
+
+    def test_32_bit_field(self):
+        # Highest code is the missing value, so the largest value is one step below it
+        for value in (0, 1, 0xfffffffe):
+            self.assertEqual(twr_bitpack.decode(self.wide, twr_bitpack.encode(self.wide, [value, -1]))[0], value)
+        self.assertEqual(twr_bitpack.decode(self.wide, twr_bitpack.encode(self.wide, [2 ** 33, -1]))[0], 0xfffffffe)
+
+    def test_round_trip(self):
+        for t in (-40, -0.05, 0, 21.7, 164.6):
+            decoded = twr_bitpack.decode(self.sensors, twr_bitpack.encode(self.sensors, [t, 50, 3]))
+            self.assertLessEqual(abs(decoded[0] - t), 0.05 + 1e-9)
+            self.assertFalse(math.isnan(decoded[0]))
+
+
+if __name__ == '__main__':
+    unittest.main()
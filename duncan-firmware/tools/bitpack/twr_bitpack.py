@@ -0,0 +1,101 @@
+#!/usr/bin/env python3
+"""Encode and decode messages packed by twr_bitpack.
+
+Schema is a comma separated list of fields "name:min:resolution:bits" in the order of the twr_bitpack_field_t
+table on the node, e.g. "temperature:-40:0.1:11,humidity:0:0.5:8". Fields follow each other MSB first without
+padding, the highest code of a field (all ones) marks missing value.
+"""
+
+import argparse
+import math
+import sys
+
+SIGFOX_MESSAGE_SIZE = 12
+SIGFOX_MESSAGES_PER_DAY = 140
+
+
+def parse_schema(text):
+    fields = []
+    for item in text.split(','):
+        name, minimum, resolution, bits = item.strip().split(':')
+        bits = int(bits)
+        if not 1 <= bits <= 32 or float(resolution) <= 0:
+            raise ValueError('invalid field: %s' % item)
+        fields.append((name, float(minimum), float(resolution), bits))
+    return fields
+
+
+def length(fields):
+    return (sum(field[3] for field in fields) + 7) // 8
+
+
+def encode(fields, values):
+    code_stream = 0
+    total = 0
+    for (name, minimum, resolution, bits), value in zip(fields, values):
+        none = (1 << bits) - 1
+        if value is None or math.isnan(value):
+            code = none
+        else:
+            code = min(max(math.floor((value - minimum) / resolution + 0.5), 0), none - 1)
+        code_stream = (code_stream << bits) | code
+        total += bits
+    padding = length(fields) * 8 - total
+    return (code_stream << padding).to_bytes(length(fields), 'big')
+
+
+def decode(fields, data):
+    if len(data) < length(fields):
+        raise ValueError('message is shorter than schema')
+    code_stream = int.from_bytes(data[:length(fields)], 'big')
+    position = length(fields) * 8
+    values = []
+    for name, minimum, resolution, bits in fields:
+        position -= bits
+        code = (code_stream >> position) & ((1 << bits) - 1)
+        values.append(None if code == (1 << bits) - 1 else minimum + code * resolution)
+    return values
+
+
+def info(fields):
+    bits = sum(field[3] for field in fields)
+    print('%-16s %10s %10s %10s %5s' % ('field', 'min', 'max', 'resolution', 'bits'))
+    for name, minimum, resolution, width in fields:
+        maximum = minimum + ((1 << width) - 2) * resolution
+        print('%-16s %10g %10g %10g %5d' % (name, minimum, maximum, resolution, width))
+    print('message: %d bits in %d bytes, %.0f %% of SigFox message' %
+          (bits, length(fields), 100.0 * bits / (SIGFOX_MESSAGE_SIZE * 8)))
+    # Compare with the usual encoding of one 16-bit integer per channel
+    naive = (len(fields) * 2 + SIGFOX_MESSAGE_SIZE - 1) // SIGFOX_MESSAGE_SIZE
+    packed = (length(fields) + SIGFOX_MESSAGE_SIZE - 1) // SIGFOX_MESSAGE_SIZE
+    print('messages per report: %d packed, %d as 16-bit integers' % (packed, naive))
+    print('reports per day at %d messages: %d packed, %d as 16-bit integers' %
+          (SIGFOX_MESSAGES_PER_DAY, SIGFOX_MESSAGES_PER_DAY // packed, SIGFOX_MESSAGES_PER_DAY // naive))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('schema', help='schema "name:min:resolution:bits,..."')
+    subparsers = parser.add_subparsers(dest='command', required=True)
+    parser_decode = subparsers.add_parser('decode', help='decode message given as hex')
+    parser_decode.add_argument('message')
+    parser_encode = subparsers.add_parser('encode', help='encode values (nan for missing value) to hex')
+    parser_encode.add_argument('values', nargs='+', type=float)
+    subparsers.add_parser('info', help='show ranges and message budget of schema')
+    args = parser.parse_args()
+
+    fields = parse_schema(args.schema)
+
+    if args.command == 'decode':
+        for (name, minimum, resolution, bits), value in zip(fields, decode(fields, bytes.fromhex(args.message))):
+            print('%s: %s' % (name, 'null' if value is None else round(value, 6)))
+    elif args.command == 'encode':
+        if len(args.values) != len(fields):
+            sys.exit('expected %d values' % len(fields))
+        print(encode(fields, args.values).hex())
+    else:
+        info(fields)
+
+
+if __name__ == '__main__':
+    main()
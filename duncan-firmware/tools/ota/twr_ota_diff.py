@@ -0,0 +1,154 @@
+#!/usr/bin/env python3
+"""Create patch for twr_radio_ota from running image to new image.
+
+Patch is a sequence of operations:
+  0x00 <length varint> <zig-zag source offset relative to output offset varint>  copy from running image
+  0x01 <length varint> <bytes>                                                 literal bytes
+"""
+
+import argparse
+import hashlib
+import sys
+
+OP_COPY = 0x00
+OP_LITERAL = 0x01
+GRAM = 8
+CANDIDATES = 16
+
+
+def varint(value):
+    out = bytearray()
+    while True:
+        byte = value & 0x7f
+        value >>= 7
+        if value:
+            out.append(byte | 0x80)
+        else:
+            out.append(byte)
+            return out
+
+
+def zigzag(value):
+    return ((-value) << 1) - 1 if value < 0 else value << 1
+
+
+def diff(old, new):
+    index = {}
+    for i in range(len(old) - GRAM + 1):
+        index.setdefault(old[i:i + GRAM], []).append(i)
+
+    patch = bytearray()
+    literal = bytearray()
+    delta = 0
+    i = 0
+
+    def match_length(source, target):
+        limit = min(len(old) - source, len(new) - target)
+        length, step = 0, 8
+        # Gallop over equal blocks, then narrow down to the first difference
+        while step:
+            step = min(step, limit - length)
+            if step and old[source + length:source + length + step] == new[target + length:target + length + step]:
+                length += step
+                step *= 2
+            else:
+                step //= 2
+        return length
+
+    def flush_literal():
+        if literal:
+            patch.append(OP_LITERAL)
+            patch.extend(varint(len(literal)))
+            patch.extend(literal)
+            literal.clear()
+
+    while i < len(new):
+        best_source, best_length = None, 0
+
+        # Continuation of previous shift is preferred, its copy costs least
+        if 0 <= i + delta < len(old):
+            best_source, best_length = i + delta, match_length(i + delta, i)
+
+        for source in index.get(new[i:i + GRAM], [])[-CANDIDATES:]:
+            length = match_length(source, i)
+            if length > best_length:
+                best_source, best_length = source, length
+
+        cost = 1 + len(varint(best_length)) + len(varint(zigzag(best_source - i))) if best_source is not None else 0
+
+        if best_length > cost + 1:
+            flush_literal()
+            delta = best_source - i
+            patch.append(OP_COPY)
+            patch.extend(varint(best_length))
+            patch.extend(varint(zigzag(delta)))
+            i += best_length
+        else:
+            literal.append(new[i])
+            i += 1
+
+    flush_literal()
+
+    return bytes(patch)
+
+
+def apply(old, patch):
+    """Reference decoder, mirrors twr_radio_ota.c."""
+    out = bytearray()
+    position = 0
+
+    def read_varint():
+        nonlocal position
+        value, shift = 0, 0
+        while True:
+            byte = patch[position]
+            position += 1
+            value |= (byte & 0x7f) << shift
+            shift += 7
+            if not byte & 0x80:
+                return value
+
+    while position < len(patch):
+        op = patch[position]
+        position += 1
+        length = read_varint()
+        if op == OP_COPY:
+            value = read_varint()
+            source = len(out) + ((value >> 1) ^ -(value & 1))
+            if source < 0 or source + length > len(old):
+                raise ValueError('copy outside of running image')
+            out += old[source:source + length]
+        elif op == OP_LITERAL:
+            out += patch[position:position + length]
+            position += length
+        else:
+            raise ValueError('unknown operation 0x%02x' % op)
+
+    return bytes(out)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('old', help='image running on node (empty file for full image)')
+    parser.add_argument('new', help='new image')
+    parser.add_argument('patch', help='output patch')
+    args = parser.parse_args()
+
+    old = open(args.old, 'rb').read()
+    new = open(args.new, 'rb').read()
+
+    patch = diff(old, new)
+
+    if apply(old, patch) != new:
+        sys.exit('patch does not reproduce new image')
+
+    with open(args.patch, 'wb') as f:
+        f.write(patch)
+
+    print('image_size: %d' % len(new))
+    print('patch_size: %d' % len(patch))
+    print('sha256: %s' % hashlib.sha256(new).hexdigest())
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,103 @@
+#!/usr/bin/env python3
+"""Bridge between gateway in USB CDC framing mode and MQTT broker.
+
+Frame: 0xa5 0x5a, records length (uint16 LE), sequence (uint8), records, CRC16 CCITT (LE) over length..records.
+Record: type (uint8), length (uint8), payload.
+"""
+
+import argparse
+import json
+import logging
+import struct
+
+import paho.mqtt.client as mqtt
+import serial
+
+RECORD_RAW = 0
+RECORD_PUBLISH = 1
+
+
+def crc16(data, crc=0xffff):
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xffff
+    return crc
+
+
+def frames(port):
+    buffer = bytearray()
+    while True:
+        buffer += port.read(port.in_waiting or 1)
+        while True:
+            start = buffer.find(b'\xa5\x5a')
+            if start < 0:
+                del buffer[:-1]
+                break
+            del buffer[:start]
+            if len(buffer) < 5:
+                break
+            length, sequence = struct.unpack_from('<HB', buffer, 2)
+            if len(buffer) < 5 + length + 2:
+                break
+            crc, = struct.unpack_from('<H', buffer, 5 + length)
+            if crc16(buffer[2:5 + length]) != crc:
+                logging.warning('CRC mismatch, resynchronizing')
+                del buffer[:2]
+                continue
+            yield sequence, bytes(buffer[5:5 + length])
+            del buffer[:5 + length + 2]
+
+
+def records(data):
+    offset = 0
+    while offset + 2 <= len(data):
+        record_type, length = data[offset], data[offset + 1]
+        yield record_type, data[offset + 2:offset + 2 + length]
+        offset += 2 + length
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('-d', '--device', default='/dev/ttyACM0')
+    parser.add_argument('-H', '--host', default='127.0.0.1')
+    parser.add_argument('-P', '--port', type=int, default=1883)
+    parser.add_argument('-p', '--prefix', default='', help='topic prefix (e.g. gateway/)')
+    args = parser.parse_args()
+
+    logging.basicConfig(level=logging.INFO, format='%(asctime)s %(levelname)s %(message)s')
+
+    client = mqtt.Client()
+    client.connect(args.host, args.port)
+    client.loop_start()
+
+    port = serial.Serial(args.device, timeout=1)
+
+    line = bytearray()
+    expected = None
+
+    for sequence, data in frames(port):
+        if expected is not None and sequence != expected:
+            logging.warning('Lost %d frame(s)', (sequence - expected) & 0xff)
+        expected = (sequence + 1) & 0xff
+
+        for record_type, payload in records(data):
+            if record_type == RECORD_PUBLISH:
+                topic, _, value = payload.partition(b'\0')
+                client.publish(args.prefix + topic.decode(), value)
+
+            elif record_type == RECORD_RAW:
+                # Text lines of gateway are JSON arrays [topic, value]
+                line += payload
+                while b'\n' in line:
+                    text, _, line[:] = line.partition(b'\n')
+                    try:
+                        topic, value = json.loads(text)
+                    except ValueError:
+                        continue
+                    client.publish(args.prefix + topic, json.dumps(value))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,66 @@
+#ifndef _TWR_BITPACK_H
+#define _TWR_BITPACK_H
+
+#include <twr_data_stream.h>
+
+//! @addtogroup twr_bitpack twr_bitpack
+//! @brief Schema driven bit packing of float values into short messages (e.g. 12 bytes of SigFox)
+//! @details Each field of schema is quantized to its resolution above its minimum and stored in its bit width, fields
+//!          follow each other MSB first without padding. Values below range are stored as minimum, values above as
+//!          the highest code but one, the highest code (all ones) marks missing value (NAN). Schema given as
+//!          "name:min:resolution:bits,..." to duncan-firmware/tools/bitpack/twr_bitpack.py decodes messages on host.
+//! @{
+
+//! @brief Field of schema
+
+typedef struct
+{
+    //! @brief Value stored as code 0
+    float min;
+
+    //! @brief Step between codes (e.g. 0.1 for temperature)
+    float resolution;
+
+    //! @brief Width of field in bits (1 to 32)
+    uint8_t bits;
+
+} twr_bitpack_field_t;
+
+//! @brief Get length of message
+//! @param[in] fields Schema
+//! @param[in] count Number of fields
+//! @return Length of message in bytes
+
+size_t twr_bitpack_get_length(const twr_bitpack_field_t *fields, int count);
+
+//! @brief Encode values into message
+//! @param[in] fields Schema
+//! @param[in] count Number of fields
+//! @param[in] values Values, one for each field (NAN for missing value)
+//! @param[out] buffer Message
+//! @param[in] size Size of buffer
+//! @return Length of message in bytes
+//! @return 0 If message does not fit buffer or schema is invalid
+
+size_t twr_bitpack_encode(const twr_bitpack_field_t *fields, int count, const float *values, uint8_t *buffer, size_t size);
+
+//! @brief Decode values from message
+//! @param[in] fields Schema
+//! @param[in] count Number of fields
+//! @param[in] buffer Message
+//! @param[in] length Length of message
+//! @param[out] values Values, one for each field (NAN for missing value)
+//! @return true On success
+//! @return false If message is shorter than schema or schema is invalid
+
+bool twr_bitpack_decode(const twr_bitpack_field_t *fields, int count, const uint8_t *buffer, size_t length, float *values);
+
+//! @brief Get summary of float data stream for three consecutive fields
+//! @param[in] stream Data stream
+//! @param[out] values Minimum, average and maximum (NAN if stream is empty)
+
+void twr_bitpack_get_summary(twr_data_stream_t *stream, float *values);
+
+//! @}
+
+#endif // _TWR_BITPACK_H
@@ -7,6 +7,12 @@
 //! @brief Driver for internal EEPROM memory
 //! @{
 
+//! @brief Size of EEPROM region for which write count is tracked
+
+#ifndef TWR_EEPROM_PAGE_SIZE
+#define TWR_EEPROM_PAGE_SIZE 128
+#endif
+
 typedef enum
 {
     //! @brief EEPROM event sync write error
@@ -18,6 +24,7 @@ typedef enum
 } twr_eepromc_event_t;
 
 //! @brief Write buffer to EEPROM area and verify it
+//! @details Async write in progress is completed first (its event handler is still called from its task).
 //! @param[in] address EEPROM start address (starts at 0)
 //! @param[in] buffer Pointer to source buffer
 //! @param[in] length Number of bytes to be written
@@ -27,6 +34,8 @@ typedef enum
 bool twr_eeprom_write(uint32_t address, const void *buffer, size_t length);
 
 //! @brief Async write buffer to EEPROM area and verify it
+//! @details Only words whose content changes are programmed, one word per scheduler run, so the caller is never blocked
+//!          for the whole transfer. Buffer has to stay valid until the event handler is called.
 //! @param[in] address EEPROM start address (starts at 0)
 //! @param[in] buffer Pointer to source buffer
 //! @param[in] length Number of bytes to be written
@@ -41,6 +50,12 @@ bool twr_eeprom_async_write(uint32_t address, const void *buffer, size_t length,
 
 void twr_eeprom_async_cancel(void);
 
+//! @brief Check if async write is in progress
+//! @return true If async write is in progress
+//! @return false If async write is not in progress
+
+bool twr_eeprom_is_busy(void);
+
 //! @brief Read buffer from EEPROM area
 //! @param[in] address EEPROM start address (starts at 0)
 //! @param[out] buffer Pointer to destination buffer
@@ -55,6 +70,19 @@ bool twr_eeprom_read(uint32_t address, void *buffer, size_t length);
 
 size_t twr_eeprom_get_size(void);
 
+//! @brief Return number of EEPROM pages with tracked write count
+//! @return Number of pages
+
+size_t twr_eeprom_get_page_count(void);
+
+//! @brief Return number of word programs into page since boot
+//! @details Counters are kept in RAM only and start from zero after reset, they are meant for diagnostics (e.g. to
+//!          see which data are rewritten too often), not for placement of data.
+//! @param[in] page Page index (address / TWR_EEPROM_PAGE_SIZE)
+//! @return Number of word programs
+
+uint32_t twr_eeprom_get_page_write_count(size_t page);
+
 //! @}
 
 #endif // _TWR_EEPROM_H
@@ -111,6 +111,7 @@ struct twr_esp8266_t
     uint8_t _message_buffer[TWR_ESP8266_TX_MAX_PACKET_SIZE];
     size_t _message_length;
     size_t _message_part_length;
+    twr_tick_t _message_timeout;
     uint8_t _init_command_index;
     uint8_t _timeout_cnt;
     twr_esp8266_config _config;
@@ -2,6 +2,7 @@
 #define _TWR_MODULE_BATTERY_H
 
 #include <twr_tick.h>
+#include <twr_fixed.h>
 
 //! @addtogroup twr_module_battery twr_module_battery
 //! @brief Driver for Battery Module
@@ -61,6 +62,12 @@ void twr_module_battery_set_update_interval(twr_tick_t interval);
 
 void twr_module_battery_set_threshold_levels(float level_low_threshold, float level_critical_threshold);
 
+//! @brief Set voltage levels as fixed-point values
+//! @param[in] level_low_threshold Voltage level considered as low
+//! @param[in] level_critical_threshold Voltage level considered as critical
+
+void twr_module_battery_set_threshold_levels_fixed(twr_fixed_t level_low_threshold, twr_fixed_t level_critical_threshold);
+
 //! @brief Get Battery Module format
 
 twr_module_battery_format_t twr_module_battery_get_format();
@@ -78,6 +85,13 @@ bool twr_module_battery_measure(void);
 
 bool twr_module_battery_get_voltage(float *voltage);
 
+//! @brief Get Battery Module voltage as fixed-point value
+//! @param[out] voltage Measured voltage
+//! @return true On success
+//! @return false On failure
+
+bool twr_module_battery_get_voltage_fixed(twr_fixed_t *voltage);
+
 //! @brief Get Battery Module charge in percents
 //! @param[out] percentage Measured charge
 //! @return true On success
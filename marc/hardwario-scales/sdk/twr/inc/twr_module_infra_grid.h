@@ -4,6 +4,7 @@
 #include <twr_i2c.h>
 #include <twr_tca9534a.h>
 #include <twr_scheduler.h>
+#include <twr_fixed.h>
 
 //! @addtogroup twr_module_infra_grid twr_module_infra_grid
 //! @brief Library to communicate with Infra Grid Module with Panasonic AMG8833 Grid-EYE sensor
@@ -116,12 +117,34 @@ bool twr_module_infra_grid_read_values(twr_module_infra_grid_t *self);
 
 bool twr_module_infra_grid_get_temperatures_celsius(twr_module_infra_grid_t *self, float *values);
 
+//! @brief Get measured temperature as a array of integers in quarters of degree of Celsius
+//! @param[in] self Instance
+//! @param[out] values Pointer to int16_t array of size 64 where result will be stored
+//! @return true When values are valid
+//! @return false When values are invalid
+
+bool twr_module_infra_grid_get_temperatures_raw(twr_module_infra_grid_t *self, int16_t *values);
+
+//! @brief Get measured temperature in degrees of Celsius as a array of fixed-point values
+//! @param[in] self Instance
+//! @param[out] values Pointer to twr_fixed_t array of size 64 where result will be stored
+//! @return true When values are valid
+//! @return false When values are invalid
+
+bool twr_module_infra_grid_get_temperatures_fixed(twr_module_infra_grid_t *self, twr_fixed_t *values);
+
 //! @brief Read and return thermistor temperature sensor value
 //! @param[in] self Instance
 //! @return value in degreen of Celsius
 
 float twr_module_infra_grid_read_thermistor(twr_module_infra_grid_t *self);
 
+//! @brief Read and return thermistor temperature sensor value as fixed-point value
+//! @param[in] self Instance
+//! @return value in degreen of Celsius
+
+twr_fixed_t twr_module_infra_grid_read_thermistor_fixed(twr_module_infra_grid_t *self);
+
 //! @brief Get module revision
 //! @param[in] self Instance
 //! @return module revision
@@ -0,0 +1,88 @@
+#ifndef _TWR_RADIO_PUB_COMPACT_H
+#define _TWR_RADIO_PUB_COMPACT_H
+
+#include <twr_radio.h>
+
+//! @addtogroup twr_radio_pub_compact twr_radio_pub_compact
+//! @brief Compact telemetry for slow-changing float values in custom topics
+//! @details Topics are given once as a table, the index in the table is the topic ID on air. Each topic is registered
+//!          at gateway with its subtopic and resolution, afterwards values are sent quantized to the resolution as
+//!          zig-zag varint deltas against the last value acknowledged by gateway. Deltas are sent only after gateway
+//!          acknowledged the registration of topic, absolute values until then. Values published in the same
+//!          scheduler pass share one radio frame. Deltas are computed right before transmission, so frames waiting
+//!          in the queue or in twr_radio_store are self-contained and survive lost acknowledgements.
+//!          Registration is repeated and absolute values are sent periodically, so a restarted gateway recovers.
+//!          Gateway reports values through twr_radio_pub_on_float, it has to be built with
+//!          TWR_RADIO_PUB_COMPACT_GATEWAY_TOPICS defined to the number of topics it tracks across all nodes.
+//! @{
+
+//! @brief Maximum number of topics in the table of node
+
+#ifndef TWR_RADIO_PUB_COMPACT_MAX_TOPICS
+#define TWR_RADIO_PUB_COMPACT_MAX_TOPICS 16
+#endif
+
+//! @brief Every n-th value of topic is sent as absolute value
+
+#ifndef TWR_RADIO_PUB_COMPACT_KEY_INTERVAL
+#define TWR_RADIO_PUB_COMPACT_KEY_INTERVAL 16
+#endif
+
+//! @brief Every n-th value of topic is preceded by registration of topic
+
+#ifndef TWR_RADIO_PUB_COMPACT_REG_INTERVAL
+#define TWR_RADIO_PUB_COMPACT_REG_INTERVAL 64
+#endif
+
+//! @brief Number of topics gateway decodes (0 on nodes)
+
+#ifndef TWR_RADIO_PUB_COMPACT_GATEWAY_TOPICS
+#define TWR_RADIO_PUB_COMPACT_GATEWAY_TOPICS 0
+#endif
+
+//! @brief Maximum subtopic length including terminating zero
+
+#define TWR_RADIO_PUB_COMPACT_SUBTOPIC_SIZE 32
+
+//! @brief Topic
+
+typedef struct
+{
+    //! @brief Subtopic (example: node/{id}/{subtopic})
+    const char *subtopic;
+
+    //! @brief Resolution values are quantized to (e.g. 0.01 for temperature)
+    float resolution;
+
+} twr_radio_pub_compact_topic_t;
+
+//! @brief Initialize compact telemetry
+//! @details Call after twr_radio_init, the compact telemetry is linked to radio by this call only.
+//! @param[in] topics Table of topics, index is the topic ID (must stay valid)
+//! @param[in] count Number of topics (at most TWR_RADIO_PUB_COMPACT_MAX_TOPICS)
+
+void twr_radio_pub_compact_init(const twr_radio_pub_compact_topic_t *topics, int count);
+
+//! @brief Publish float value in compact topic
+//! @param[in] topic Topic ID (index in table)
+//! @param[in] value Pointer to value, can be null
+//! @return true On success
+//! @return false On failure (unknown topic, value out of range of resolution or full queue)
+
+bool twr_radio_pub_compact(int topic, float *value);
+
+//! @brief Queue values published so far without waiting for end of scheduler pass
+//! @return true On success
+//! @return false On full queue (values stay pending and are queued later)
+
+bool twr_radio_pub_compact_flush(void);
+
+//! @cond
+
+void _twr_radio_pub_compact_decode(uint64_t *id, uint8_t *buffer, size_t length);
+
+//! @endcond
+
+//! @}
+
+#endif // _TWR_RADIO_PUB_COMPACT_H
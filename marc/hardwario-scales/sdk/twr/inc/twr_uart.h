@@ -6,6 +6,8 @@
 
 //! @addtogroup twr_uart twr_uart
 //! @brief Driver for UART (universal asynchronous receiver/transmitter)
+//! @details Async transfers use DMA channels 6 and 7 (UART0, UART1) or 3 and 4 (UART2). UART0 and UART1 share the
+//!          channels, the one started later falls back to interrupt driven transfer.
 //! @{
 
 //! @brief UART channels
@@ -133,10 +135,25 @@ typedef enum
     TWR_UART_EVENT_ASYNC_READ_DATA = 1,
 
     //! @brief Event is timeout
-    TWR_UART_EVENT_ASYNC_READ_TIMEOUT = 2
+    TWR_UART_EVENT_ASYNC_READ_TIMEOUT = 2,
+
+    //! @brief Event is loss of received data (read FIFO was not read in time and its content was dropped)
+    TWR_UART_EVENT_ASYNC_READ_OVERRUN = 3
 
 } twr_uart_event_t;
 
+//! @brief Buffer descriptor for scatter-gather write and zero-copy read
+
+typedef struct
+{
+    //! @brief Pointer to data
+    const void *buffer;
+
+    //! @brief Length of data in bytes
+    size_t length;
+
+} twr_uart_buffer_t;
+
 //! @brief Initialize UART channel
 //! @param[in] channel UART channel
 //! @param[in] config UART configuration
@@ -187,6 +204,16 @@ void twr_uart_set_async_fifo(twr_uart_channel_t channel, twr_fifo_t *write_fifo,
 
 size_t twr_uart_async_write(twr_uart_channel_t channel, const void *buffer, size_t length);
 
+//! @brief Transmit buffers in async mode without copying
+//! @details Buffers and the array of descriptors must stay valid until TWR_UART_EVENT_ASYNC_WRITE_DONE.
+//! @param[in] channel UART channel
+//! @param[in] buffers Array of buffer descriptors
+//! @param[in] count Number of buffer descriptors
+//! @return true On success
+//! @return false If channel is not initialized or async write is in progress
+
+bool twr_uart_async_write_buffers(twr_uart_channel_t channel, const twr_uart_buffer_t *buffers, size_t count);
+
 //! @brief Start async reading
 //! @param[in] channel UART channel
 //! @param[in] timeout Maximum timeout in ms
@@ -210,6 +237,23 @@ bool twr_uart_async_read_cancel(twr_uart_channel_t channel);
 
 size_t twr_uart_async_read(twr_uart_channel_t channel, void *buffer, size_t length);
 
+//! @brief Get next complete line received in async mode without copying
+//! @details Line points into read FIFO and stays valid until released by twr_uart_async_read_release. Second part is
+//!          used when line wraps around the end of FIFO buffer, otherwise its length is 0.
+//! @param[in] channel UART channel
+//! @param[out] line Array of two buffer descriptors
+//! @param[in] terminator Character ending the line or record
+//! @return Length of line including terminator, length of FIFO content if FIFO is full without terminator or 0 if
+//!         there is no complete line
+
+size_t twr_uart_async_read_line(twr_uart_channel_t channel, twr_uart_buffer_t *line, char terminator);
+
+//! @brief Release data received in async mode
+//! @param[in] channel UART channel
+//! @param[in] length Number of bytes to be released
+
+void twr_uart_async_read_release(twr_uart_channel_t channel, size_t length);
+
 //! @}
 
 #endif // _TWR_UART_H
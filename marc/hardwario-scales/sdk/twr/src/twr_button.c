@@ -1,20 +1,38 @@
 #include <twr_button.h>
+#include <twr_irq.h>
 
 #define _TWR_BUTTON_SCAN_INTERVAL 20
 #define _TWR_BUTTON_DEBOUNCE_TIME 50
 #define _TWR_BUTTON_CLICK_TIMEOUT 500
 #define _TWR_BUTTON_HOLD_TIME 2000
 
+// Armed button still checks its pin now and then, edges are lost once another driver takes the EXTI line over
+#define _TWR_BUTTON_EXTI_WATCHDOG_INTERVAL 1000
+
+// Buttons waiting for edge, virtual buttons of one expander can share EXTI line
+static twr_button_t *_twr_button_exti_armed;
+
 static void _twr_button_task(void *param);
 
+static int _twr_button_get_pin_state(twr_button_t *self);
+
+static bool _twr_button_exti_arm(twr_button_t *self);
+
+static void _twr_button_exti_disarm(twr_button_t *self);
+
+static void _twr_button_exti_handler(twr_exti_line_t line, void *param);
+
 static void _twr_button_gpio_init(twr_button_t *self);
 
 static int _twr_button_gpio_get_input(twr_button_t *self);
 
+static bool _twr_button_gpio_get_exti_line(twr_button_t *self, twr_exti_line_t *line);
+
 static const twr_button_driver_t _twr_button_driver_gpio =
 {
     .init = _twr_button_gpio_init,
     .get_input = _twr_button_gpio_get_input,
+    .get_exti_line = _twr_button_gpio_get_exti_line,
 };
 
 void twr_button_init(twr_button_t *self, twr_gpio_channel_t gpio_channel, twr_gpio_pull_t gpio_pull, int idle_state)
@@ -70,6 +88,11 @@ void twr_button_set_event_handler(twr_button_t *self, void (*event_handler)(twr_
 
     if (event_handler == NULL)
     {
+        if (self->_exti_armed)
+        {
+            _twr_button_exti_disarm(self);
+        }
+
         self->_tick_debounce = TWR_TICK_INFINITY;
 
         twr_scheduler_plan_absolute(self->_task_id, TWR_TICK_INFINITY);
@@ -104,23 +127,14 @@ static void _twr_button_task(void *param)
 {
     twr_button_t *self = param;
 
-    twr_tick_t tick_now = twr_scheduler_get_spin_tick();
-
-    int pin_state;
-
-    if (self->_driver->get_input != NULL)
-    {
-        pin_state = self->_driver->get_input(self);
-    }
-    else
+    if (self->_exti_armed)
     {
-        pin_state = self->_idle_state;
+        _twr_button_exti_disarm(self);
     }
 
-    if (self->_idle_state)
-    {
-        pin_state = pin_state == 0 ? 1 : 0;
-    }
+    twr_tick_t tick_now = twr_scheduler_get_spin_tick();
+
+    int pin_state = _twr_button_get_pin_state(self);
 
     if ((self->_state == 0 && pin_state != 0) || (self->_state != 0 && pin_state == 0))
     {
@@ -182,9 +196,122 @@ static void _twr_button_task(void *param)
         }
     }
 
+    if (self->_state == 0 && self->_tick_debounce == TWR_TICK_INFINITY && _twr_button_exti_arm(self))
+    {
+        // Edge before the line got armed would be missed, sample once more
+        if (_twr_button_get_pin_state(self) == 0)
+        {
+            twr_scheduler_plan_current_relative(self->_scan_interval > _TWR_BUTTON_EXTI_WATCHDOG_INTERVAL ?
+                    self->_scan_interval : _TWR_BUTTON_EXTI_WATCHDOG_INTERVAL);
+
+            return;
+        }
+    }
+
     twr_scheduler_plan_current_relative(self->_scan_interval);
 }
 
+static int _twr_button_get_pin_state(twr_button_t *self)
+{
+    int pin_state;
+
+    if (self->_driver->get_input != NULL)
+    {
+        pin_state = self->_driver->get_input(self);
+    }
+    else
+    {
+        pin_state = self->_idle_state;
+    }
+
+    if (self->_idle_state)
+    {
+        pin_state = pin_state == 0 ? 1 : 0;
+    }
+
+    return pin_state;
+}
+
+static bool _twr_button_exti_arm(twr_button_t *self)
+{
+    if (self->_driver->get_exti_line == NULL || !self->_driver->get_exti_line(self, &self->_exti_line))
+    {
+        return false;
+    }
+
+    // Line registered by another button is shared
+    bool shared = twr_exti_is_registered_to(self->_exti_line, _twr_button_exti_handler, NULL);
+
+    // Line owned by another driver (e.g. same pin number on other port) is left to it and button keeps polling
+    if (!shared && twr_exti_is_registered(self->_exti_line))
+    {
+        return false;
+    }
+
+    twr_irq_disable();
+
+    self->_exti_next = _twr_button_exti_armed;
+    _twr_button_exti_armed = self;
+    self->_exti_armed = true;
+
+    twr_irq_enable();
+
+    if (!shared)
+    {
+        twr_exti_register(self->_exti_line, TWR_EXTI_EDGE_RISING_AND_FALLING, _twr_button_exti_handler, NULL);
+    }
+
+    return true;
+}
+
+static void _twr_button_exti_disarm(twr_button_t *self)
+{
+    bool shared = false;
+
+    twr_irq_disable();
+
+    for (twr_button_t **button = &_twr_button_exti_armed; *button != NULL; button = &(*button)->_exti_next)
+    {
+        if (*button == self)
+        {
+            *button = self->_exti_next;
+
+            break;
+        }
+    }
+
+    for (twr_button_t *button = _twr_button_exti_armed; button != NULL; button = button->_exti_next)
+    {
+        if (button->_exti_line == self->_exti_line)
+        {
+            shared = true;
+        }
+    }
+
+    self->_exti_armed = false;
+
+    twr_irq_enable();
+
+    // Line taken over by another driver meanwhile stays registered
+    if (!shared && twr_exti_is_registered_to(self->_exti_line, _twr_button_exti_handler, NULL))
+    {
+        twr_exti_unregister(self->_exti_line);
+    }
+}
+
+static void _twr_button_exti_handler(twr_exti_line_t line, void *param)
+{
+    (void) param;
+
+    for (twr_button_t *button = _twr_button_exti_armed; button != NULL; button = button->_exti_next)
+    {
+        if (button->_exti_line == line)
+        {
+            twr_scheduler_plan_now(button->_task_id);
+        }
+    }
+}
+
 static void _twr_button_gpio_init(twr_button_t *self)
 {
     twr_gpio_init(self->_channel.gpio);
@@ -194,3 +321,8 @@ static int _twr_button_gpio_get_input(twr_button_t *self)
 {
     return twr_gpio_get_input(self->_channel.gpio);
 }
+
+static bool _twr_button_gpio_get_exti_line(twr_button_t *self, twr_exti_line_t *line)
+{
+    return twr_exti_get_gpio_line(self->_channel.gpio, line);
+}
@@ -18,12 +18,13 @@ Supported Murata firmware versions
 #define TWR_CMWX1ZZABZ_DELAY_CONFIG_SAVE 100
 #define TWR_CMWX1ZZABZ_DELAY_INITIALIZATION_REBOOT 500
 #define TWR_CMWX1ZZABZ_DELAY_INITIALIZATION_AT_RESPONSE 100
-#define TWR_CMWX1ZZABZ_DELAY_SEND_MESSAGE_RESPONSE 1500
+#define TWR_CMWX1ZZABZ_DELAY_SEND_MESSAGE_RESPONSE 100
 #define TWR_CMWX1ZZABZ_DELAY_JOIN_RESPONSE 500 //8000
 #define TWR_CMWX1ZZABZ_DELAY_LINK_CHECK_RESPONSE 4000
 #define TWR_CMWX1ZZABZ_DELAY_CUSTOM_COMMAND_RESPONSE 100
 
 #define TWR_CMWX1ZZABZ_TIMEOUT_CUSTOM_COMMAND_RESPONSE 500
+#define TWR_CMWX1ZZABZ_TIMEOUT_SEND_MESSAGE_RESPONSE 1500
 #define TWR_CMWX1ZZABZ_TIMEOUT_LNCHECK 20000
 #define TWR_CMWX1ZZABZ_TIMEOUT_JOIN 120000
 
@@ -745,19 +746,27 @@ static void _twr_cmwx1zzabz_task(void *param)
                     self->_event_handler(self, TWR_CMWX1ZZABZ_EVENT_SEND_MESSAGE_START, self->_event_param);
                 }
 
+                self->_timeout = twr_tick_get();
                 twr_scheduler_plan_current_from_now(TWR_CMWX1ZZABZ_DELAY_SEND_MESSAGE_RESPONSE);
 
                 return;
             }
             case TWR_CMWX1ZZABZ_STATE_SEND_MESSAGE_RESPONSE:
             {
-                self->_state = TWR_CMWX1ZZABZ_STATE_ERROR;
-
                 if (!_twr_cmwx1zzabz_read_response(self))
                 {
-                    continue;
+                    if (twr_tick_get() > (self->_timeout + TWR_CMWX1ZZABZ_TIMEOUT_SEND_MESSAGE_RESPONSE))
+                    {
+                        self->_state = TWR_CMWX1ZZABZ_STATE_ERROR;
+                        continue;
+                    }
+
+                    twr_scheduler_plan_current_from_now(50);
+                    return;
                 }
 
+                self->_state = TWR_CMWX1ZZABZ_STATE_ERROR;
+
                 if (strcmp(self->_response, "+OK\r") != 0)
                 {
                     continue;
@@ -1558,50 +1567,66 @@ bool twr_cmwx1zzabz_get_link_check(twr_cmwx1zzabz_t *self, uint8_t *margin, uint
 
 static bool _twr_cmwx1zzabz_read_response(twr_cmwx1zzabz_t *self)
 {
-    while (true)
+    twr_uart_buffer_t line[2];
+    size_t length;
+
+    while ((length = twr_uart_async_read_line(self->_uart_channel, line, '\r')) != 0)
     {
-        char rx_character;
+        bool overflow = false;
 
-        if (twr_uart_async_read(self->_uart_channel, &rx_character, 1) == 0)
-        {
-            return false;
-        }
+        self->_response_length = 0;
 
-        if (rx_character == '\n')
+        // Copy line out of the receive FIFO without line feed, carriage return is kept as responses are compared with it
+        for (int i = 0; i < 2; i++)
         {
-            continue;
-        }
-
-        self->_response[self->_response_length++] = rx_character;
+            const char *buffer = line[i].buffer;
 
-        if (rx_character == '\r')
-        {
-            if (self->_response_length == 1)
+            for (size_t j = 0; j < line[i].length; j++)
             {
-                self->_response_length = 0;
+                if (buffer[j] == '\n')
+                {
+                    continue;
+                }
 
-                continue;
-            }
+                if (self->_response_length == sizeof(self->_response) - 1)
+                {
+                    overflow = true;
 
-            self->_response[self->_response_length] = '\0';
+                    break;
+                }
 
-            break;
+                self->_response[self->_response_length++] = buffer[j];
+            }
         }
 
-        if (self->_response_length == sizeof(self->_response) - 1)
+        twr_uart_async_read_release(self->_uart_channel, length);
+
+        // Line longer than response buffer is rejected
+        if (overflow)
         {
+            self->_response_length = 0;
+
             return false;
         }
-    }
 
-    if (self->_debug)
-    {
-        twr_log_debug("LoRa RX: %s", (const char*)self->_response);
-    }
+        if ((self->_response_length == 0) || ((self->_response_length == 1) && (self->_response[0] == '\r')))
+        {
+            continue;
+        }
 
-    self->_response_length = 0;
+        self->_response[self->_response_length] = '\0';
 
-    return true;
+        if (self->_debug)
+        {
+            twr_log_debug("LoRa RX: %s", (const char*)self->_response);
+        }
+
+        self->_response_length = 0;
+
+        return true;
+    }
+
+    return false;
 }
 
 static void _twr_cmwx1zzabz_save_config(twr_cmwx1zzabz_t *self, twr_cmwx1zzabz_config_index_t config_index)
@@ -18,3 +18,43 @@ uint8_t twr_crc8(const uint8_t polynomial, const void *buffer, size_t length, co
     }
     return crc;
 }
+
+uint16_t twr_crc16(const uint16_t polynomial, const void *buffer, size_t length, const uint16_t initialization)
+{
+    uint16_t crc = initialization;
+    uint8_t *_buffer = (uint8_t *) buffer;
+
+    while (length--)
+    {
+        crc ^= (uint16_t) *_buffer++ << 8;
+
+        for (int i = 8; i; --i)
+        {
+            crc = (crc & 0x8000)
+            ? (crc << 1) ^ polynomial
+            : (crc << 1);
+        }
+    }
+    return crc;
+}
+
+uint16_t twr_crc16_modbus(const void *buffer, size_t length)
+{
+    static const uint16_t table[16] =
+    {
+        0x0000, 0xcc01, 0xd801, 0x1400, 0xf001, 0x3c00, 0x2800, 0xe401,
+        0xa001, 0x6c00, 0x7800, 0xb401, 0x5000, 0x9c01, 0x8801, 0x4400
+    };
+
+    uint16_t crc = 0xffff;
+    uint8_t *_buffer = (uint8_t *) buffer;
+
+    while (length--)
+    {
+        crc ^= *_buffer++;
+
+        crc = (crc >> 4) ^ table[crc & 0x0f];
+        crc = (crc >> 4) ^ table[crc & 0x0f];
+    }
+    return crc;
+}
@@ -3,10 +3,13 @@
 #include <twr_gpio.h>
 #include <twr_i2c.h>
 #include <twr_module_sensor.h>
+#include <twr_eeprom.h>
 #include <twr_log.h>
 
 #define _TWR_DS18B20_SCRATCHPAD_SIZE 9
 #define _TWR_DS18B20_DELAY_RUN 5000
+#define _TWR_DS18B20_CONFIG_OFFSET 4
+#define _TWR_DS18B20_FAMILY_DS18S20 0x10
 #define TWR_DS18B20_LOG 1
 
 static twr_tick_t _twr_ds18b20_lut_delay[] = {
@@ -20,6 +23,10 @@ static void _twr_ds18b20_task_interval(void *param);
 
 static void _twr_ds18b20_task_measure(void *param);
 
+static bool _twr_ds18b20_rom_cache_load(twr_ds18b20_t *self);
+
+static void _twr_ds18b20_rom_cache_save(twr_ds18b20_t *self);
+
 void twr_ds18b20_init_single(twr_ds18b20_t *self, twr_ds18b20_resolution_bits_t resolution)
 {
     static twr_ds18b20_sensor_t sensors[1];
@@ -121,6 +128,24 @@ void twr_ds18b20_set_power_dynamic(twr_ds18b20_t *self, bool on)
     self->_power_dynamic = on;
 }
 
+bool twr_ds18b20_set_rom_cache(twr_ds18b20_t *self, uint32_t address)
+{
+    if (address + 2 + sizeof(uint64_t) * self->_sensor_count > twr_eeprom_get_size())
+    {
+        return false;
+    }
+
+    self->_rom_cache = true;
+    self->_rom_cache_address = address;
+
+    return true;
+}
+
+void twr_ds18b20_rescan(twr_ds18b20_t *self)
+{
+    self->_rescan = true;
+}
+
 bool twr_ds18b20_get_temperature_raw(twr_ds18b20_t *self, uint64_t device_address, int16_t *raw)
 {
     int sensor_index = twr_ds18b20_get_index_by_device_address(self, device_address);
@@ -273,7 +298,7 @@ static void _twr_ds18b20_task_measure(void *param)
                 self->_event_handler(self, 0, TWR_DS18B20_EVENT_ERROR, self->_event_param);
             }
 
-            self->_state = self->_sensor_found > 0 ? TWR_DS18B20_STATE_READY : TWR_DS18B20_STATE_PREINITIALIZE;
+            self->_state = (self->_sensor_found > 0) && !self->_rescan ? TWR_DS18B20_STATE_READY : TWR_DS18B20_STATE_PREINITIALIZE;
 
             return;
         }
@@ -307,24 +332,32 @@ static void _twr_ds18b20_task_measure(void *param)
             uint64_t _device_address = 0;
             self->_sensor_found = 0;
 
-            twr_onewire_search_start(self->_onewire, 0);
-            while ((self->_sensor_found < self->_sensor_count) && twr_onewire_search_next(self->_onewire, &_device_address))
+            if (self->_rescan || !_twr_ds18b20_rom_cache_load(self))
             {
-                self->_sensor[self->_sensor_found]._device_address = _device_address;
+                twr_onewire_search_start(self->_onewire, 0);
+                while ((self->_sensor_found < self->_sensor_count) && twr_onewire_search_next(self->_onewire, &_device_address))
+                {
+                    self->_sensor[self->_sensor_found]._device_address = _device_address;
 
-                _device_address++;
-                self->_sensor_found++;
+                    _device_address++;
+                    self->_sensor_found++;
 
-                #ifdef TWR_DS18B20_LOG
-                twr_log_debug("twr_ds18b20: Found 0x%08llx", _device_address);
-                #endif
-            }
+                    #ifdef TWR_DS18B20_LOG
+                    twr_log_debug("twr_ds18b20: Found 0x%08llx", _device_address);
+                    #endif
+                }
 
-            if (self->_sensor_found == 0)
-            {
-                goto start;
+                if (self->_sensor_found == 0)
+                {
+                    goto start;
+                }
+
+                _twr_ds18b20_rom_cache_save(self);
             }
 
+            self->_rescan = false;
+            self->_present = true;
+
             twr_onewire_transaction_start(self->_onewire);
 
             // Write Scratchpad
@@ -389,6 +422,8 @@ static void _twr_ds18b20_task_measure(void *param)
                 // If no detect preset sensor set all sensor to invalid value, and call handler
             	twr_onewire_transaction_stop(self->_onewire);
 
+                self->_present = false;
+
                 for (int i = 0; i < self->_sensor_found; i++)
                 {
                     self->_sensor[i]._temperature_valid = false;
@@ -407,6 +442,14 @@ static void _twr_ds18b20_task_measure(void *param)
                 return;
             }
 
+            if (!self->_present && self->_rom_cache)
+            {
+                // Sensors may have been replaced while the bus was silent
+                self->_rescan = true;
+            }
+
+            self->_present = true;
+
             twr_onewire_skip_rom(self->_onewire);
 
             twr_onewire_write_byte(self->_onewire, 0x44);
@@ -441,15 +484,32 @@ static void _twr_ds18b20_task_measure(void *param)
                     break;
                 }
 
-                twr_onewire_select(self->_onewire, &self->_sensor[i]._device_address);
+                if (self->_sensor_found == 1)
+                {
+                    twr_onewire_skip_rom(self->_onewire);
+                }
+                else
+                {
+                    twr_onewire_select(self->_onewire, &self->_sensor[i]._device_address);
+                }
 
                 twr_onewire_write_byte(self->_onewire, 0xBE);
 
-                twr_onewire_read(self->_onewire, scratchpad, sizeof(scratchpad));
+                // Read up to configuration register first, sensor which does not answer or answers garbage is
+                // abandoned there instead of clocking in the rest of the scratchpad
+                twr_onewire_read(self->_onewire, scratchpad, _TWR_DS18B20_CONFIG_OFFSET + 1);
+
+                bool aborted = ((self->_sensor[i]._device_address & 0xff) != _TWR_DS18B20_FAMILY_DS18S20) &&
+                        ((scratchpad[_TWR_DS18B20_CONFIG_OFFSET] & 0x9f) != 0x1f);
+
+                if (!aborted)
+                {
+                    twr_onewire_read(self->_onewire, scratchpad + _TWR_DS18B20_CONFIG_OFFSET + 1, sizeof(scratchpad) - _TWR_DS18B20_CONFIG_OFFSET - 1);
+                }
 
                 twr_onewire_transaction_stop(self->_onewire);
 
-                self->_sensor[i]._temperature_valid = _twr_ds18b20_is_scratchpad_valid(scratchpad);
+                self->_sensor[i]._temperature_valid = !aborted && _twr_ds18b20_is_scratchpad_valid(scratchpad);
 
                 if (self->_sensor[i]._temperature_valid)
                 {
@@ -458,6 +518,11 @@ static void _twr_ds18b20_task_measure(void *param)
                     #ifdef TWR_DS18B20_LOG
                     twr_log_warning("twr_ds18b20: invalid scratchpad 0x%08llx", self->_sensor[i]._device_address);
                     #endif
+
+                    if (self->_rom_cache)
+                    {
+                        self->_rescan = true;
+                    }
                 }
             }
 
@@ -485,7 +550,7 @@ static void _twr_ds18b20_task_measure(void *param)
 
             self->_measurement_active = false;
 
-            self->_state = TWR_DS18B20_STATE_READY;
+            self->_state = self->_rescan ? TWR_DS18B20_STATE_PREINITIALIZE : TWR_DS18B20_STATE_READY;
 
             for (int i = 0; i < self->_sensor_found; i++)
             {
@@ -508,3 +573,84 @@ static void _twr_ds18b20_task_measure(void *param)
     }
 }
 
+static bool _twr_ds18b20_rom_cache_load(twr_ds18b20_t *self)
+{
+    if (!self->_rom_cache)
+    {
+        return false;
+    }
+
+    uint8_t count;
+    uint8_t crc;
+
+    twr_eeprom_read(self->_rom_cache_address, &count, sizeof(count));
+
+    if ((count == 0) || (count > self->_sensor_count))
+    {
+        return false;
+    }
+
+    uint8_t check = twr_onewire_crc8(&count, sizeof(count), 0);
+
+    for (int i = 0; i < count; i++)
+    {
+        uint64_t device_address;
+
+        twr_eeprom_read(self->_rom_cache_address + 1 + sizeof(uint64_t) * i, &device_address, sizeof(device_address));
+
+        // Every ROM carries its own CRC in the most significant byte
+        if (twr_onewire_crc8(&device_address, sizeof(device_address), 0) != 0)
+        {
+            return false;
+        }
+
+        check = twr_onewire_crc8(&device_address, sizeof(device_address), check);
+
+        self->_sensor[i]._device_address = device_address;
+    }
+
+    twr_eeprom_read(self->_rom_cache_address + 1 + sizeof(uint64_t) * count, &crc, sizeof(crc));
+
+    if (crc != check)
+    {
+        return false;
+    }
+
+    self->_sensor_found = count;
+
+    #ifdef TWR_DS18B20_LOG
+    twr_log_debug("twr_ds18b20: Loaded %d sensors from cache", count);
+    #endif
+
+    return true;
+}
+
+static void _twr_ds18b20_rom_cache_save(twr_ds18b20_t *self)
+{
+    if (!self->_rom_cache)
+    {
+        return;
+    }
+
+    uint8_t count = self->_sensor_found;
+
+    uint8_t crc = twr_onewire_crc8(&count, sizeof(count), 0);
+
+    for (int i = 0; i < count; i++)
+    {
+        crc = twr_onewire_crc8(&self->_sensor[i]._device_address, sizeof(uint64_t), crc);
+
+        // Unchanged words are not programmed again, cache left half written fails CRC and sensors are searched again
+        if (!twr_eeprom_write(self->_rom_cache_address + 1 + sizeof(uint64_t) * i, &self->_sensor[i]._device_address, sizeof(uint64_t)))
+        {
+            return;
+        }
+    }
+
+    if (!twr_eeprom_write(self->_rom_cache_address + 1 + sizeof(uint64_t) * count, &crc, sizeof(crc)))
+    {
+        return;
+    }
+
+    twr_eeprom_write(self->_rom_cache_address, &count, sizeof(count));
+}
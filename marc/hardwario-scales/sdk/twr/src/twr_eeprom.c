@@ -8,24 +8,31 @@
 #define _TWR_EEPROM_BASE DATA_EEPROM_BASE
 #define _TWR_EEPROM_END  DATA_EEPROM_BANK2_END
 #define _TWR_EEPROM_IS_BUSY() ((FLASH->SR & FLASH_SR_BSY) != 0UL)
+#define _TWR_EEPROM_PAGE_COUNT ((_TWR_EEPROM_END - _TWR_EEPROM_BASE + 1) / TWR_EEPROM_PAGE_SIZE)
+#define _TWR_EEPROM_PROGRAM_TIME 4
 
 static struct
 {
     bool running;
     uint32_t address;
-    uint8_t *buffer;
+    const uint8_t *buffer;
     size_t length;
     void (*event_handler)(twr_eepromc_event_t, void *);
     void *event_param;
-    size_t i;
+    uint32_t word_address;
+    bool flushed;
+    bool flushed_ok;
     twr_scheduler_task_id_t task_id;
+    uint32_t page_write_count[_TWR_EEPROM_PAGE_COUNT];
 
 } _twr_eeprom;
 
 static bool _twr_eeprom_is_busy(twr_tick_t timeout);
 static void _twr_eeprom_unlock(void);
 static void _twr_eeprom_lock(void);
-static bool _twr_eeprom_write(uint32_t address, size_t *i, uint8_t *buffer, size_t length);
+static bool _twr_eeprom_merge_word(uint32_t word_address, uint32_t address, const uint8_t *buffer, size_t length, uint32_t *value);
+static void _twr_eeprom_program_word(uint32_t word_address, uint32_t value);
+static void _twr_eeprom_async_flush(void);
 static void _twr_eeprom_async_write_task(void *param);
 
 bool twr_eeprom_write(uint32_t address, const void *buffer, size_t length)
@@ -40,6 +47,12 @@ bool twr_eeprom_write(uint32_t address, const void *buffer, size_t length)
         return false;
     }
 
+    // Async write in flight is finished first, so blocking write keeps its contract for every caller
+    if (_twr_eeprom.running)
+    {
+        _twr_eeprom_async_flush();
+    }
+
     if (_twr_eeprom_is_busy(50))
     {
         return false;
@@ -47,11 +60,22 @@ bool twr_eeprom_write(uint32_t address, const void *buffer, size_t length)
 
     _twr_eeprom_unlock();
 
-    size_t i = 0;
+    uint32_t end = address + length;
 
-    while (i < length)
+    for (uint32_t word_address = address & ~3UL; word_address < end; word_address += 4)
     {
-        _twr_eeprom_write(address, &i, (uint8_t *) buffer, length);
+        uint32_t value;
+
+        // Program only words whose content really changes
+        if (_twr_eeprom_merge_word(word_address, address, buffer, length, &value))
+        {
+            _twr_eeprom_program_word(word_address, value);
+
+            while (_TWR_EEPROM_IS_BUSY())
+            {
+                continue;
+            }
+        }
     }
 
     _twr_eeprom_lock();
@@ -74,16 +98,18 @@ bool twr_eeprom_async_write(uint32_t address, const void *buffer, size_t length,
         return false;
     }
 
-    _twr_eeprom.address = address += _TWR_EEPROM_BASE;
+    address += _TWR_EEPROM_BASE;
 
     // If user attempts to write outside EEPROM area...
-    if ((_twr_eeprom.address + length) > (_TWR_EEPROM_END + 1))
+    if ((address + length) > (_TWR_EEPROM_END + 1))
     {
         // Indicate failure
         return false;
     }
 
-    _twr_eeprom.buffer = (uint8_t *) buffer;
+    _twr_eeprom.address = address;
+
+    _twr_eeprom.buffer = buffer;
 
     _twr_eeprom.length = length;
 
@@ -91,7 +117,8 @@ bool twr_eeprom_async_write(uint32_t address, const void *buffer, size_t length,
 
     _twr_eeprom.event_param = event_param;
 
-    _twr_eeprom.i = 0;
+    _twr_eeprom.word_address = address & ~3UL;
+    _twr_eeprom.flushed = false;
 
     _twr_eeprom.task_id = twr_scheduler_register(_twr_eeprom_async_write_task, NULL, 0);
 
@@ -107,9 +134,17 @@ void twr_eeprom_async_cancel(void)
         twr_scheduler_unregister(_twr_eeprom.task_id);
 
         _twr_eeprom.running = false;
+
+        // Word program already in progress finishes on its own
+        _twr_eeprom_lock();
     }
 }
 
+bool twr_eeprom_is_busy(void)
+{
+    return _twr_eeprom.running;
+}
+
 bool twr_eeprom_read(uint32_t address, void *buffer, size_t length)
 {
     // Add EEPROM base offset to address
@@ -135,13 +170,28 @@ size_t twr_eeprom_get_size(void)
     return _TWR_EEPROM_END - _TWR_EEPROM_BASE + 1;
 }
 
+size_t twr_eeprom_get_page_count(void)
+{
+    return _TWR_EEPROM_PAGE_COUNT;
+}
+
+uint32_t twr_eeprom_get_page_write_count(size_t page)
+{
+    if (page >= _TWR_EEPROM_PAGE_COUNT)
+    {
+        return 0;
+    }
+
+    return _twr_eeprom.page_write_count[page];
+}
+
 static bool _twr_eeprom_is_busy(twr_tick_t timeout)
 {
     timeout += twr_tick_get();
 
     while (_TWR_EEPROM_IS_BUSY())
     {
-        if (timeout > twr_tick_get())
+        if (timeout < twr_tick_get())
         {
             return true;
         }
@@ -174,68 +224,57 @@ static void _twr_eeprom_lock(void)
     twr_irq_enable();
 }
 
-static bool _twr_eeprom_write(uint32_t address, size_t *i, uint8_t *buffer, size_t length)
+static bool _twr_eeprom_merge_word(uint32_t word_address, uint32_t address, const uint8_t *buffer, size_t length, uint32_t *value)
 {
-    uint32_t addr = address + *i;
+    uint32_t current = *((uint32_t *) word_address);
 
-    uint8_t mod = addr % 4;
+    *value = current;
 
-    bool write = false;
-
-    if (mod == 0)
+    // Overlay bytes of the requested range which fall into this word
+    for (uint32_t i = 0; i < 4; i++)
     {
-        if (*i + 4 > length)
-        {
-            mod = (addr % 2) + 2;
-        }
-    }
+        uint32_t addr = word_address + i;
 
-    if (mod == 2)
-    {
-        if (*i + 2 > length)
+        if ((addr >= address) && (addr < address + length))
         {
-            mod = 1;
+            *value &= ~(0xffUL << (i * 8));
+            *value |= ((uint32_t) buffer[addr - address]) << (i * 8);
         }
     }
 
-    if (mod == 0)
-    {
-        uint32_t value = ((uint32_t) buffer[*i + 3]) << 24 | ((uint32_t) buffer[*i + 2]) << 16 | ((uint32_t) buffer[*i + 1]) << 8 | buffer[*i];
-
-        if (*((uint32_t *) addr) != value)
-        {
-            *((uint32_t *) addr) = value;
+    return *value != current;
+}
 
-            write = true;
-        }
+static void _twr_eeprom_program_word(uint32_t word_address, uint32_t value)
+{
+    // Word program takes the same time as byte program, hence partial words are merged
+    *((uint32_t *) word_address) = value;
 
-        *i += 4;
-    }
-    else if (mod == 2)
-    {
-        uint16_t value = ((uint16_t) buffer[*i + 1]) << 8 | (uint16_t) buffer[*i];
+    _twr_eeprom.page_write_count[(word_address - _TWR_EEPROM_BASE) / TWR_EEPROM_PAGE_SIZE]++;
+}
 
-        if (*((uint16_t *) addr) != value)
-        {
-            *((uint16_t *) addr) = value;
+static void _twr_eeprom_async_flush(void)
+{
+    uint32_t end = _twr_eeprom.address + _twr_eeprom.length;
 
-            write = true;
-        }
+    _twr_eeprom_unlock();
 
-        *i += 2;
-    }
-    else
+    while (_twr_eeprom.word_address < end)
     {
-        uint8_t value = buffer[*i];
+        uint32_t word_address = _twr_eeprom.word_address;
+        uint32_t value;
+
+        _twr_eeprom.word_address += 4;
 
-        if (*((uint8_t *) addr) != value)
+        if (_twr_eeprom_merge_word(word_address, _twr_eeprom.address, _twr_eeprom.buffer, _twr_eeprom.length, &value))
         {
-            *((uint8_t *) addr) = value;
+            while (_TWR_EEPROM_IS_BUSY())
+            {
+                continue;
+            }
 
-            write = true;
+            _twr_eeprom_program_word(word_address, value);
         }
-
-        *i += 1;
     }
 
     while (_TWR_EEPROM_IS_BUSY())
@@ -243,45 +282,59 @@ static bool _twr_eeprom_write(uint32_t address, size_t *i, uint8_t *buffer, size
         continue;
     }
 
-    return write;
-}
+    _twr_eeprom_lock();
 
+    // Verify now as the following blocking write may change the same area
+    _twr_eeprom.flushed = true;
+    _twr_eeprom.flushed_ok = memcmp(_twr_eeprom.buffer, (void *) _twr_eeprom.address, _twr_eeprom.length) == 0;
+
+    // Task finds no word left and reports completion as usual
+    twr_scheduler_plan_now(_twr_eeprom.task_id);
+}
 
 static void _twr_eeprom_async_write_task(void *param)
 {
     (void) param;
 
+    // Do not spin while previous word program is in progress
     if (_TWR_EEPROM_IS_BUSY())
     {
-        twr_scheduler_plan_current_now();
+        twr_scheduler_plan_current_relative(1);
 
         return;
     }
 
-    _twr_eeprom_unlock();
+    uint32_t end = _twr_eeprom.address + _twr_eeprom.length;
 
-    while(_twr_eeprom.i < _twr_eeprom.length)
+    while (_twr_eeprom.word_address < end)
     {
-        if(_twr_eeprom_write(_twr_eeprom.address, &_twr_eeprom.i, _twr_eeprom.buffer, _twr_eeprom.length))
+        uint32_t word_address = _twr_eeprom.word_address;
+        uint32_t value;
+
+        _twr_eeprom.word_address += 4;
+
+        if (_twr_eeprom_merge_word(word_address, _twr_eeprom.address, _twr_eeprom.buffer, _twr_eeprom.length, &value))
         {
-            break;
-        }
-    };
+            _twr_eeprom_unlock();
 
-    _twr_eeprom_lock();
+            _twr_eeprom_program_word(word_address, value);
 
-    if(_twr_eeprom.i < _twr_eeprom.length)
-    {
-        twr_scheduler_plan_current_now();
+            // Come back once the program cycle is expected to be over
+            twr_scheduler_plan_current_relative(_TWR_EEPROM_PROGRAM_TIME);
 
-        return;
+            return;
+        }
     }
 
+    _twr_eeprom_lock();
+
     _twr_eeprom.running = false;
 
     twr_scheduler_unregister(_twr_eeprom.task_id);
 
-    if (memcmp(_twr_eeprom.buffer, (void *) _twr_eeprom.address, _twr_eeprom.length) != 0UL)
+    bool ok = _twr_eeprom.flushed ? _twr_eeprom.flushed_ok : memcmp(_twr_eeprom.buffer, (void *) _twr_eeprom.address, _twr_eeprom.length) == 0;
+
+    if (!ok)
     {
         if (_twr_eeprom.event_handler != NULL)
         {
@@ -0,0 +1,56 @@
+#include <twr_fixed.h>
+
+float twr_fixed_to_float(twr_fixed_t value)
+{
+    uint32_t bits = twr_fixed_to_float_bits(value);
+    float result;
+
+    memcpy(&result, &bits, sizeof(result));
+
+    return result;
+}
+
+twr_fixed_t twr_fixed_from_float(float value)
+{
+    float scaled = value * 65536.f;
+
+    if (scaled >= 2147483647.f)
+    {
+        return INT32_MAX;
+    }
+
+    if (scaled <= -2147483648.f)
+    {
+        return INT32_MIN;
+    }
+
+    return (twr_fixed_t) (scaled < 0 ? scaled - 0.5f : scaled + 0.5f);
+}
+
+uint32_t twr_fixed_to_float_bits(twr_fixed_t value)
+{
+    if (value == 0)
+    {
+        return 0;
+    }
+
+    uint32_t sign = value < 0 ? 0x80000000UL : 0;
+    uint32_t magnitude = value < 0 ? (uint32_t) -(int64_t) value : (uint32_t) value;
+
+    // Cortex-M0+ has no CLZ instruction, find the leading one by halving
+    int msb = 0;
+
+    for (int shift = 16; shift > 0; shift >>= 1)
+    {
+        if (magnitude >> (msb + shift))
+        {
+            msb += shift;
+        }
+    }
+
+    uint32_t mantissa = msb > 23 ? magnitude >> (msb - 23) : magnitude << (23 - msb);
+
+    uint32_t exponent = (uint32_t) (msb - TWR_FIXED_FRACTION_BITS + 127);
+
+    return sign | (exponent << 23) | (mantissa & 0x007fffffUL);
+}
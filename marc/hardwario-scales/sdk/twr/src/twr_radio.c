@@ -3,16 +3,30 @@
 #include <twr_atsha204.h>
 #include <twr_scheduler.h>
 #include <twr_eeprom.h>
+#include <twr_kv.h>
 #include <twr_i2c.h>
 #include <twr_radio_pub.h>
 #include <twr_radio_node.h>
+#include <twr_rtc.h>
 #include <math.h>
 
 #define _TWR_RADIO_SCAN_CACHE_LENGTH	4
 #define _TWR_RADIO_ACK_TIMEOUT       100
 #define _TWR_RADIO_SLEEP_RX_TIMEOUT  100
 #define _TWR_RADIO_TX_MAX_COUNT      6
+#define _TWR_RADIO_TX_MIN_COUNT      3
+#define _TWR_RADIO_TX_LIMIT_COUNT    10
+#define _TWR_RADIO_ACK_WINDOW_MIN    30
+#define _TWR_RADIO_ACK_BACKOFF       20
+#define _TWR_RADIO_ACK_BACKOFF_MAX   400
+#define _TWR_RADIO_LINK_HISTORY      4
 #define _TWR_RADIO_ACK_SUB_REQUEST   0x11
+#define _TWR_RADIO_ACK_SYNC          0x12
+#define _TWR_RADIO_ACK_SYNC_LENGTH   20
+#define _TWR_RADIO_ACK_SYNC_DOWNLINK 0x01
+#define _TWR_RADIO_TDMA_SYNC_TIMEOUT (15 * 60 * 1000)
+#define _TWR_RADIO_ADDRESS_OFFSET    (TWR_RADIO_HEAD_SIZE + 1)
+#define _TWR_RADIO_OFFLINE_TX_ERRORS 3
 
 typedef enum
 {
@@ -33,6 +47,9 @@ static struct
     uint64_t my_id;
     uint16_t message_id;
     int transmit_count;
+    int transmit_max_count;
+    uint64_t link_id;
+    twr_tick_t tick_tx_done;
     void (*event_handler)(twr_radio_event_t, void *);
     void *event_param;
     twr_scheduler_task_id_t task_id;
@@ -46,7 +63,7 @@ static struct
     uint8_t pub_queue_buffer[TWR_RADIO_PUB_QUEUE_BUFFER_SIZE];
     uint8_t rx_queue_buffer[TWR_RADIO_RX_QUEUE_BUFFER_SIZE];
 
-    uint8_t ack_tx_cache_buffer[15];
+    uint8_t ack_tx_cache_buffer[TWR_SPIRIT1_MAX_PACKET_SIZE];
     size_t ack_tx_cache_length;
     int ack_transmit_count;
     twr_tick_t rx_timeout;
@@ -67,21 +84,60 @@ static struct
 
     bool automatic_pairing;
     bool save_peer_devices;
+    bool save_peer_devices_running;
+    int save_peer_devices_index;
+    uint64_t save_peer_devices_buffer[3];
 
     twr_radio_sub_t *subs;
     int subs_length;
+    void (*ota_decode)(uint64_t *, uint8_t *, size_t);
+    const _twr_radio_store_hook_t *store;
+    const _twr_radio_pub_compact_hook_t *pub_compact;
     int sent_subs;
 
+    bool offline;
+    uint8_t tx_error_count;
+    twr_tick_t store_tick_replay;
+    uint8_t store_pending_buffer[TWR_RADIO_MAX_BUFFER_SIZE];
+    size_t store_pending_length;
+    bool store_batch_done_pending;
+    uint32_t rx_age;
+
+    twr_tick_t tdma_slot_length;
+    uint8_t tdma_slot;
+    uint8_t tdma_slot_count;
+    bool tdma_synced;
+    twr_tick_t tdma_offset;
+    twr_tick_t tdma_tick_sync;
+    uint32_t tdma_timestamp;
+    twr_tick_t tdma_tick_timestamp;
+
 } _twr_radio;
 
 static void _twr_radio_task(void *param);
 static void _twr_radio_go_to_state_rx_or_sleep(void);
+static void _twr_radio_tx_begin(void);
+static twr_tick_t _twr_radio_link_get_ack_timeout(void);
+static void _twr_radio_link_update(bool ack);
+static bool _twr_radio_tdma_is_synced(void);
+static bool _twr_radio_tdma_wait(void);
+static void _twr_radio_tdma_ack(twr_radio_peer_t *peer);
+static bool _twr_radio_tdma_sync(uint8_t *buffer);
 static void _twr_radio_spirit1_event_handler(twr_spirit1_event_t event, void *event_param);
 static void _twr_radio_load_peer_devices(void);
 static void _twr_radio_save_peer_devices(void);
+static void _twr_radio_save_peer_devices_next(void);
+static void _twr_radio_eeprom_event_handler(twr_eepromc_event_t event, void *event_param);
 static void _twr_radio_atsha204_event_handler(twr_atsha204_t *self, twr_atsha204_event_t event, void *event_param);
 static bool _twr_radio_peer_device_add(uint64_t id);
 static bool _twr_radio_peer_device_remove(uint64_t id);
+static bool _twr_radio_is_pub(uint8_t header);
+static twr_radio_peer_t *_twr_radio_get_addressed_peer(const uint8_t *buffer, size_t length);
+static bool _twr_radio_is_addressed(uint8_t header);
+static bool _twr_radio_store_is_ready(void);
+static void _twr_radio_store_tx_error(void);
+static void _twr_radio_store_pending(void);
+static void _twr_radio_decode_stored(uint64_t *id, uint8_t *buffer, size_t length);
 
 __attribute__((weak)) void twr_radio_on_info(uint64_t *id, char *firmware, char *version, twr_radio_mode_t mode) { (void) id; (void) firmware; (void) version; (void) mode;}
 __attribute__((weak)) void twr_radio_on_sub(uint64_t *id, uint8_t *order, twr_radio_sub_pt_t *pt, char *topic) { (void) id; (void) order; (void) pt; (void) topic; }
@@ -102,10 +158,11 @@ void twr_radio_init(twr_radio_mode_t mode)
     twr_spirit1_init();
     twr_spirit1_set_event_handler(_twr_radio_spirit1_event_handler, NULL);
 
-    _twr_radio_load_peer_devices();
-
+    // Task exists before peers are loaded, as loading can plan it to save them
     _twr_radio.task_id = twr_scheduler_register(_twr_radio_task, NULL, TWR_TICK_INFINITY);
 
+    _twr_radio_load_peer_devices();
+
     _twr_radio_go_to_state_rx_or_sleep();
 }
 
@@ -259,9 +316,25 @@ bool twr_radio_is_peer_device(uint64_t id)
 
 bool twr_radio_pub_queue_put(const void *buffer, size_t length)
 {
+    bool storable = _twr_radio_store_is_ready() && _twr_radio_is_pub(((const uint8_t *) buffer)[0]);
+
+    // Gateway does not acknowledge, keep publishes for replay instead of wasting retransmissions
+    if (_twr_radio.offline && storable)
+    {
+        return _twr_radio.store->put(buffer, length);
+    }
+
     if (!twr_queue_put(&_twr_radio.pub_queue, buffer, length))
     {
-        return false;
+        return storable ? _twr_radio.store->put(buffer, length) : false;
+    }
+
+    twr_radio_peer_t *peer = _twr_radio_get_addressed_peer(buffer, length);
+
+    // Node learns from ACK whether to listen for downlink
+    if ((peer != NULL) && (peer->downlink_pending != 0xff))
+    {
+        peer->downlink_pending++;
     }
 
     twr_scheduler_plan_now(_twr_radio.task_id);
@@ -283,6 +356,24 @@ void twr_radio_set_subs(twr_radio_sub_t *subs, int length)
     _twr_radio.sent_subs = 0;
 }
 
+void _twr_radio_set_ota_decode(void (*decode)(uint64_t *, uint8_t *, size_t))
+{
+    // Linked in only by twr_radio_ota_init, so firmware without update support does not carry it
+    _twr_radio.ota_decode = decode;
+}
+
+void _twr_radio_set_store_hook(const _twr_radio_store_hook_t *hook)
+{
+    // Set by twr_radio_store_init, same as above
+    _twr_radio.store = hook;
+}
+
+void _twr_radio_set_pub_compact_hook(const _twr_radio_pub_compact_hook_t *hook)
+{
+    // Set by twr_radio_pub_compact_init, same as above
+    _twr_radio.pub_compact = hook;
+}
+
 bool twr_radio_send_sub_data(uint64_t *id, uint8_t order, void *payload, size_t size)
 {
     uint8_t qbuffer[1 + TWR_RADIO_ID_SIZE + TWR_RADIO_NODE_MAX_BUFFER_SIZE];
@@ -316,6 +407,30 @@ void twr_radio_set_rx_timeout_for_sleeping_node(twr_tick_t timeout)
     _twr_radio.sleeping_mode_rx_timeout = timeout;
 }
 
+void twr_radio_set_tdma(twr_tick_t slot_length)
+{
+    _twr_radio.tdma_slot_length = slot_length > 255 ? 255 : slot_length;
+
+    twr_scheduler_plan_now(_twr_radio.task_id);
+}
+
+bool twr_radio_is_tdma_synced(void)
+{
+    return _twr_radio_tdma_is_synced();
+}
+
+bool twr_radio_get_tdma_timestamp(uint32_t *timestamp)
+{
+    if (!_twr_radio_tdma_is_synced())
+    {
+        return false;
+    }
+
+    *timestamp = _twr_radio.tdma_timestamp + (twr_tick_get() - _twr_radio.tdma_tick_timestamp) / 1000;
+
+    return true;
+}
+
 static void _twr_radio_task(void *param)
 {
     (void) param;
@@ -341,6 +456,19 @@ static void _twr_radio_task(void *param)
         _twr_radio_save_peer_devices();
     }
 
+    _twr_radio_store_pending();
+
+    if ((_twr_radio.mode == TWR_RADIO_MODE_GATEWAY) && (_twr_radio.tdma_slot_length != 0))
+    {
+        struct timespec ts;
+
+        // ACK is built in interrupt, it extrapolates this reference instead of reading RTC
+        twr_rtc_get_timestamp(&ts);
+
+        _twr_radio.tdma_timestamp = ts.tv_sec;
+        _twr_radio.tdma_tick_timestamp = twr_tick_get();
+    }
+
     if (_twr_radio.pairing_request_to_gateway)
     {
         _twr_radio.pairing_request_to_gateway = false;
@@ -373,16 +501,14 @@ static void _twr_radio_task(void *param)
 
         twr_spirit1_set_tx_length(10 + len + 2);
 
-        twr_spirit1_tx();
-
-        _twr_radio.transmit_count = _TWR_RADIO_TX_MAX_COUNT;
-
-        _twr_radio.state = TWR_RADIO_STATE_TX;
+        _twr_radio_tx_begin();
 
         return;
     }
 
-    if (_twr_radio.ack && (_twr_radio.sent_subs != _twr_radio.subs_length))
+    bool subs_pending = _twr_radio.ack && (_twr_radio.sent_subs != _twr_radio.subs_length);
+
+    if (subs_pending && !_twr_radio_tdma_wait())
     {
         uint8_t *buffer = twr_spirit1_get_tx_buffer();
 
@@ -405,11 +531,7 @@ static void _twr_radio_task(void *param)
 
         twr_spirit1_set_tx_length(11 + strlen(sub->topic) + 1);
 
-        twr_spirit1_tx();
-
-        _twr_radio.transmit_count = _TWR_RADIO_TX_MAX_COUNT;
-
-        _twr_radio.state = TWR_RADIO_STATE_TX;
+        _twr_radio_tx_begin();
 
         return;
     }
@@ -428,7 +550,16 @@ static void _twr_radio_task(void *param)
 
         twr_radio_node_decode(&id, queue_item_buffer + TWR_RADIO_HEAD_SIZE, queue_item_length);
 
-        if (queue_item_buffer[TWR_RADIO_HEAD_SIZE] == TWR_RADIO_HEADER_SUB_DATA)
+        if (_twr_radio.ota_decode != NULL)
+        {
+            _twr_radio.ota_decode(&id, queue_item_buffer + TWR_RADIO_HEAD_SIZE, queue_item_length);
+        }
+
+        if (queue_item_buffer[TWR_RADIO_HEAD_SIZE] == TWR_RADIO_HEADER_PUB_STORED)
+        {
+            _twr_radio_decode_stored(&id, queue_item_buffer + TWR_RADIO_HEAD_SIZE, queue_item_length);
+        }
+        else if (queue_item_buffer[TWR_RADIO_HEAD_SIZE] == TWR_RADIO_HEADER_SUB_DATA)
         {
             uint8_t order = queue_item_buffer[TWR_RADIO_HEAD_SIZE + 1 + TWR_RADIO_ID_SIZE];
 
@@ -469,8 +600,38 @@ static void _twr_radio_task(void *param)
         }
     }
 
-    if (twr_queue_get(&_twr_radio.pub_queue, queue_item_buffer, &queue_item_length))
+    // Subscriptions go first and wait for the slot, the wake planned by TDMA wait is not replanned
+    if (subs_pending)
     {
+        return;
+    }
+
+    while (!twr_queue_is_empty(&_twr_radio.pub_queue))
+    {
+        if (_twr_radio_tdma_wait())
+        {
+            return;
+        }
+
+        if (!twr_queue_get(&_twr_radio.pub_queue, queue_item_buffer, &queue_item_length))
+        {
+            break;
+        }
+
+        twr_radio_peer_t *peer = _twr_radio_get_addressed_peer(queue_item_buffer, queue_item_length);
+
+        if ((peer != NULL) && (peer->downlink_pending != 0))
+        {
+            peer->downlink_pending--;
+        }
+
+        if (_twr_radio.offline && _twr_radio_store_is_ready() && _twr_radio_is_pub(queue_item_buffer[0]))
+        {
+            _twr_radio.store->put(queue_item_buffer, queue_item_length);
+
+            continue;
+        }
+
         uint8_t *buffer = twr_spirit1_get_tx_buffer();
 
         twr_radio_id_to_buffer(&_twr_radio.my_id, buffer);
@@ -482,13 +643,57 @@ static void _twr_radio_task(void *param)
 
         memcpy(buffer + 8, queue_item_buffer, queue_item_length);
 
+        // Without compact telemetry the frame goes out self-contained as queued
+        if ((queue_item_buffer[0] == TWR_RADIO_HEADER_PUB_COMPACT_KEY) && (_twr_radio.pub_compact != NULL))
+        {
+            queue_item_length = _twr_radio.pub_compact->encode(buffer + 8, queue_item_length);
+        }
+
         twr_spirit1_set_tx_length(8 + queue_item_length);
 
-        twr_spirit1_tx();
+        _twr_radio_tx_begin();
 
-        _twr_radio.transmit_count = _TWR_RADIO_TX_MAX_COUNT;
+        return;
+    }
+
+    if (_twr_radio_store_is_ready() && (_twr_radio.store->get_backlog() != 0))
+    {
+        twr_tick_t now = twr_tick_get();
 
-        _twr_radio.state = TWR_RADIO_STATE_TX;
+        // Replay is rate limited, while offline the replay frame is a probe for the gateway
+        if (now < _twr_radio.store_tick_replay)
+        {
+            twr_scheduler_plan_current_absolute(_twr_radio.store_tick_replay);
+
+            return;
+        }
+
+        if (_twr_radio_tdma_wait())
+        {
+            return;
+        }
+
+        uint8_t *buffer = twr_spirit1_get_tx_buffer();
+
+        size_t length = _twr_radio.store->batch(buffer + 8, TWR_RADIO_MAX_BUFFER_SIZE);
+
+        if (length == 0)
+        {
+            return;
+        }
+
+        twr_radio_id_to_buffer(&_twr_radio.my_id, buffer);
+
+        _twr_radio.message_id++;
+
+        buffer[6] = _twr_radio.message_id;
+        buffer[7] = _twr_radio.message_id >> 8;
+
+        twr_spirit1_set_tx_length(8 + length);
+
+        _twr_radio_tx_begin();
+
+        _twr_radio.store_tick_replay = now + _twr_radio.store->get_interval(!_twr_radio.offline);
     }
 }
 
@@ -595,6 +800,246 @@ static void _twr_radio_go_to_state_rx_or_sleep(void)
     twr_scheduler_plan_now(_twr_radio.task_id);
 }
 
+static void _twr_radio_tx_begin(void)
+{
+    twr_radio_peer_t *peer = NULL;
+
+    if (_twr_radio.mode != TWR_RADIO_MODE_GATEWAY)
+    {
+        peer = _twr_radio.peer_devices_length > 0 ? &_twr_radio.peer_devices[0] : NULL;
+    }
+    else if (twr_spirit1_get_tx_length() >= _TWR_RADIO_ADDRESS_OFFSET + TWR_RADIO_ID_SIZE)
+    {
+        uint64_t id;
+
+        // Gateway addresses node by ID following the header
+        twr_radio_id_from_buffer((uint8_t *) twr_spirit1_get_tx_buffer() + _TWR_RADIO_ADDRESS_OFFSET, &id);
+
+        peer = twr_radio_get_peer_device(id);
+    }
+
+    int count = _TWR_RADIO_TX_MAX_COUNT;
+
+    if (_twr_radio.offline)
+    {
+        // Frame is kept in twr_radio_store, it is just a probe
+        count = _TWR_RADIO_TX_MIN_COUNT;
+    }
+    else if ((peer != NULL) && (peer->link.ack_count >= _TWR_RADIO_LINK_HISTORY))
+    {
+        // Twice the transmissions the link usually needs, strong link gives up sooner and weak link tries harder
+        count = 2 + (2 * peer->link.attempts + 15) / 16;
+
+        if (count < _TWR_RADIO_TX_MIN_COUNT)
+        {
+            count = _TWR_RADIO_TX_MIN_COUNT;
+        }
+        else if (count > _TWR_RADIO_TX_LIMIT_COUNT)
+        {
+            count = _TWR_RADIO_TX_LIMIT_COUNT;
+        }
+    }
+
+    _twr_radio.link_id = peer != NULL ? peer->id : 0;
+
+    _twr_radio.transmit_count = count;
+
+    _twr_radio.transmit_max_count = count;
+
+    twr_spirit1_tx();
+
+    _twr_radio.state = TWR_RADIO_STATE_TX;
+}
+
+static twr_tick_t _twr_radio_link_get_ack_timeout(void)
+{
+    twr_radio_peer_t *peer = _twr_radio.link_id != 0 ? twr_radio_get_peer_device(_twr_radio.link_id) : NULL;
+
+    twr_tick_t window = _TWR_RADIO_ACK_TIMEOUT - 50;
+    twr_tick_t backoff = _TWR_RADIO_ACK_TIMEOUT;
+
+    if ((peer != NULL) && (peer->link.ack_count >= _TWR_RADIO_LINK_HISTORY))
+    {
+        // Listen a bit longer than the peer usually takes to acknowledge, collisions are resolved by backoff
+        window = 2 * peer->link.ack_latency + _TWR_RADIO_ACK_WINDOW_MIN;
+
+        if (window > _TWR_RADIO_ACK_TIMEOUT)
+        {
+            window = _TWR_RADIO_ACK_TIMEOUT;
+        }
+
+        backoff = _TWR_RADIO_ACK_BACKOFF;
+    }
+
+    if (_twr_radio_tdma_is_synced())
+    {
+        // Slot is not shared, there is nobody to spread away from
+        return window + rand() % _TWR_RADIO_ACK_BACKOFF;
+    }
+
+    // Random part doubles with each retransmission, so colliding nodes spread apart
+    for (int i = _twr_radio.transmit_max_count - _twr_radio.transmit_count; (i > 1) && (backoff < _TWR_RADIO_ACK_BACKOFF_MAX); i--)
+    {
+        backoff <<= 1;
+    }
+
+    if (backoff > _TWR_RADIO_ACK_BACKOFF_MAX)
+    {
+        backoff = _TWR_RADIO_ACK_BACKOFF_MAX;
+    }
+
+    return window + rand() % backoff;
+}
+
+static bool _twr_radio_tdma_is_synced(void)
+{
+    if (!_twr_radio.tdma_synced || (_twr_radio.mode == TWR_RADIO_MODE_GATEWAY))
+    {
+        return false;
+    }
+
+    // Clocks drift apart, random access is safer than a slot which is off by more than its guard
+    if (twr_tick_get() - _twr_radio.tdma_tick_sync > _TWR_RADIO_TDMA_SYNC_TIMEOUT)
+    {
+        _twr_radio.tdma_synced = false;
+
+        return false;
+    }
+
+    return true;
+}
+
+static bool _twr_radio_tdma_wait(void)
+{
+    if (!_twr_radio_tdma_is_synced())
+    {
+        return false;
+    }
+
+    twr_tick_t now = twr_tick_get();
+
+    twr_tick_t period = _twr_radio.tdma_slot_length * _twr_radio.tdma_slot_count;
+
+    twr_tick_t position = (now + _twr_radio.tdma_offset) % period;
+
+    // Transmission starts a quarter into the slot, the rest is left for drift, ACK and retransmission
+    twr_tick_t start = _twr_radio.tdma_slot * _twr_radio.tdma_slot_length + _twr_radio.tdma_slot_length / 4;
+
+    if ((position >= start) && (position < start + _twr_radio.tdma_slot_length / 4))
+    {
+        return false;
+    }
+
+    twr_scheduler_plan_current_absolute(now + (start + period - position) % period);
+
+    return true;
+}
+
+static void _twr_radio_tdma_ack(twr_radio_peer_t *peer)
+{
+    uint8_t *tx_buffer = twr_spirit1_get_tx_buffer();
+
+    twr_tick_t now = twr_tick_get();
+
+    twr_tick_t period = _twr_radio.tdma_slot_length * _twr_radio.peer_devices_length;
+
+    // Slot and phase have to fit their fields, otherwise nodes keep random access
+    if ((_twr_radio.peer_devices_length > 0xff) || (period > 0xffff))
+    {
+        return;
+    }
+
+    uint32_t timestamp = _twr_radio.tdma_timestamp + (now - _twr_radio.tdma_tick_timestamp) / 1000;
+
+    // Frame has just been received, so the phase is the one at end of transmission of node
+    uint16_t phase = now % period;
+
+    tx_buffer[9] = _TWR_RADIO_ACK_SYNC;
+
+    memcpy(tx_buffer + 10, &timestamp, sizeof(timestamp));
+    memcpy(tx_buffer + 14, &phase, sizeof(phase));
+
+    tx_buffer[16] = peer - _twr_radio.peer_devices;
+    tx_buffer[17] = _twr_radio.peer_devices_length;
+    tx_buffer[18] = _twr_radio.tdma_slot_length;
+    tx_buffer[19] = peer->downlink_pending != 0 ? _TWR_RADIO_ACK_SYNC_DOWNLINK : 0;
+
+    twr_spirit1_set_tx_length(_TWR_RADIO_ACK_SYNC_LENGTH);
+}
+
+static bool _twr_radio_tdma_sync(uint8_t *buffer)
+{
+    uint32_t timestamp;
+    uint16_t phase;
+
+    memcpy(&timestamp, buffer, sizeof(timestamp));
+    memcpy(&phase, buffer + 4, sizeof(phase));
+
+    if ((buffer[7] == 0) || (buffer[8] == 0) || (buffer[6] >= buffer[7]))
+    {
+        _twr_radio.tdma_synced = false;
+
+        return true;
+    }
+
+    _twr_radio.tdma_slot = buffer[6];
+    _twr_radio.tdma_slot_count = buffer[7];
+    _twr_radio.tdma_slot_length = buffer[8];
+
+    twr_tick_t period = _twr_radio.tdma_slot_length * _twr_radio.tdma_slot_count;
+
+    _twr_radio.tdma_offset = (phase % period + period - _twr_radio.tick_tx_done % period) % period;
+
+    _twr_radio.tdma_tick_sync = _twr_radio.tick_tx_done;
+
+    _twr_radio.tdma_timestamp = timestamp;
+    _twr_radio.tdma_tick_timestamp = twr_tick_get();
+
+    _twr_radio.tdma_synced = true;
+
+    return (buffer[9] & _TWR_RADIO_ACK_SYNC_DOWNLINK) != 0;
+}
+
+static void _twr_radio_link_update(bool ack)
+{
+    twr_radio_peer_t *peer = _twr_radio.link_id != 0 ? twr_radio_get_peer_device(_twr_radio.link_id) : NULL;
+
+    if (peer == NULL)
+    {
+        return;
+    }
+
+    twr_radio_link_t *link = &peer->link;
+
+    int attempts = _twr_radio.transmit_max_count - _twr_radio.transmit_count;
+
+    link->tx_count++;
+
+    link->retransmit_count += attempts > 1 ? attempts - 1 : 0;
+
+    if (!ack)
+    {
+        // Failures count in delivery ratio only, dead gateway must not inflate retransmissions
+        return;
+    }
+
+    twr_tick_t latency = twr_tick_get() - _twr_radio.tick_tx_done;
+    int rssi = twr_spirit1_get_rx_rssi();
+
+    if (link->ack_count++ == 0)
+    {
+        link->attempts = attempts * 16;
+        link->ack_latency = latency;
+        link->rssi = rssi;
+
+        return;
+    }
+
+    link->attempts = (3 * link->attempts + attempts * 16) / 4;
+    link->ack_latency = (3 * link->ack_latency + latency) / 4;
+    link->rssi = (3 * link->rssi + rssi) / 4;
+}
+
 static void _twr_radio_spirit1_event_handler(twr_spirit1_event_t event, void *event_param)
 {
     (void) event_param;
@@ -608,9 +1053,11 @@ static void _twr_radio_spirit1_event_handler(twr_spirit1_event_t event, void *ev
 
         if (_twr_radio.state == TWR_RADIO_STATE_TX)
         {
-            twr_tick_t timeout = _TWR_RADIO_ACK_TIMEOUT - 50 + rand() % _TWR_RADIO_ACK_TIMEOUT;
+            twr_tick_t timeout = _twr_radio_link_get_ack_timeout();
+
+            _twr_radio.tick_tx_done = twr_tick_get();
 
-            _twr_radio.rx_timeout = twr_tick_get() + timeout;
+            _twr_radio.rx_timeout = _twr_radio.tick_tx_done + timeout;
 
             twr_spirit1_set_rx_timeout(timeout);
 
@@ -647,12 +1094,12 @@ static void _twr_radio_spirit1_event_handler(twr_spirit1_event_t event, void *ev
 
                 memcpy(tx_buffer, _twr_radio.ack_tx_cache_buffer, sizeof(_twr_radio.ack_tx_cache_buffer));
 
-                twr_tick_t timeout = _TWR_RADIO_ACK_TIMEOUT - 50 + rand() % _TWR_RADIO_ACK_TIMEOUT;
+                _twr_radio.transmit_count = _twr_radio.ack_transmit_count;
+
+                twr_tick_t timeout = _twr_radio_link_get_ack_timeout();
 
                 _twr_radio.rx_timeout = twr_tick_get() + timeout;
 
-                _twr_radio.transmit_count = _twr_radio.ack_transmit_count;
-
                 twr_spirit1_set_rx_timeout(timeout);
 
                 twr_spirit1_set_tx_length(_twr_radio.ack_tx_cache_length);
@@ -681,6 +1128,18 @@ static void _twr_radio_spirit1_event_handler(twr_spirit1_event_t event, void *ev
             }
             else
             {
+                uint8_t *tx_buffer = twr_spirit1_get_tx_buffer();
+
+                _twr_radio_link_update(false);
+
+                // Deltas are turned back into absolute values, the frame may be stored for replay
+                if ((_twr_radio.pub_compact != NULL) && (twr_spirit1_get_tx_length() > 8))
+                {
+                    twr_spirit1_set_tx_length(8 + _twr_radio.pub_compact->tx_error(tx_buffer + 8, twr_spirit1_get_tx_length() - 8));
+                }
+
+                _twr_radio_store_tx_error();
+
                 if (_twr_radio.event_handler)
                 {
                     _twr_radio.event_handler(TWR_RADIO_EVENT_TX_ERROR, _twr_radio.event_param);
@@ -732,10 +1191,28 @@ static void _twr_radio_spirit1_event_handler(twr_spirit1_event_t event, void *ev
 
                     if ((_twr_radio.peer_id == _twr_radio.my_id) && (_twr_radio.message_id == message_id) )
                     {
+                        _twr_radio_link_update(true);
+
                         _twr_radio.transmit_count = 0;
 
                         _twr_radio.ack = true;
 
+                        _twr_radio.offline = false;
+
+                        _twr_radio.tx_error_count = 0;
+
+                        if (tx_buffer[8] == TWR_RADIO_HEADER_PUB_STORED)
+                        {
+                            // EEPROM is written by the task, next batch is not read before that
+                            _twr_radio.store_batch_done_pending = true;
+
+                            twr_scheduler_plan_now(_twr_radio.task_id);
+                        }
+                        else if (_twr_radio.pub_compact != NULL)
+                        {
+                            _twr_radio.pub_compact->ack(tx_buffer + 8, twr_spirit1_get_tx_length() - 8);
+                        }
+
                         if (tx_buffer[8] == TWR_RADIO_HEADER_PAIRING)
                         {
                             if (length == 15)
@@ -746,6 +1223,7 @@ static void _twr_radio_spirit1_event_handler(twr_spirit1_event_t event, void *ev
                                 {
                                     _twr_radio.peer_devices[0].id = _twr_radio.peer_id;
                                     _twr_radio.peer_devices[0].message_id_synced = false;
+                                    memset(&_twr_radio.peer_devices[0].link, 0, sizeof(twr_radio_link_t));
                                     _twr_radio.peer_devices_length = 1;
 
                                     _twr_radio.save_peer_devices = true;
@@ -769,7 +1247,14 @@ static void _twr_radio_spirit1_event_handler(twr_spirit1_event_t event, void *ev
                             _twr_radio.sent_subs = 0;
                         }
 
-                        if (_twr_radio.sleeping_mode_rx_timeout != 0)
+                        bool downlink = true;
+
+                        if ((length == _TWR_RADIO_ACK_SYNC_LENGTH) && (buffer[9] == _TWR_RADIO_ACK_SYNC))
+                        {
+                            downlink = _twr_radio_tdma_sync(buffer + 10);
+                        }
+
+                        if ((_twr_radio.sleeping_mode_rx_timeout != 0) && downlink)
                         {
                             _twr_radio.rx_timeout_sleeping = twr_tick_get() + _twr_radio.sleeping_mode_rx_timeout;
                         }
@@ -875,7 +1360,7 @@ static void _twr_radio_spirit1_event_handler(twr_spirit1_event_t event, void *ev
 
                     if (length > 9)
                     {
-                        if ((buffer[8] >= 0x15) && (buffer[8] <= 0x1d) && (length > 14))
+                        if (_twr_radio_is_addressed(buffer[8]) && (length > 14))
                         {
                             uint64_t for_id;
 
@@ -908,6 +1393,10 @@ static void _twr_radio_spirit1_event_handler(twr_spirit1_event_t event, void *ev
 
                             twr_spirit1_set_tx_length(10);
                         }
+                        else if ((_twr_radio.mode == TWR_RADIO_MODE_GATEWAY) && (_twr_radio.tdma_slot_length != 0))
+                        {
+                            _twr_radio_tdma_ack(peer);
+                        }
                     }
 
                     return;
@@ -935,11 +1424,33 @@ static void _twr_radio_load_peer_devices(void)
     uint64_t buffer[3];
     uint32_t *pointer = (uint32_t *)buffer;
     uint8_t length = 0;
-
-    twr_eeprom_read(twr_eeprom_get_size() - 1, &length, 1);
+    uint8_t record[1 + sizeof(uint64_t) * TWR_RADIO_MAX_DEVICES];
 
     _twr_radio.peer_devices_length = 0;
 
+    if (twr_kv_get(TWR_KV_KEY_RADIO_PEERS, record, sizeof(record)) != 0)
+    {
+        for (int i = 0; (i < record[0]) && (i < TWR_RADIO_MAX_DEVICES); i++)
+        {
+            memcpy(&_twr_radio.peer_devices[i].id, &record[1 + i * sizeof(uint64_t)], sizeof(uint64_t));
+            _twr_radio.peer_devices[i].message_id_synced = false;
+            memset(&_twr_radio.peer_devices[i].link, 0, sizeof(twr_radio_link_t));
+            _twr_radio.peer_devices_length++;
+        }
+
+        return;
+    }
+
+    // Peers saved by legacy layout are moved to key-value store if it is in use
+    if (twr_kv_is_ready())
+    {
+        _twr_radio.save_peer_devices = true;
+
+        twr_scheduler_plan_now(_twr_radio.task_id);
+    }
+
+    twr_eeprom_read(twr_eeprom_get_size() - 1, &length, 1);
+
     for (int i = 0; (i < length) && (i < TWR_RADIO_MAX_DEVICES); i++)
     {
         address -= sizeof(buffer);
@@ -969,6 +1480,7 @@ static void _twr_radio_load_peer_devices(void)
         {
             _twr_radio.peer_devices[_twr_radio.peer_devices_length].id = buffer[0];
             _twr_radio.peer_devices[_twr_radio.peer_devices_length].message_id_synced = false;
+            memset(&_twr_radio.peer_devices[_twr_radio.peer_devices_length].link, 0, sizeof(twr_radio_link_t));
             _twr_radio.peer_devices_length++;
         }
     }
@@ -976,46 +1488,120 @@ static void _twr_radio_load_peer_devices(void)
 
 static void _twr_radio_save_peer_devices(void)
 {
-    uint32_t address = (uint32_t) twr_eeprom_get_size() - 8;
-    uint64_t buffer_write[3];
-    uint32_t *pointer_write = (uint32_t *)buffer_write;
-    uint64_t buffer_read[3];
+    // Changes made meanwhile are saved after the running write completes
+    if (_twr_radio.save_peer_devices_running)
+    {
+        return;
+    }
 
     _twr_radio.save_peer_devices = false;
 
-    for (int i = 0; i < _twr_radio.peer_devices_length; i++)
+    if (twr_kv_is_ready())
     {
-        buffer_write[0] = _twr_radio.peer_devices[i].id;
-        buffer_write[1] = _twr_radio.peer_devices[i].id;
-        buffer_write[2] = _twr_radio.peer_devices[i].id;
+        uint8_t record[1 + sizeof(uint64_t) * TWR_RADIO_MAX_DEVICES];
+
+        record[0] = _twr_radio.peer_devices_length;
+
+        for (int i = 0; i < _twr_radio.peer_devices_length; i++)
+        {
+            memcpy(&record[1 + i * sizeof(uint64_t)], &_twr_radio.peer_devices[i].id, sizeof(uint64_t));
+        }
+
+        // Only the changed record is appended, instead of rewriting the whole peer table
+        if (!twr_kv_set(TWR_KV_KEY_RADIO_PEERS, record, 1 + _twr_radio.peer_devices_length * sizeof(uint64_t)))
+        {
+            _twr_radio.save_peer_devices = true;
 
-        pointer_write[2] = ~pointer_write[2];
-        pointer_write[5] = ~pointer_write[5];
+            twr_scheduler_plan_from_now(_twr_radio.task_id, 10);
+        }
 
-        address -= sizeof(buffer_write);
+        return;
+    }
 
-        twr_eeprom_read(address, buffer_read, sizeof(buffer_read));
+    _twr_radio.save_peer_devices_index = 0;
 
-        if (memcmp(buffer_read, buffer_write, sizeof(buffer_write)) != 0)
+    _twr_radio_save_peer_devices_next();
+}
+
+static void _twr_radio_save_peer_devices_next(void)
+{
+    uint64_t *buffer_write = _twr_radio.save_peer_devices_buffer;
+    uint32_t *pointer_write = (uint32_t *) buffer_write;
+    uint64_t buffer_read[3];
+    uint32_t address;
+    size_t length;
+
+    _twr_radio.save_peer_devices_running = false;
+
+    for (; _twr_radio.save_peer_devices_index <= _twr_radio.peer_devices_length; _twr_radio.save_peer_devices_index++)
+    {
+        int i = _twr_radio.save_peer_devices_index;
+
+        if (i < _twr_radio.peer_devices_length)
         {
-            if (!twr_eeprom_write(address, buffer_write, sizeof(buffer_write)))
-            {
-                _twr_radio.save_peer_devices = true;
+            buffer_write[0] = _twr_radio.peer_devices[i].id;
+            buffer_write[1] = _twr_radio.peer_devices[i].id;
+            buffer_write[2] = _twr_radio.peer_devices[i].id;
 
-                twr_scheduler_plan_now(_twr_radio.task_id);
+            pointer_write[2] = ~pointer_write[2];
+            pointer_write[5] = ~pointer_write[5];
 
-                return;
-            }
+            address = (uint32_t) twr_eeprom_get_size() - 8 - (i + 1) * sizeof(buffer_read);
+            length = sizeof(buffer_read);
+        }
+        else
+        {
+            memcpy(buffer_write, &_twr_radio.peer_devices_length, 1);
+
+            address = (uint32_t) twr_eeprom_get_size() - 1;
+            length = 1;
         }
+
+        twr_eeprom_read(address, buffer_read, length);
+
+        if (memcmp(buffer_read, buffer_write, length) == 0)
+        {
+            continue;
+        }
+
+        if (!twr_eeprom_async_write(address, buffer_write, length, _twr_radio_eeprom_event_handler, NULL))
+        {
+            // EEPROM is occupied by another write, try again later
+            _twr_radio.save_peer_devices = true;
+
+            twr_scheduler_plan_from_now(_twr_radio.task_id, 10);
+
+            return;
+        }
+
+        _twr_radio.save_peer_devices_running = true;
+
+        return;
     }
 
-    if (!twr_eeprom_write(twr_eeprom_get_size() - 1, &_twr_radio.peer_devices_length, 1))
+    if (_twr_radio.save_peer_devices)
+    {
+        twr_scheduler_plan_now(_twr_radio.task_id);
+    }
+}
+
+static void _twr_radio_eeprom_event_handler(twr_eepromc_event_t event, void *event_param)
+{
+    (void) event_param;
+
+    if (event == TWR_EEPROM_EVENT_ASYNC_WRITE_DONE)
+    {
+        _twr_radio.save_peer_devices_index++;
+
+        _twr_radio_save_peer_devices_next();
+    }
+    else
     {
+        _twr_radio.save_peer_devices_running = false;
+
         _twr_radio.save_peer_devices = true;
 
         twr_scheduler_plan_now(_twr_radio.task_id);
-
-        return;
     }
 }
 
@@ -1068,6 +1654,8 @@ static bool _twr_radio_peer_device_add(uint64_t id)
 
     _twr_radio.peer_devices[_twr_radio.peer_devices_length].id = id;
     _twr_radio.peer_devices[_twr_radio.peer_devices_length].message_id_synced = false;
+    memset(&_twr_radio.peer_devices[_twr_radio.peer_devices_length].link, 0, sizeof(twr_radio_link_t));
+    _twr_radio.peer_devices[_twr_radio.peer_devices_length].downlink_pending = 0;
     _twr_radio.peer_devices_length++;
 
     _twr_radio.save_peer_devices = true;
@@ -1112,6 +1700,140 @@ static bool _twr_radio_peer_device_remove(uint64_t id)
     return false;
 }
 
+static twr_radio_peer_t *_twr_radio_get_addressed_peer(const uint8_t *buffer, size_t length)
+{
+    if ((_twr_radio.mode != TWR_RADIO_MODE_GATEWAY) || (length < 1 + TWR_RADIO_ID_SIZE) || !_twr_radio_is_addressed(buffer[0]))
+    {
+        return NULL;
+    }
+
+    uint64_t id;
+
+    twr_radio_id_from_buffer((uint8_t *) buffer + 1, &id);
+
+    return twr_radio_get_peer_device(id);
+}
+
+static bool _twr_radio_is_addressed(uint8_t header)
+{
+    return ((header >= 0x15) && (header <= 0x1d)) || (header == TWR_RADIO_HEADER_OTA_BEGIN) || (header == TWR_RADIO_HEADER_OTA_DATA);
+}
+
+static bool _twr_radio_is_pub(uint8_t header)
+{
+    switch (header)
+    {
+        case TWR_RADIO_HEADER_PUB_PUSH_BUTTON:
+        case TWR_RADIO_HEADER_PUB_TEMPERATURE:
+        case TWR_RADIO_HEADER_PUB_HUMIDITY:
+        case TWR_RADIO_HEADER_PUB_LUX_METER:
+        case TWR_RADIO_HEADER_PUB_BAROMETER:
+        case TWR_RADIO_HEADER_PUB_CO2:
+        case TWR_RADIO_HEADER_PUB_BUFFER:
+        case TWR_RADIO_HEADER_PUB_BATTERY:
+        case TWR_RADIO_HEADER_PUB_ACCELERATION:
+        case TWR_RADIO_HEADER_PUB_TOPIC_STRING:
+        case TWR_RADIO_HEADER_PUB_TOPIC_UINT32:
+        case TWR_RADIO_HEADER_PUB_TOPIC_BOOL:
+        case TWR_RADIO_HEADER_PUB_TOPIC_INT:
+        case TWR_RADIO_HEADER_PUB_TOPIC_FLOAT:
+        case TWR_RADIO_HEADER_PUB_EVENT_COUNT:
+        case TWR_RADIO_HEADER_PUB_STATE:
+        case TWR_RADIO_HEADER_PUB_VALUE_INT:
+        case TWR_RADIO_HEADER_PUB_COMPACT_REG:
+        case TWR_RADIO_HEADER_PUB_COMPACT_KEY:
+        case TWR_RADIO_HEADER_PUB_COMPACT:
+        {
+            return true;
+        }
+        default:
+        {
+            return false;
+        }
+    }
+}
+
+static bool _twr_radio_store_is_ready(void)
+{
+    return (_twr_radio.store != NULL) && _twr_radio.store->is_ready();
+}
+
+static void _twr_radio_store_tx_error(void)
+{
+    if (!_twr_radio_store_is_ready())
+    {
+        return;
+    }
+
+    uint8_t *tx_buffer = twr_spirit1_get_tx_buffer();
+    size_t length = twr_spirit1_get_tx_length();
+
+    // Single lost frame does not mean the gateway is gone, failed probe while offline keeps it offline
+    if (_twr_radio.tx_error_count < _TWR_RADIO_OFFLINE_TX_ERRORS)
+    {
+        _twr_radio.tx_error_count++;
+    }
+
+    if (_twr_radio.tx_error_count >= _TWR_RADIO_OFFLINE_TX_ERRORS)
+    {
+        _twr_radio.offline = true;
+    }
+
+    // Frame is stored for replay by the task, EEPROM write takes too long for this handler and TX buffer gets reused
+    if ((length > 8) && (length - 8 <= sizeof(_twr_radio.store_pending_buffer)) && _twr_radio_is_pub(tx_buffer[8]))
+    {
+        memcpy(_twr_radio.store_pending_buffer, tx_buffer + 8, length - 8);
+
+        _twr_radio.store_pending_length = length - 8;
+
+        twr_scheduler_plan_now(_twr_radio.task_id);
+    }
+
+    _twr_radio.store_tick_replay = twr_tick_get() + _twr_radio.store->get_interval(!_twr_radio.offline);
+}
+
+static void _twr_radio_store_pending(void)
+{
+    if (_twr_radio.store_batch_done_pending)
+    {
+        _twr_radio.store_batch_done_pending = false;
+
+        _twr_radio.store->batch_done();
+    }
+
+    if (_twr_radio.store_pending_length != 0)
+    {
+        _twr_radio.store->put(_twr_radio.store_pending_buffer, _twr_radio.store_pending_length);
+
+        _twr_radio.store_pending_length = 0;
+    }
+}
+
+static void _twr_radio_decode_stored(uint64_t *id, uint8_t *buffer, size_t length)
+{
+    size_t offset = 2;
+
+    for (int i = 0; (i < buffer[1]) && (offset + 4 <= length); i++)
+    {
+        size_t record_length = buffer[offset];
+
+        if ((record_length == 0) || (offset + 4 + record_length > length))
+        {
+            break;
+        }
+
+        _twr_radio.rx_age = buffer[offset + 1];
+        _twr_radio.rx_age |= (uint32_t) buffer[offset + 2] << 8;
+        _twr_radio.rx_age |= (uint32_t) buffer[offset + 3] << 16;
+
+        twr_radio_pub_decode(id, buffer + offset + 4, record_length);
+
+        offset += 4 + record_length;
+    }
+
+    _twr_radio.rx_age = 0;
+}
+
 twr_radio_peer_t *twr_radio_get_peer_device(uint64_t id)
 {
     for (int i = 0; i < _twr_radio.peer_devices_length; i++)
@@ -1125,6 +1847,25 @@ twr_radio_peer_t *twr_radio_get_peer_device(uint64_t id)
     return NULL;
 }
 
+bool twr_radio_get_link(uint64_t id, twr_radio_link_t *link)
+{
+    twr_radio_peer_t *peer = twr_radio_get_peer_device(id);
+
+    if (peer == NULL)
+    {
+        return false;
+    }
+
+    *link = peer->link;
+
+    return true;
+}
+
+uint32_t twr_radio_get_rx_age(void)
+{
+    return _twr_radio.rx_age;
+}
+
 uint8_t *twr_radio_id_to_buffer(uint64_t *id, uint8_t *buffer)
 {
     buffer[0] = *id;
@@ -1208,6 +1949,21 @@ uint8_t *twr_radio_float_to_buffer(float *value, uint8_t *buffer)
     return buffer + sizeof(float);
 }
 
+uint8_t *twr_radio_fixed_to_buffer(twr_fixed_t *value, uint8_t *buffer)
+{
+    if (value == NULL)
+    {
+        return twr_radio_float_to_buffer(NULL, buffer);
+    }
+
+    // Same wire format as float, converted without soft-float
+    uint32_t bits = twr_fixed_to_float_bits(*value);
+
+    memcpy(buffer, &bits, sizeof(bits));
+
+    return buffer + sizeof(bits);
+}
+
 uint8_t *twr_radio_data_to_buffer(void *data, size_t length, uint8_t *buffer)
 {
     if (data == NULL)
@@ -19,6 +19,20 @@ typedef struct
     bool async_read_in_progress;
     twr_tick_t async_timeout;
     USART_TypeDef *usart;
+    twr_dma_request_t dma_request;
+    twr_dma_channel_t dma_channel_rx;
+    twr_dma_channel_t dma_channel_tx;
+    bool dma_rx;
+    size_t dma_rx_head;
+    int dma_rx_boundaries;
+    bool dma_rx_overrun;
+    bool dma_tx;
+    bool dma_tx_running;
+    size_t dma_tx_length;
+    const twr_uart_buffer_t *write_buffers;
+    size_t write_buffers_count;
+    size_t write_offset;
+    size_t read_scan;
 
 } twr_uart_t;
 
@@ -29,13 +43,6 @@ static twr_uart_t _twr_uart[3] =
     [TWR_UART_UART2] = { .initialized = false }
 };
 
-static struct
-{
-    twr_scheduler_task_id_t read_task_id;
-    size_t length;
-
-} _twr_uart_2_dma;
-
 static uint32_t _twr_uart_brr_t[] =
 {
     [TWR_UART_BAUDRATE_9600] = 0xd05,
@@ -48,7 +55,13 @@ static uint32_t _twr_uart_brr_t[] =
 
 static void _twr_uart_async_write_task(void *param);
 static void _twr_uart_async_read_task(void *param);
-static void _twr_uart_2_dma_read_task(void *param);
+static bool _twr_uart_dma_claim(twr_uart_channel_t channel, twr_dma_channel_t dma_channel);
+static void _twr_uart_dma_release(twr_dma_channel_t dma_channel);
+static void _twr_uart_start_write(twr_uart_channel_t channel);
+static bool _twr_uart_dma_write_next(twr_uart_channel_t channel);
+static void _twr_uart_dma_read_update(twr_uart_channel_t channel);
+static void _twr_uart_dma_event_handler(twr_dma_channel_t dma_channel, twr_dma_event_t event, void *event_param);
+static bool _twr_uart_irq_write_next(twr_uart_t *uart, uint8_t *character);
 static void _twr_uart_irq_handler(twr_uart_channel_t channel);
 
 void twr_uart_init(twr_uart_channel_t channel, twr_uart_baudrate_t baudrate, twr_uart_setting_t setting)
@@ -87,6 +100,9 @@ void twr_uart_init(twr_uart_channel_t channel, twr_uart_baudrate_t baudrate, twr
             NVIC_EnableIRQ(USART4_5_IRQn);
 
             _twr_uart[channel].usart = USART4;
+            _twr_uart[channel].dma_request = TWR_DMA_REQUEST_12;
+            _twr_uart[channel].dma_channel_rx = TWR_DMA_CHANNEL_6;
+            _twr_uart[channel].dma_channel_tx = TWR_DMA_CHANNEL_7;
 
             break;
         }
@@ -127,6 +143,7 @@ void twr_uart_init(twr_uart_channel_t channel, twr_uart_baudrate_t baudrate, twr
                 NVIC_EnableIRQ(LPUART1_IRQn);
 
                 _twr_uart[channel].usart = LPUART1;
+                _twr_uart[channel].dma_request = TWR_DMA_REQUEST_5;
             }
             else
             {
@@ -152,8 +169,12 @@ void twr_uart_init(twr_uart_channel_t channel, twr_uart_baudrate_t baudrate, twr
                 NVIC_EnableIRQ(USART2_IRQn);
 
                 _twr_uart[channel].usart = USART2;
+                _twr_uart[channel].dma_request = TWR_DMA_REQUEST_4;
             }
 
+            _twr_uart[channel].dma_channel_rx = TWR_DMA_CHANNEL_6;
+            _twr_uart[channel].dma_channel_tx = TWR_DMA_CHANNEL_7;
+
             break;
         }
         case TWR_UART_UART2:
@@ -186,6 +207,9 @@ void twr_uart_init(twr_uart_channel_t channel, twr_uart_baudrate_t baudrate, twr
             NVIC_EnableIRQ(USART1_IRQn);
 
             _twr_uart[channel].usart = USART1;
+            _twr_uart[channel].dma_request = TWR_DMA_REQUEST_3;
+            _twr_uart[channel].dma_channel_rx = TWR_DMA_CHANNEL_3;
+            _twr_uart[channel].dma_channel_tx = TWR_DMA_CHANNEL_4;
 
             break;
         }
@@ -245,6 +269,13 @@ void twr_uart_deinit(twr_uart_channel_t channel)
         twr_scheduler_unregister(_twr_uart[channel].async_write_task_id);
     }
 
+    if (_twr_uart[channel].dma_tx)
+    {
+        twr_dma_channel_stop(_twr_uart[channel].dma_channel_tx);
+
+        _twr_uart_dma_release(_twr_uart[channel].dma_channel_tx);
+    }
+
     switch(channel)
     {
         case TWR_UART_UART0:
@@ -431,35 +462,26 @@ size_t twr_uart_async_write(twr_uart_channel_t channel, const void *buffer, size
 
     if (bytes_written != 0)
     {
-        if (!_twr_uart[channel].async_write_in_progress)
-        {
-            _twr_uart[channel].async_write_task_id = twr_scheduler_register(_twr_uart_async_write_task, (void *) channel, TWR_TICK_INFINITY);
-
-            if (_twr_uart[channel].usart == LPUART1)
-            {
-                twr_system_hsi16_enable();
-            }
-            else
-            {
-                twr_system_pll_enable();
-            }
-        }
-        else
-        {
-            twr_scheduler_plan_absolute(_twr_uart[channel].async_write_task_id, TWR_TICK_INFINITY);
-        }
+        _twr_uart_start_write(channel);
+    }
 
-        twr_irq_disable();
+    return bytes_written;
+}
 
-        // Enable transmit interrupt
-        _twr_uart[channel].usart->CR1 |= USART_CR1_TXEIE;
+bool twr_uart_async_write_buffers(twr_uart_channel_t channel, const twr_uart_buffer_t *buffers, size_t count)
+{
+    if (!_twr_uart[channel].initialized || _twr_uart[channel].async_write_in_progress || count == 0)
+    {
+        return false;
+    }
 
-        twr_irq_enable();
+    _twr_uart[channel].write_buffers = buffers;
+    _twr_uart[channel].write_buffers_count = count;
+    _twr_uart[channel].write_offset = 0;
 
-        _twr_uart[channel].async_write_in_progress = true;
-    }
+    _twr_uart_start_write(channel);
 
-    return bytes_written;
+    return true;
 }
 
 bool twr_uart_async_read_start(twr_uart_channel_t channel, twr_tick_t timeout)
@@ -473,10 +495,15 @@ bool twr_uart_async_read_start(twr_uart_channel_t channel, twr_tick_t timeout)
 
     _twr_uart[channel].async_read_task_id = twr_scheduler_register(_twr_uart_async_read_task, (void *) channel, _twr_uart[channel].async_timeout);
 
-    if (channel == TWR_UART_UART2)
+    _twr_uart[channel].read_scan = 0;
+
+    // Channel used elsewhere falls back to receive interrupt
+    _twr_uart[channel].dma_rx = _twr_uart_dma_claim(channel, _twr_uart[channel].dma_channel_rx);
+
+    if (_twr_uart[channel].dma_rx)
     {
         twr_dma_channel_config_t config = {
-                .request = TWR_DMA_REQUEST_3,
+                .request = _twr_uart[channel].dma_request,
                 .direction = TWR_DMA_DIRECTION_TO_RAM,
                 .data_size_memory = TWR_DMA_SIZE_1,
                 .data_size_peripheral = TWR_DMA_SIZE_1,
@@ -487,18 +514,22 @@ bool twr_uart_async_read_start(twr_uart_channel_t channel, twr_tick_t timeout)
                 .priority = TWR_DMA_PRIORITY_HIGH
         };
 
-        twr_dma_init();
+        twr_fifo_purge(_twr_uart[channel].read_fifo);
 
-        twr_dma_channel_config(TWR_DMA_CHANNEL_3, &config);
+        _twr_uart[channel].dma_rx_head = 0;
+        _twr_uart[channel].dma_rx_boundaries = 0;
+        _twr_uart[channel].dma_rx_overrun = false;
 
-        _twr_uart_2_dma.read_task_id = twr_scheduler_register(_twr_uart_2_dma_read_task, (void *) channel, 0);
+        twr_dma_channel_config(_twr_uart[channel].dma_channel_rx, &config);
 
         twr_irq_disable();
-        // Enable receive DMA interrupt
-        _twr_uart[channel].usart->CR3 |=  USART_CR3_DMAR;
+        // Enable receive DMA and idle line interrupt
+        _twr_uart[channel].usart->ICR |= USART_ICR_IDLECF;
+        _twr_uart[channel].usart->CR3 |= USART_CR3_DMAR;
+        _twr_uart[channel].usart->CR1 |= USART_CR1_IDLEIE;
         twr_irq_enable();
 
-        twr_dma_channel_run(TWR_DMA_CHANNEL_3);
+        twr_dma_channel_run(_twr_uart[channel].dma_channel_rx);
     }
     else
     {
@@ -527,15 +558,18 @@ bool twr_uart_async_read_cancel(twr_uart_channel_t channel)
 
     _twr_uart[channel].async_read_in_progress = false;
 
-    if (channel == TWR_UART_UART2)
+    if (_twr_uart[channel].dma_rx)
     {
-        twr_dma_channel_stop(TWR_DMA_CHANNEL_3);
+        twr_dma_channel_stop(_twr_uart[channel].dma_channel_rx);
 
-        twr_scheduler_unregister(_twr_uart_2_dma.read_task_id);
+        _twr_uart_dma_release(_twr_uart[channel].dma_channel_rx);
+
+        _twr_uart[channel].dma_rx = false;
 
         twr_irq_disable();
-        // Disable receive DMA interrupt
+        // Disable receive DMA and idle line interrupt
         _twr_uart[channel].usart->CR3 &= ~USART_CR3_DMAR_Msk;
+        _twr_uart[channel].usart->CR1 &= ~USART_CR1_IDLEIE_Msk;
         twr_irq_enable();
     }
     else
@@ -567,9 +601,98 @@ size_t twr_uart_async_read(twr_uart_channel_t channel, void *buffer, size_t leng
 
     size_t bytes_read = twr_fifo_read(_twr_uart[channel].read_fifo, buffer, length);
 
+    _twr_uart[channel].read_scan = _twr_uart[channel].read_scan > bytes_read ? _twr_uart[channel].read_scan - bytes_read : 0;
+
     return bytes_read;
 }
 
+size_t twr_uart_async_read_line(twr_uart_channel_t channel, twr_uart_buffer_t *line, char terminator)
+{
+    twr_uart_t *uart = &_twr_uart[channel];
+
+    if (!uart->initialized || !uart->async_read_in_progress)
+    {
+        return 0;
+    }
+
+    twr_fifo_t *fifo = uart->read_fifo;
+    const uint8_t *buffer = fifo->buffer;
+
+    twr_irq_disable();
+    size_t head = fifo->head;
+    twr_irq_enable();
+
+    size_t tail = fifo->tail;
+    size_t available = head >= tail ? head - tail : fifo->size - tail + head;
+
+    // Continue where the previous call stopped, received data is scanned only once
+    for (size_t i = uart->read_scan; i < available; i++)
+    {
+        size_t position = tail + i < fifo->size ? tail + i : tail + i - fifo->size;
+
+        if (buffer[position] != (uint8_t) terminator)
+        {
+            continue;
+        }
+
+        size_t length = i + 1;
+        size_t first = fifo->size - tail < length ? fifo->size - tail : length;
+
+        line[0].buffer = buffer + tail;
+        line[0].length = first;
+        line[1].buffer = buffer;
+        line[1].length = length - first;
+
+        uart->read_scan = i;
+
+        return length;
+    }
+
+    uart->read_scan = available;
+
+    // Record longer than FIFO would block reception, hand it out as it is
+    if (available == fifo->size - 1)
+    {
+        size_t first = fifo->size - tail < available ? fifo->size - tail : available;
+
+        line[0].buffer = buffer + tail;
+        line[0].length = first;
+        line[1].buffer = buffer;
+        line[1].length = available - first;
+
+        return available;
+    }
+
+    return 0;
+}
+
+void twr_uart_async_read_release(twr_uart_channel_t channel, size_t length)
+{
+    twr_uart_t *uart = &_twr_uart[channel];
+
+    if (!uart->initialized || uart->read_fifo == NULL)
+    {
+        return;
+    }
+
+    twr_fifo_t *fifo = uart->read_fifo;
+
+    twr_irq_disable();
+
+    size_t available = fifo->head >= fifo->tail ? fifo->head - fifo->tail : fifo->size - fifo->tail + fifo->head;
+
+    if (length > available)
+    {
+        length = available;
+    }
+
+    fifo->tail = (fifo->tail + length) % fifo->size;
+
+    twr_irq_enable();
+
+    uart->read_scan = uart->read_scan > length ? uart->read_scan - length : 0;
+}
+
 static void _twr_uart_async_write_task(void *param)
 {
     twr_uart_channel_t channel = (twr_uart_channel_t) param;
@@ -579,6 +702,15 @@ static void _twr_uart_async_write_task(void *param)
 
     twr_scheduler_unregister(uart->async_write_task_id);
 
+    if (uart->dma_tx)
+    {
+        uart->usart->CR3 &= ~USART_CR3_DMAT_Msk;
+
+        _twr_uart_dma_release(uart->dma_channel_tx);
+
+        uart->dma_tx = false;
+    }
+
     if (uart->usart == LPUART1)
     {
         twr_system_hsi16_disable();
@@ -601,8 +733,21 @@ static void _twr_uart_async_read_task(void *param)
 
     twr_scheduler_plan_current_relative(uart->async_timeout);
 
+    twr_irq_disable();
+
+    bool overrun = uart->dma_rx_overrun;
+
+    uart->dma_rx_overrun = false;
+
+    twr_irq_enable();
+
     if (uart->event_handler != NULL)
     {
+        if (overrun)
+        {
+            uart->event_handler(channel, TWR_UART_EVENT_ASYNC_READ_OVERRUN, uart->event_param);
+        }
+
         if (twr_fifo_is_empty(uart->read_fifo))
         {
             uart->event_handler(channel, TWR_UART_EVENT_ASYNC_READ_TIMEOUT, uart->event_param);
@@ -614,24 +759,299 @@ static void _twr_uart_async_read_task(void *param)
     }
 }
 
-static void _twr_uart_2_dma_read_task(void *param)
+static bool _twr_uart_dma_claim(twr_uart_channel_t channel, twr_dma_channel_t dma_channel)
 {
-    (void) param;
+    // Channel used by the other UART or by another driver (e.g. twr_dac)
+    if (twr_dma_channel_is_used(dma_channel))
+    {
+        return false;
+    }
+
+    twr_dma_init();
+
+    twr_dma_set_event_handler(dma_channel, _twr_uart_dma_event_handler, (void *) channel);
+
+    return true;
+}
 
-    size_t length = twr_dma_channel_get_length(TWR_DMA_CHANNEL_3);
+static void _twr_uart_dma_release(twr_dma_channel_t dma_channel)
+{
+    twr_dma_set_event_handler(dma_channel, NULL, NULL);
+}
 
-    twr_uart_t *uart = &_twr_uart[TWR_UART_UART2];
+static void _twr_uart_start_write(twr_uart_channel_t channel)
+{
+    twr_uart_t *uart = &_twr_uart[channel];
 
-    if (_twr_uart_2_dma.length != length)
+    if (!uart->async_write_in_progress)
     {
-        uart->read_fifo->head = uart->read_fifo->size - length;
+        uart->async_write_task_id = twr_scheduler_register(_twr_uart_async_write_task, (void *) channel, TWR_TICK_INFINITY);
+
+        if (uart->usart == LPUART1)
+        {
+            twr_system_hsi16_enable();
+        }
+        else
+        {
+            twr_system_pll_enable();
+        }
+
+        // Channel used elsewhere falls back to transmit interrupt
+        uart->dma_tx = _twr_uart_dma_claim(channel, uart->dma_channel_tx);
+
+        uart->async_write_in_progress = true;
+    }
+    else
+    {
+        twr_scheduler_plan_absolute(uart->async_write_task_id, TWR_TICK_INFINITY);
+    }
+
+    if (uart->dma_tx)
+    {
+        if (!uart->dma_tx_running && _twr_uart_dma_write_next(channel))
+        {
+            twr_irq_disable();
+
+            // Transfer continues, cancel waiting for transmission complete
+            uart->usart->CR1 &= ~USART_CR1_TCIE;
+
+            twr_irq_enable();
+        }
+
+        return;
+    }
+
+    twr_irq_disable();
 
-        _twr_uart_2_dma.length = length;
+    // Enable transmit interrupt
+    uart->usart->CR1 |= USART_CR1_TXEIE;
+
+    twr_irq_enable();
+}
+
+static bool _twr_uart_dma_write_next(twr_uart_channel_t channel)
+{
+    twr_uart_t *uart = &_twr_uart[channel];
+    const uint8_t *buffer = NULL;
+    size_t length = 0;
+
+    uart->dma_tx_length = 0;
+
+    // Caller buffers go directly to DMA, each one as a single transfer
+    while (length == 0 && uart->write_buffers_count != 0)
+    {
+        buffer = uart->write_buffers->buffer;
+        length = uart->write_buffers->length;
+
+        uart->write_buffers++;
+        uart->write_buffers_count--;
+    }
+
+    if (length == 0 && uart->write_fifo != NULL)
+    {
+        twr_fifo_t *fifo = uart->write_fifo;
+
+        twr_irq_disable();
+
+        // Contiguous part of FIFO up to the head or the end of buffer
+        buffer = (const uint8_t *) fifo->buffer + fifo->tail;
+        length = fifo->head >= fifo->tail ? fifo->head - fifo->tail : fifo->size - fifo->tail;
+
+        twr_irq_enable();
+
+        uart->dma_tx_length = length;
+    }
+
+    if (length == 0)
+    {
+        uart->dma_tx_running = false;
+
+        return false;
+    }
+
+    if (length > 0xffff)
+    {
+        // Remainder of oversized buffer is not supported by single transfer
+        length = 0xffff;
+
+        if (uart->dma_tx_length != 0)
+        {
+            uart->dma_tx_length = length;
+        }
+    }
+
+    twr_dma_channel_config_t config = {
+            .request = uart->dma_request,
+            .direction = TWR_DMA_DIRECTION_TO_PERIPHERAL,
+            .data_size_memory = TWR_DMA_SIZE_1,
+            .data_size_peripheral = TWR_DMA_SIZE_1,
+            .length = length,
+            .mode = TWR_DMA_MODE_STANDARD,
+            .address_memory = (void *) buffer,
+            .address_peripheral = (void *) &uart->usart->TDR,
+            .priority = TWR_DMA_PRIORITY_MEDIUM
+    };
+
+    twr_dma_channel_stop(uart->dma_channel_tx);
+
+    twr_dma_channel_config(uart->dma_channel_tx, &config);
+
+    uart->dma_tx_running = true;
+
+    twr_irq_disable();
+    // Enable transmit DMA
+    uart->usart->CR3 |= USART_CR3_DMAT;
+    twr_irq_enable();
+
+    twr_dma_channel_run(uart->dma_channel_tx);
+
+    return true;
+}
+
+static void _twr_uart_dma_read_update(twr_uart_channel_t channel)
+{
+    twr_uart_t *uart = &_twr_uart[channel];
+
+    if (!uart->dma_rx)
+    {
+        return;
+    }
+
+    size_t size = uart->read_fifo->size;
+    size_t head = size - twr_dma_channel_get_length(uart->dma_channel_rx);
+
+    if (head == size)
+    {
+        head = 0;
+    }
+
+    // FIFO purged by application, continue from the position of DMA at the last update
+    if (uart->read_fifo->head != uart->dma_rx_head)
+    {
+        uart->read_fifo->tail = uart->dma_rx_head;
+    }
+
+    size_t received = (head + size - uart->dma_rx_head) % size;
+    size_t end = uart->dma_rx_head + received;
+
+    // Count half and full buffer positions passed, each of them is reported by one DMA event
+    if (uart->dma_rx_head < size / 2 && end >= size / 2)
+    {
+        uart->dma_rx_boundaries++;
+    }
+
+    if (end >= size)
+    {
+        uart->dma_rx_boundaries++;
+    }
+
+    if (end >= size + size / 2)
+    {
+        uart->dma_rx_boundaries++;
+    }
+
+    // Received data overwrote data not read yet, whole content of FIFO is lost
+    if (received > (uart->read_fifo->tail + size - uart->dma_rx_head - 1) % size)
+    {
+        uart->dma_rx_overrun = true;
+
+        uart->read_fifo->tail = head;
+    }
+
+    uart->read_fifo->head = head;
+
+    if ((uart->dma_rx_head != head) || uart->dma_rx_overrun)
+    {
+        uart->dma_rx_head = head;
 
         twr_scheduler_plan_now(uart->async_read_task_id);
     }
+}
+
+static void _twr_uart_dma_event_handler(twr_dma_channel_t dma_channel, twr_dma_event_t event, void *event_param)
+{
+    twr_uart_channel_t channel = (twr_uart_channel_t) event_param;
+    twr_uart_t *uart = &_twr_uart[channel];
+
+    if (uart->dma_rx && dma_channel == uart->dma_channel_rx)
+    {
+        if (event == TWR_DMA_EVENT_ERROR)
+        {
+            return;
+        }
+
+        // Idle line interrupt updates the same state
+        twr_irq_disable();
+
+        // Half and full buffer events catch data received without idle line in between
+        _twr_uart_dma_read_update(channel);
+
+        // Event for a position the updates never saw means DMA went round the whole buffer in between, one position
+        // of tolerance covers half transfer flag of odd sized buffer
+        if (--uart->dma_rx_boundaries < -1)
+        {
+            uart->dma_rx_boundaries = 0;
+            uart->dma_rx_overrun = true;
+
+            uart->read_fifo->tail = uart->read_fifo->head;
+
+            twr_scheduler_plan_now(uart->async_read_task_id);
+        }
+
+        twr_irq_enable();
+
+        return;
+    }
+
+    if (!uart->dma_tx || dma_channel != uart->dma_channel_tx || event == TWR_DMA_EVENT_HALF_DONE)
+    {
+        return;
+    }
+
+    if (uart->dma_tx_length != 0)
+    {
+        twr_fifo_t *fifo = uart->write_fifo;
+
+        twr_irq_disable();
+
+        fifo->tail = (fifo->tail + uart->dma_tx_length) % fifo->size;
+
+        twr_irq_enable();
+    }
+
+    if (!_twr_uart_dma_write_next(channel))
+    {
+        twr_irq_disable();
 
-    twr_scheduler_plan_current_now();
+        // Wait until the last character leaves the shift register
+        uart->usart->CR1 |= USART_CR1_TCIE;
+
+        twr_irq_enable();
+    }
+}
+
+static bool _twr_uart_irq_write_next(twr_uart_t *uart, uint8_t *character)
+{
+    while (uart->write_buffers_count != 0)
+    {
+        if (uart->write_offset < uart->write_buffers->length)
+        {
+            *character = ((const uint8_t *) uart->write_buffers->buffer)[uart->write_offset++];
+
+            return true;
+        }
+
+        uart->write_buffers++;
+        uart->write_buffers_count--;
+        uart->write_offset = 0;
+    }
+
+    if (uart->write_fifo == NULL)
+    {
+        return false;
+    }
+
+    return twr_fifo_irq_read(uart->write_fifo, character, 1) != 0;
 }
 
 static void _twr_uart_irq_handler(twr_uart_channel_t channel)
@@ -650,13 +1070,21 @@ static void _twr_uart_irq_handler(twr_uart_channel_t channel)
         twr_scheduler_plan_now(_twr_uart[channel].async_read_task_id);
     }
 
+    // If it is idle line after received data...
+    if ((usart->CR1 & USART_CR1_IDLEIE) != 0 && (usart->ISR & USART_ISR_IDLE) != 0)
+    {
+        usart->ICR |= USART_ICR_IDLECF;
+
+        _twr_uart_dma_read_update(channel);
+    }
+
     // If it is transmit interrupt...
     if ((usart->CR1 & USART_CR1_TXEIE) != 0 && (usart->ISR & USART_ISR_TXE) != 0)
     {
         uint8_t character;
 
-        // If there are still data in FIFO...
-        if (twr_fifo_irq_read(_twr_uart[channel].write_fifo, &character, 1) != 0)
+        // If there are still data in buffers or FIFO...
+        if (_twr_uart_irq_write_next(&_twr_uart[channel], &character))
         {
             // Load transmit data register
             usart->TDR = character;
@@ -2,6 +2,7 @@
 #include <twr_scheduler.h>
 #include <twr_fifo.h>
 #include <twr_system.h>
+#include <twr_crc.h>
 
 #include <usbd_core.h>
 #include <usbd_cdc.h>
@@ -10,12 +11,19 @@
 
 #include <stm32l0xx.h>
 
+#define _TWR_USB_CDC_FRAME_HEADER_SIZE 5
+#define _TWR_USB_CDC_FRAME_CRC_SIZE 2
+#define _TWR_USB_CDC_RECORD_MAX_LENGTH 255
+
 static struct
 {
     twr_fifo_t receive_fifo;
     uint8_t receive_buffer[1024];
-    uint8_t transmit_buffer[512];
+    uint8_t transmit_buffer[2][512];
+    int transmit_index;
     size_t transmit_length;
+    bool framing;
+    uint8_t sequence;
     twr_scheduler_task_id_t task_id;
 
 } _twr_usb_cdc;
@@ -25,6 +33,8 @@ USBD_HandleTypeDef hUsbDeviceFS;
 static void _twr_usb_cdc_task_start(void *param);
 static void _twr_usb_cdc_task(void *param);
 static void _twr_usb_cdc_init_hsi48();
+static bool _twr_usb_cdc_record_reserve(size_t length);
+static void _twr_usb_cdc_record_append(uint8_t type, const void *buffer, size_t length);
 
 void twr_usb_cdc_init(void)
 {
@@ -45,12 +55,35 @@ void twr_usb_cdc_init(void)
 
 bool twr_usb_cdc_write(const void *buffer, size_t length)
 {
-    if (length > (sizeof(_twr_usb_cdc.transmit_buffer) - _twr_usb_cdc.transmit_length))
+    if (_twr_usb_cdc.framing)
+    {
+        size_t records = (length + _TWR_USB_CDC_RECORD_MAX_LENGTH - 1) / _TWR_USB_CDC_RECORD_MAX_LENGTH;
+
+        if (!_twr_usb_cdc_record_reserve(length + 2 * records))
+        {
+            return false;
+        }
+
+        while (length != 0)
+        {
+            size_t chunk = length > _TWR_USB_CDC_RECORD_MAX_LENGTH ? _TWR_USB_CDC_RECORD_MAX_LENGTH : length;
+
+            _twr_usb_cdc_record_append(TWR_USB_CDC_RECORD_RAW, buffer, chunk);
+
+            buffer = (const uint8_t *) buffer + chunk;
+
+            length -= chunk;
+        }
+
+        return true;
+    }
+
+    if (length > (sizeof(_twr_usb_cdc.transmit_buffer[0]) - _twr_usb_cdc.transmit_length))
     {
         return false;
     }
 
-    memcpy(&_twr_usb_cdc.transmit_buffer[_twr_usb_cdc.transmit_length], buffer, length);
+    memcpy(&_twr_usb_cdc.transmit_buffer[_twr_usb_cdc.transmit_index][_twr_usb_cdc.transmit_length], buffer, length);
 
     _twr_usb_cdc.transmit_length += length;
 
@@ -86,6 +119,47 @@ size_t twr_usb_cdc_read(void *buffer, size_t length)
     return bytes_read;
 }
 
+void twr_usb_cdc_set_framing(bool framing)
+{
+    _twr_usb_cdc.framing = framing;
+}
+
+bool twr_usb_cdc_write_record(uint8_t type, const void *buffer, size_t length)
+{
+    if (!_twr_usb_cdc.framing || (length > _TWR_USB_CDC_RECORD_MAX_LENGTH) || !_twr_usb_cdc_record_reserve(2 + length))
+    {
+        return false;
+    }
+
+    _twr_usb_cdc_record_append(type, buffer, length);
+
+    return true;
+}
+
+bool twr_usb_cdc_publish(const char *topic, const char *payload)
+{
+    size_t topic_length = strlen(topic) + 1;
+    size_t payload_length = strlen(payload);
+
+    if (!_twr_usb_cdc.framing || (topic_length + payload_length > _TWR_USB_CDC_RECORD_MAX_LENGTH) ||
+        !_twr_usb_cdc_record_reserve(2 + topic_length + payload_length))
+    {
+        return false;
+    }
+
+    uint8_t *record = &_twr_usb_cdc.transmit_buffer[_twr_usb_cdc.transmit_index][_twr_usb_cdc.transmit_length];
+
+    record[0] = TWR_USB_CDC_RECORD_PUBLISH;
+    record[1] = topic_length + payload_length;
+
+    memcpy(record + 2, topic, topic_length);
+    memcpy(record + 2 + topic_length, payload, payload_length);
+
+    _twr_usb_cdc.transmit_length += 2 + topic_length + payload_length;
+
+    return true;
+}
+
 void twr_usb_cdc_received_data(const void *buffer, size_t length)
 {
     twr_fifo_irq_write(&_twr_usb_cdc.receive_fifo, (uint8_t *) buffer, length);
@@ -111,11 +185,34 @@ static void _twr_usb_cdc_task(void *param)
         return;
     }
 
+    uint8_t *buffer = _twr_usb_cdc.transmit_buffer[_twr_usb_cdc.transmit_index];
+    size_t length = _twr_usb_cdc.transmit_length;
+
+    if (_twr_usb_cdc.framing)
+    {
+        // Header and CRC are completed only now, frame stays open for more records while previous one is sent
+        size_t records_length = length - _TWR_USB_CDC_FRAME_HEADER_SIZE;
+
+        buffer[2] = records_length;
+        buffer[3] = records_length >> 8;
+        buffer[4] = _twr_usb_cdc.sequence;
+
+        uint16_t crc = twr_crc16(0x1021, buffer + 2, length - 2, 0xffff);
+
+        buffer[length++] = crc;
+        buffer[length++] = crc >> 8;
+    }
+
     HAL_NVIC_DisableIRQ(USB_IRQn);
 
-    if (CDC_Transmit_FS(_twr_usb_cdc.transmit_buffer, _twr_usb_cdc.transmit_length) == USBD_OK)
+    // Buffer being sent is left alone, next writes go to the other one
+    if (CDC_Transmit_FS(buffer, length) == USBD_OK)
     {
+        _twr_usb_cdc.transmit_index ^= 1;
+
         _twr_usb_cdc.transmit_length = 0;
+
+        _twr_usb_cdc.sequence++;
     }
 
     HAL_NVIC_EnableIRQ(USB_IRQn);
@@ -139,3 +236,44 @@ static void _twr_usb_cdc_init_hsi48()
     RCC->CCIPR |= RCC_USBCLKSOURCE_HSI48;
     RCC->CFGR &= ~RCC_CFGR_STOPWUCK_Msk;
 }
+
+static bool _twr_usb_cdc_record_reserve(size_t length)
+{
+    size_t transmit_length = _twr_usb_cdc.transmit_length;
+
+    if (transmit_length == 0)
+    {
+        transmit_length = _TWR_USB_CDC_FRAME_HEADER_SIZE;
+    }
+
+    if (transmit_length + length + _TWR_USB_CDC_FRAME_CRC_SIZE > sizeof(_twr_usb_cdc.transmit_buffer[0]))
+    {
+        return false;
+    }
+
+    if (_twr_usb_cdc.transmit_length == 0)
+    {
+        uint8_t *buffer = _twr_usb_cdc.transmit_buffer[_twr_usb_cdc.transmit_index];
+
+        buffer[0] = 0xa5;
+        buffer[1] = 0x5a;
+
+        _twr_usb_cdc.transmit_length = _TWR_USB_CDC_FRAME_HEADER_SIZE;
+    }
+
+    twr_scheduler_plan_now(_twr_usb_cdc.task_id);
+
+    return true;
+}
+
+static void _twr_usb_cdc_record_append(uint8_t type, const void *buffer, size_t length)
+{
+    uint8_t *record = &_twr_usb_cdc.transmit_buffer[_twr_usb_cdc.transmit_index][_twr_usb_cdc.transmit_length];
+
+    record[0] = type;
+    record[1] = length;
+
+    memcpy(record + 2, buffer, length);
+
+    _twr_usb_cdc.transmit_length += 2 + length;
+}
@@ -266,6 +266,9 @@ void application_init(void){
     lcd_init();
     twr_log_debug("init lcd complete");
 
+    // key-value store for calibration and radio peers, keep clear of legacy calibration at 0
+    twr_kv_init(KV_ADDRESS, KV_SIZE);
+
     // init scale
     hx711_init(&scale, DTPIN, CLKPIN, HX711_CHANNEL_A); // HX711_CHANNEL_A64
     twr_log_debug("init hx711 complete");
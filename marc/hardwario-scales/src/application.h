@@ -11,6 +11,9 @@
 #define CLKPIN TWR_GPIO_P9
 #define DTPIN TWR_GPIO_P8
 
+#define KV_ADDRESS 64
+#define KV_SIZE 512
+
 uint64_t _radio_id = 0;
 
 #endif
@@ -462,6 +462,8 @@ bool hx711_save(hx711_t *self)
   tmp.offset = self->_offset;
   tmp.scale = self->_scale;
   tmp.times = self->_times;
+  if (twr_kv_is_ready())
+    return twr_kv_set(HX711_KV_KEY, &(tmp), sizeof(tmp));
   return twr_eeprom_write(_HX711_MEM_ADDRESS, &(tmp), sizeof(tmp));
 }
 
@@ -469,8 +471,14 @@ bool hx711_load(hx711_t *self)
 {
   twr_log_debug("Load config - start");
   hx711_save_t tmp;
-  if (!twr_eeprom_read(_HX711_MEM_ADDRESS, &(tmp), sizeof(tmp)))
-    return false;
+  bool migrate = false;
+  if (twr_kv_get(HX711_KV_KEY, &(tmp), sizeof(tmp)) != sizeof(tmp))
+  {
+    // fall back to the location used before the key-value store
+    if (!twr_eeprom_read(_HX711_MEM_ADDRESS, &(tmp), sizeof(tmp)))
+      return false;
+    migrate = twr_kv_is_ready();
+  }
   if (tmp.scale==0 || tmp.times<=0)
     return false;
   
@@ -480,6 +488,9 @@ bool hx711_load(hx711_t *self)
 
   self->_state = HX711_STATE_READY;
 
+  if (migrate)
+    hx711_save(self);
+
   twr_log_debug("Load config - success");
   return true;
 }
@@ -18,10 +18,12 @@
 // #include <bc_usb_cdc.h>
 // #include <bc_eeprom.h>
 #include <bcl.h>
+#include <twr_kv.h>
 
 #define HX711_INVALID_VALUE -99999999
 #define _HX711_TIMES 5
 #define _HX711_MEM_ADDRESS 0
+#define HX711_KV_KEY TWR_KV_KEY_USER
 
 
 // HX711 scale modlule configuration